@@ -45,8 +45,24 @@
 #pragma config WDTPS = PS1			// PS1 | PS2 | PS4 | PS8 | PS16 | PS32 | PS64 | PS128 | PS256 | PS512 | PS1024 | PS2048 | PS4096 | PS8192 | PS16384 | PS32768 | PS65536 | PS131072 | PS262144 | PS524288 | PS1048576
 
 // ---------- Special function ---------- //
-//Shadow Set Register assignation
+//Shadow Set Register assignation (follow INT_SHADOW_IPL if defined)
+#if !defined(INT_SHADOW_IPL)
 #pragma config FSRSSEL = PRIORITY_0	// PRIORITY_0 > PRIORITY_7
+#elif INT_SHADOW_IPL == 1
+#pragma config FSRSSEL = PRIORITY_1
+#elif INT_SHADOW_IPL == 2
+#pragma config FSRSSEL = PRIORITY_2
+#elif INT_SHADOW_IPL == 3
+#pragma config FSRSSEL = PRIORITY_3
+#elif INT_SHADOW_IPL == 4
+#pragma config FSRSSEL = PRIORITY_4
+#elif INT_SHADOW_IPL == 5
+#pragma config FSRSSEL = PRIORITY_5
+#elif INT_SHADOW_IPL == 6
+#pragma config FSRSSEL = PRIORITY_6
+#else
+#pragma config FSRSSEL = PRIORITY_7
+#endif
 //CAN IO pin Selection
 #pragma config FCANIO = ON			// ON | OFF
 //USB USBID Selection
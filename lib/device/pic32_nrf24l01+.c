@@ -68,6 +68,7 @@ U8 nrfInit(U8 spiPort, volatile U32 * SSpinPortPtr, U16 SSpinMask)
 	nrfSPIControl = spiAddSlave(spiPort, SSpinPortPtr, SSpinMask);
 	if (nrfSPIControl == NULL)
 		return STD_EC_FAIL;
+	spiSetSlaveConfig(nrfSPIControl, NRF_SPI_BAUDRATE, SPI_DATA_WIDTH_8BIT|SPI_CLK_IDLE_LOW|SPI_TX_DATA_ACTIVE_TO_IDLE, NRF_SPI_SS_SETUP, 0);
 	// -------------------------- //
 	
 	return STD_EC_SUCCESS;
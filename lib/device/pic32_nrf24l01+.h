@@ -142,6 +142,11 @@ Feature			||		||	EN TX + ACK CMD	||	EN TX + ACK	||	EN Dyn Pkt Len	||	RESERVED	||
 #define		NRF_PACKET_SIZE_MAX		32			//nRF Enhanced ShockBurst maximum packet size (1-32 byte)
 // -------------------------- //
 
+// -- SPI bus -- //
+#define		NRF_SPI_BAUDRATE		10000000		//nRF maximum SPI clock (in bps)
+#define		NRF_SPI_SS_SETUP		2			//CSN to SCK setup time (in ns)
+// ------------- //
+
 // -- Hardware pin -- //
 #define		NRF_PIN_IRQ			PORTBbits.RB0
 #define		NRF_PIN_CE			PORTAbits.RA5
@@ -15,6 +15,44 @@
 
 
 // ================= Interrupt Functions ================= //
+/**
+* \fn		U8 critEnter(void)
+* @brief	Enter a critical section
+* @note		With the priority enabled (IPEN), only the low priority interrupts are masked, the high priority
+*		interrupts are never blocked and must not share data with a critical section
+*		Without the priority, all interrupts are masked
+*		The previous state is restored by critExit(), so critical sections can be nested
+* @return	U8 critState			Previous global interrupt enable bits (to give to critExit())
+*/
+U8 critEnter(void)
+{
+	U8 critState = INTCON & (BIT7|BIT6);	//Save GIE/GIEH and PEIE/GIEL
+
+	if (RCONbits.IPEN)
+		INTCONbits.GIEL = 0;		//Mask only the low priority
+	else
+		INTCONbits.GIE = 0;		//Single level, mask everything
+
+	return critState;
+}
+
+/**
+* \fn		void critExit(U8 critState)
+* @brief	Leave a critical section by restoring the state saved by critEnter()
+* @note
+* @arg		U8 critState			Value returned by the matching critEnter()
+* @return	nothing
+*/
+void critExit(U8 critState)
+{
+	if (RCONbits.IPEN)
+	{
+		if (critState & BIT6)
+			INTCONbits.GIEL = 1;
+	}
+	else if (critState & BIT7)
+		INTCONbits.GIE = 1;
+}
 
 
 
@@ -390,4 +390,27 @@
 #define		int_usb_clr()			PIR2bits.USBIF = 0
 // ############################################## //
 
+
+// ############# Critical Section ############### //
+/**
+* \fn		U8 critEnter(void)
+* @brief	Enter a critical section
+* @note		With the priority enabled (IPEN), only the low priority interrupts are masked, the high priority
+*		interrupts are never blocked and must not share data with a critical section
+*		Without the priority, all interrupts are masked
+*		The previous state is restored by critExit(), so critical sections can be nested
+* @return	U8 critState			Previous global interrupt enable bits (to give to critExit())
+*/
+U8 critEnter(void);
+
+/**
+* \fn		void critExit(U8 critState)
+* @brief	Leave a critical section by restoring the state saved by critEnter()
+* @note
+* @arg		U8 critState			Value returned by the matching critEnter()
+* @return	nothing
+*/
+void critExit(U8 critState);
+// ############################################## //
+
 #endif
@@ -79,6 +79,8 @@ void i2c1_init_master(void)
 
     //Enable interrupts for interrupt-driven functions
     int_peripheral_en();
+    int_mssp1_prio(0);	    	//Low priority, critEnter() only mask GIEL when IPEN is set
+    int_mssp1col_prio(0);
     int_mssp1_init();	    	//Enable the MSSP 1 Interrupts
     int_mssp1col_init();	    	//Enable the MSSP 1 Bus collision Interrupt
     int_global_en();
@@ -152,8 +154,9 @@ void i2c1_put_data(void)
 // Function to save the parameters of a communication in the queue
 void i2c1_put_queue(U8 address, U8 nb_of_byte, U8 *location)
 {
-	int_peripheral_dis();		    //Disable Peripheral/Low priority Interrupts
-	int_global_dis();			    //Disable Global Interrupts
+	U8 crit_state;
+
+	crit_state = critEnter();	    //Protect the queue from the MSSP ISR (set low priority by i2c1_init_master())
 
     // The queue is not full
     if (i2c1_pending_slave < I2C1_QUEUE_SIZE)
@@ -185,9 +188,8 @@ void i2c1_put_queue(U8 address, U8 nb_of_byte, U8 *location)
     // The queue is full
     else
 		i2c1_control_flag.queue_overrun = SET;
-		
-	int_peripheral_en();			    //Enable Peripheral/Low priority Interrupts
-	int_global_en();			    //Enable Global Interrupts
+
+	critExit(crit_state);		    //Restore the previous interrupt state
 }
 
 // Function to recover the parameters							OK
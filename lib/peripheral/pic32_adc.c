@@ -18,7 +18,6 @@
 
 
 // ################## Variables ################# //
-extern U32 heapAvailable;
 // -- Internal Safe-guard -- //
 extern U32 globalDump;
 U8 __adcSafeDonePtr = ADC_CONV_DONE;					//Safe place to point adcDonePtr if a NULL pointer is passed
@@ -35,6 +34,289 @@ U32 * pADxBUF = NULL;
 const tADCreg * adcRegAddress[ADC_MAX_PORT] = {&AD1CON1};		//Address of the first reg of each peripheral
 tADCcontrol adcControl[ADC_MAX_PORT];					//Control of the ADC
 U16 adcResultBuffer[ADC_MAX_PORT][ADC_FIFO_LVL];
+tADCStreamCtl adcStream[ADC_MAX_PORT];					//Streaming control of the ADC
+tADCQueueCtl adcQueue[ADC_MAX_PORT];					//Request queue of the ADC
+tADCTimedCtl adcTimed[ADC_MAX_PORT];					//Timed scan control of the ADC
+
+poolDeclareStorage(adcRequestStorage, tADCRequest, ADC_REQUEST_POOL_SIZE);
+tPoolCtl adcRequestPool;
+U8 adcPoolReady = 0;
+// ############################################## //
+
+
+// ############## Internal Functions ############ //
+/**
+* \fn		void adcQueueStart(U8 adcPort, tADCRequest * requestPtr)
+* @brief	Configure the ADC for a request and start the conversion
+* @note		The MUX, scan matrix and SMPI are written only if they changed since the last request
+*			The ADC stop by itself after the last conversion (CLRASAM)
+* @arg		U8 adcPort				Hardware ADC ID
+* @arg		tADCRequest * requestPtr		Request to start
+* @return	nothing
+*/
+void adcQueueStart(U8 adcPort, tADCRequest * requestPtr)
+{
+	tADCQueueCtl * workQueue = &adcQueue[adcPort];
+
+	adcSelectPort(adcPort);
+
+	// -- Set the inputs if they changed -- //
+	if ((requestPtr->scan != workQueue->appliedScan) || (requestPtr->input != workQueue->appliedInput))
+	{
+		if (requestPtr->scan)
+		{
+			pADxCSSL->CSSL = requestPtr->input;
+			pADxCON2->CSCNA = ENABLE;
+		}
+		else
+		{
+			pADxCON2->CSCNA = DISABLE;
+			pADxCHS->CH0NA = 0;			//Select VrefL as the negative input
+			pADxCHS->CH0SA = requestPtr->input;
+		}
+		workQueue->appliedScan = requestPtr->scan;
+		workQueue->appliedInput = requestPtr->input;
+	}
+	if ((requestPtr->conversionNb - 1) != workQueue->appliedSMPI)
+	{
+		pADxCON2->SMPI = requestPtr->conversionNb - 1;
+		workQueue->appliedSMPI = requestPtr->conversionNb - 1;
+	}
+	// ------------------------------------ //
+
+	// -- Start the conversion -- //
+	pADxCON1->CLRASAM = ENABLE;			//Stop after SMPI nb of conversion (clear ASAM automaticaly)
+	pADxCON1->ASAM = ENABLE;			//Auto mode
+	// -------------------------- //
+}
+
+/**
+* \fn		U16 adcRemoveOffset(U8 adcPort, U32 raw)
+* @brief	Remove the calibration offset from a raw sample
+* @note		A raw sample under the offset give 0 instead of wrapping around (a false high alarm)
+* @arg		U8 adcPort				Hardware ADC ID
+* @arg		U32 raw					Raw sample
+* @return	U16 sample				Sample without the offset
+*/
+U16 adcRemoveOffset(U8 adcPort, U32 raw)
+{
+	S32 sample = (S32)raw - adcControl[adcPort].offsetVal;
+
+	if (sample < 0)
+		sample = 0;
+
+	return (U16)sample;
+}
+
+/**
+* \fn		void adcWindowCheck(U8 adcPort, U8 resultIndex, U16 sample)
+* @brief	Compare a sample with the window of its result and raise or clear the alarm
+* @note		Called from adcISR() right after the sample is read, or from adcWindowCheckBlock() when streaming
+* @arg		U8 adcPort				Hardware ADC ID
+* @arg		U8 resultIndex				Result index of the sample
+* @arg		U16 sample				Sample (offset removed)
+* @return	nothing
+*/
+void adcWindowCheck(U8 adcPort, U8 resultIndex, U16 sample)
+{
+	tADCWindow * workWindow = adcControl[adcPort].windowPtr[resultIndex];
+	U8 newState;
+
+	if (workWindow == NULL)
+		return;
+
+	// -- Compare with hysteresis -- //
+	newState = workWindow->state;
+	if (sample > workWindow->highThreshold)
+		newState = ADC_WINDOW_HIGH;
+	else if (sample < workWindow->lowThreshold)
+		newState = ADC_WINDOW_LOW;
+	else if ((sample <= (workWindow->highThreshold - workWindow->hysteresis)) && (sample >= (workWindow->lowThreshold + workWindow->hysteresis)))
+		newState = ADC_WINDOW_NORMAL;
+	// ----------------------------- //
+
+	if (newState == workWindow->state)
+		return;
+	workWindow->state = newState;
+
+	// -- Trip first, then tell the user -- //
+	if ((newState != ADC_WINDOW_NORMAL) && (workWindow->tripRegPtr != NULL))
+		*(workWindow->tripRegPtr) = workWindow->tripMask;
+
+	if (workWindow->callback != NULL)
+		workWindow->callback(adcPort, resultIndex, newState, sample, workWindow->contextPtr);
+	// ------------------------------------ //
+}
+
+/**
+* \fn		void adcWindowCheckBlock(U8 adcPort, const U16 * samplePtr, U16 sampleNb)
+* @brief	Compare a block of streamed samples with the window of the first result
+* @note		Called from adcStreamHandler() on each half, the samples are raw (offset not removed)
+* @arg		U8 adcPort				Hardware ADC ID
+* @arg		const U16 * samplePtr			Samples
+* @arg		U16 sampleNb				Number of samples
+* @return	nothing
+*/
+void adcWindowCheckBlock(U8 adcPort, const U16 * samplePtr, U16 sampleNb)
+{
+	if (adcControl[adcPort].windowPtr[0] == NULL)
+		return;
+
+	while (sampleNb--)
+		adcWindowCheck(adcPort, 0, adcRemoveOffset(adcPort, *samplePtr++));
+}
+
+/**
+* \fn		void adcSaveResult(U8 adcPort, U8 resultIndex, U16 sample, U16 * resultPtr)
+* @brief	Check the window of a sample, then write it in the result through its filter
+* @note		Called from the ISR paths (queue, timed scan), the window see the unfiltered sample
+*			With a filter the result is only written when the filter give an output
+* @arg		U8 adcPort				Hardware ADC ID
+* @arg		U8 resultIndex				Result index of the sample
+* @arg		U16 sample				Sample (offset removed)
+* @arg		U16 * resultPtr				Destination of the result
+* @return	nothing
+*/
+void adcSaveResult(U8 adcPort, U8 resultIndex, U16 sample, U16 * resultPtr)
+{
+	adcWindowCheck(adcPort, resultIndex, sample);
+
+	if (adcControl[adcPort].filterPtr[resultIndex] == NULL)
+		*resultPtr = sample;
+	else
+		filterProcess(adcControl[adcPort].filterPtr[resultIndex], sample, resultPtr);
+}
+
+/**
+* \fn		U16 adcAverage(U32 sum, U16 sampleNb, U32 recip)
+* @brief	Divide an averaging sum by the number of sample, with a multiply by the reciprocal
+* @note		recip is 0xFFFFFFFF / sampleNb, the estimate is at most 1 under the quotient and is corrected once
+* @arg		U32 sum					Sum of the samples
+* @arg		U16 sampleNb				Number of sample in the sum
+* @arg		U32 recip				Reciprocal of sampleNb
+* @return	U16 average				sum / sampleNb
+*/
+U16 adcAverage(U32 sum, U16 sampleNb, U32 recip)
+{
+	U32 quotient = (U32)(((U64)sum * recip) >> 32);
+
+	if ((sum - (quotient * sampleNb)) >= sampleNb)
+		quotient++;
+
+	return quotient;
+}
+
+/**
+* \fn		void adcQueueISR(U8 adcPort)
+* @brief	Save the results of the request in conversion and start the next one
+* @note		Called from adcISR(), the completed request wait in the done list for adcEngine()
+* @arg		U8 adcPort				Hardware ADC ID
+* @return	nothing
+*/
+void adcQueueISR(U8 adcPort)
+{
+	U8 wu0;
+	tADCQueueCtl * workQueue = &adcQueue[adcPort];
+	tADCRequest * requestPtr = workQueue->headPtr;
+
+	adcSelectPort(adcPort);
+
+	// -- Save the results (ADCxBUFn are 0x10 apart) -- //
+	for (wu0 = 0; wu0 < requestPtr->conversionNb; wu0++)
+		adcSaveResult(adcPort, wu0, adcRemoveOffset(adcPort, pADxBUF[wu0 << 2]), &requestPtr->resultPtr[wu0]);
+	// ------------------------------------------------ //
+
+	// -- Move the request in the done list -- //
+	workQueue->headPtr = requestPtr->next;
+	if (workQueue->headPtr == NULL)
+		workQueue->tailPtr = NULL;
+
+	requestPtr->next = NULL;
+	if (workQueue->doneHeadPtr == NULL)
+		workQueue->doneHeadPtr = requestPtr;
+	else
+		workQueue->doneTailPtr->next = requestPtr;
+	workQueue->doneTailPtr = requestPtr;
+	// --------------------------------------- //
+
+	// -- Start the next request -- //
+	if (workQueue->headPtr != NULL)
+		adcQueueStart(adcPort, workQueue->headPtr);
+	else
+		adcControl[adcPort].state = ADCidle;
+	// ---------------------------- //
+}
+
+/**
+* \fn		U8 adcQueueAdd(U8 adcPort, U8 scan, U16 input, U8 conversionNb, U16 * resultPtr, void (*callback)(U8, U16*, U8, void*), void * contextPtr)
+* @brief	Create a request and add it to the queue of the ADC, start it if the ADC is idle
+* @note
+* @arg		U8 adcPort				Hardware ADC ID
+* @arg		U8 scan					1: Scan the input matrix | 0: Convert a single input
+* @arg		U16 input				Input or scan matrix
+* @arg		U8 conversionNb				Number of result
+* @arg		U16 * resultPtr				Destination of the results
+* @arg		void (*callback)(U8, U16*, U8, void*)	Completion callback
+* @arg		void * contextPtr			Context given to the callback
+* @return	U8 errorCode				STD Error Code (STD_EC_SUCCESS if successful)
+*/
+U8 adcQueueAdd(U8 adcPort, U8 scan, U16 input, U8 conversionNb, U16 * resultPtr, void (*callback)(U8, U16*, U8, void*), void * contextPtr)
+{
+	U32 intState;
+	U8 errorCode = STD_EC_SUCCESS;
+	tADCRequest * requestPtr;
+	tADCQueueCtl * workQueue = &adcQueue[adcPort];
+
+	// Disable Global Interrupt
+	intState = intFastDisableGlobal();
+
+	// -- Create the request -- //
+	if (adcPoolReady == 0)
+	{
+		poolInit(&adcRequestPool, adcRequestStorage, sizeof(tADCRequest), ADC_REQUEST_POOL_SIZE);
+		adcPoolReady = 1;
+	}
+	requestPtr = poolAlloc(&adcRequestPool);
+	if (requestPtr == NULL)
+	{
+		intFastRestoreGlobal(intState);
+		return STD_EC_MEMORY;
+	}
+
+	requestPtr->next = NULL;
+	requestPtr->resultPtr = resultPtr;
+	requestPtr->input = input;
+	requestPtr->scan = scan;
+	requestPtr->conversionNb = conversionNb;
+	requestPtr->callback = callback;
+	requestPtr->contextPtr = contextPtr;
+	// ------------------------ //
+
+	// -- Append and start if idle -- //
+	if (adcControl[adcPort].state == ADCidle)
+	{
+		workQueue->headPtr = requestPtr;
+		workQueue->tailPtr = requestPtr;
+		adcControl[adcPort].state = ADCqueue;
+		adcQueueStart(adcPort, requestPtr);
+	}
+	else if (adcControl[adcPort].state == ADCqueue)
+	{
+		workQueue->tailPtr->next = requestPtr;
+		workQueue->tailPtr = requestPtr;
+	}
+	else
+		errorCode = STD_EC_BUSY;				//Used by another mode
+	// ------------------------------ //
+
+	// Restore Interrupt state
+	intFastRestoreGlobal(intState);
+
+	if (errorCode != STD_EC_SUCCESS)
+		poolFree(&adcRequestPool, requestPtr);
+
+	return errorCode;
+}
 // ############################################## //
 
 
@@ -51,13 +333,86 @@ void adcISR(U8 adcPort)
 {
 	tADCreg * workADC = adcRegAddress[adcPort];
 	U8 wu0;
+
+	// -- Queued request -- //
+	if (adcControl[adcPort].state == ADCqueue)
+	{
+		adcQueueISR(adcPort);
+		return;
+	}
+	// -------------------- //
+
+	// -- Timed scan -- //
+	if (adcControl[adcPort].state == ADCtimedScan)
+	{
+		tADCTimedCtl * workTimed = &adcTimed[adcPort];
+
+		adcSelectPort(adcPort);
+		for (wu0 = 0; wu0 < workTimed->inputNb; wu0++)
+			adcSaveResult(adcPort, wu0, adcRemoveOffset(adcPort, pADxBUF[wu0 << 2]), &workTimed->resultPtr[wu0]);	//ADCxBUFn are 0x10 apart
+
+		workTimed->scanDoneNb++;
+		if (workTimed->callback != NULL)
+			workTimed->callback(adcPort, workTimed->resultPtr, workTimed->inputNb, workTimed->contextPtr);
+		return;
+	}
+	// ---------------- //
 	
 	// -- Extract everything in the buffer -- //
-	for (wu0 = 0; wu0 < workADC->ADxCON2.SMPI; wu0++)
+	for (wu0 = 0; wu0 <= workADC->ADxCON2.SMPI; wu0++)
+	{
 		adcControl[adcPort].resultBuffer[wu0] = workADC->ADCxBUF[wu0];
+		adcWindowCheck(adcPort, wu0, adcRemoveOffset(adcPort, adcControl[adcPort].resultBuffer[wu0]));
+	}
+	adcControl[adcPort].newResult = 1;				//Averaging and filters are done in adcEngine()
 	// -------------------------------------- //
 }
 
+/**
+* \fn		void adcStreamHandler(U8 channel, U32 flags, void * contextPtr)
+* @brief	DMA callback of the streaming mode, give the ready half to the stream callback
+* @note		Called from dmaISR()
+* @arg		U8 channel				DMA channel number
+* @arg		U32 flags				Channel interrupt flags
+* @arg		void * contextPtr			Streaming control of the ADC
+* @return	nothing
+*/
+void adcStreamHandler(U8 channel, U32 flags, void * contextPtr)
+{
+	tADCStreamCtl * workStream = contextPtr;
+	tFilter * workFilter = adcControl[workStream->adcPort].filterPtr[0];
+	U16 * halfPtr;
+	U16 outputNb;
+
+	// -- First half filled -- //
+	if (flags & DMA_INT_DESTINATION_HALF)
+	{
+		halfPtr = workStream->bufferPtr;
+		outputNb = workStream->halfSampleNb;
+		adcWindowCheckBlock(workStream->adcPort, halfPtr, outputNb);
+		if (workFilter != NULL)
+			outputNb = filterProcessBlock(workFilter, halfPtr, outputNb, halfPtr);	//In place, the outputs are packed at the start
+		workStream->halfDoneNb++;
+		if (workStream->callback != NULL)
+			workStream->callback(workStream->adcPort, ADC_STREAM_HALF, halfPtr, outputNb, workStream->contextPtr);
+	}
+	// ----------------------- //
+
+	// -- Second half filled -- //
+	if (flags & DMA_INT_BLOCK_DONE)
+	{
+		halfPtr = workStream->bufferPtr + workStream->halfSampleNb;
+		outputNb = workStream->halfSampleNb;
+		adcWindowCheckBlock(workStream->adcPort, halfPtr, outputNb);
+		if (workFilter != NULL)
+			outputNb = filterProcessBlock(workFilter, halfPtr, outputNb, halfPtr);
+		workStream->halfDoneNb++;
+		if (workStream->callback != NULL)
+			workStream->callback(workStream->adcPort, ADC_STREAM_FULL, halfPtr, outputNb, workStream->contextPtr);
+	}
+	// ------------------------ //
+}
+
 /**
 * \fn		void adcEngine(U8 adcPort)
 * @brief	Engine function for advance ADC fonction
@@ -72,6 +427,22 @@ void adcEngine(U8 adcPort)
 		U8 wu0;
 		tADCcontrol * workCtl = &adcControl[adcPort];
 		tADCreg * workADC = adcRegAddress[adcPort];
+		tADCRequest * requestPtr;
+		U32 intState;
+
+		// -- Give the completed requests -- //
+		while (adcQueue[adcPort].doneHeadPtr != NULL)
+		{
+			intState = intFastDisableGlobal();
+			requestPtr = adcQueue[adcPort].doneHeadPtr;
+			adcQueue[adcPort].doneHeadPtr = requestPtr->next;
+			intFastRestoreGlobal(intState);
+
+			if (requestPtr->callback != NULL)
+				requestPtr->callback(adcPort, requestPtr->resultPtr, requestPtr->conversionNb, requestPtr->contextPtr);
+			poolFree(&adcRequestPool, requestPtr);
+		}
+		// --------------------------------- //
 
 		switch (workCtl->state)
 		{
@@ -88,19 +459,23 @@ void adcEngine(U8 adcPort)
 				// -- New conversion result to parse -- //
 				if (workCtl->newResult)
 				{
+					intState = intFastDisableGlobal();
+					workCtl->newResult = 0;			//Shared byte with the ISR
+					intFastRestoreGlobal(intState);
+
 					// -- Averaging --------- //
 					if (workCtl->averaging == ENABLE)
 					{
-						for (wu0 = 0; wu0 < workADC->ADxCON2.SMPI; wu0++)
-							workCtl->averagingBuffer[wu0] += workCtl->resultBuffer[wu0] - workCtl->offsetVal;
+						for (wu0 = 0; wu0 <= workADC->ADxCON2.SMPI; wu0++)
+							workCtl->averagingBuffer[wu0] += adcRemoveOffset(adcPort, workCtl->resultBuffer[wu0]);
 
 						// -- Count the sample -- //
 						workCtl->averagingSampleDoneNb++;
 						if (workCtl->averagingSampleDoneNb >= workCtl->averagingSampleNb)
 						{
-							for (wu0 = 0; wu0 < workADC->ADxCON2.SMPI; wu0++)
+							for (wu0 = 0; wu0 <= workADC->ADxCON2.SMPI; wu0++)
 							{
-								workCtl->resultPtr[wu0] = (workCtl->averagingBuffer[wu0]) / workCtl->averagingSampleNb;
+								workCtl->resultPtr[wu0] = adcAverage(workCtl->averagingBuffer[wu0], workCtl->averagingSampleNb, workCtl->averagingRecip);
 								workCtl->averagingBuffer[wu0] = 0;	//Clear the buffer
 							}
 							workCtl->averagingSampleDoneNb = 0;	//Reset the sample counter
@@ -114,7 +489,12 @@ void adcEngine(U8 adcPort)
 					{
 						// -- Save the result in the destination -- //
 						for (wu0 = 0; wu0 <= workADC->ADxCON2.SMPI; wu0++)
-							workCtl->resultPtr[wu0] = workCtl->resultBuffer[wu0] - workCtl->offsetVal;
+						{
+							if (workCtl->filterPtr[wu0] == NULL)
+								workCtl->resultPtr[wu0] = adcRemoveOffset(adcPort, workCtl->resultBuffer[wu0]);
+							else
+								filterProcess(workCtl->filterPtr[wu0], adcRemoveOffset(adcPort, workCtl->resultBuffer[wu0]), &workCtl->resultPtr[wu0]);
+						}
 						// ---------------------------------------- //
 
 						*(workCtl->donePtr) = ADC_CONV_DONE;		//Flag the completion
@@ -132,6 +512,18 @@ void adcEngine(U8 adcPort)
 
 				break;
 			}
+			case ADCstreaming:
+			{
+				break;						//Everything is done by the DMA
+			}
+			case ADCqueue:
+			{
+				break;						//Requests are started from adcISR()
+			}
+			case ADCtimedScan:
+			{
+				break;						//Results are given from adcISR()
+			}
 			case ADCcalibration:
 			{
 				U32 tempCal = 0;
@@ -188,6 +580,7 @@ U8 adcSelectPort(U8 adcPort)
 */
 U8 adcInit(U8 adcPort)
 {
+	U8 wu0;
 	U8 errorCode = adcSelectPort(adcPort);
 	tADCcontrol * workPtr = &adcControl[adcPort];
 
@@ -208,6 +601,18 @@ U8 adcInit(U8 adcPort)
 		workPtr->offsetVal = 0;
 		workPtr->state = ADCidle;
 		workPtr->donePtr = &__adcSafeDonePtr;
+		for (wu0 = 0; wu0 < ADC_FIFO_LVL; wu0++)
+		{
+			workPtr->filterPtr[wu0] = NULL;
+			workPtr->windowPtr[wu0] = NULL;
+		}
+		adcQueue[adcPort].headPtr = NULL;
+		adcQueue[adcPort].tailPtr = NULL;
+		adcQueue[adcPort].doneHeadPtr = NULL;
+		adcQueue[adcPort].doneTailPtr = NULL;
+		adcQueue[adcPort].appliedScan = 0xFF;		//Force the first request to set the inputs
+		adcQueue[adcPort].appliedSMPI = 0xFF;
+		adcTimed[adcPort].sampleRate = 0;
 		// ------------------ //
 
 		// -- Start the ADC -- //
@@ -376,6 +781,8 @@ U8 adcCalibrate(U8 adcPort)
 		// -- Init for calibration -- //
 		workADC->ADxCON2.OFFCAL = ENABLE;		//Set for calib
 		workADC->ADxCON2.SMPI = ADC_CAL_CONV_NB-1;	//Do the specified amount of conversion
+		adcQueue[adcPort].appliedSMPI = 0xFF;		//Queue must rewrite the inputs
+		adcQueue[adcPort].appliedScan = 0xFF;
 		workADC->ADxCON1.ASAM = 1;			//Auto mode
 		workADC->ADxCON1.CLRASAM = ENABLE;		//Stop after the interrupt
 		workADC->ADxCON1.SAMP = ENABLE;			//Start the conversion
@@ -459,6 +866,8 @@ U8 adcGetScanInputNb(U8 adcPort)
 * @brief	Enable the auto-averaging function of the ADC
 * @note		Will convert all the enabled input and wait for the specified number of sample
 *		and then average the result and save it in the resultPtr
+*		The sums are kept in the port control (no allocation), the average use a reciprocal instead of a divide
+*		Nothing is done if sampleNb is 0 or inputNb is bigger than ADC_FIFO_LVL
 * @arg		U8 adcPort				Hardware ADC ID
 * @arg		U16 sampleNb				Number of sample to average out
 * @arg		U8 inputNb				Number of input actually enabled
@@ -466,23 +875,147 @@ U8 adcGetScanInputNb(U8 adcPort)
 */
 void adcEnableAveraging(U8 adcPort, U16 sampleNb, U8 inputNb)
 {
-	if (adcPort <= ADC_MAX_PORT)
+	U8 wu0;
+
+	if ((adcPort < ADC_MAX_PORT) && sampleNb && (inputNb <= ADC_FIFO_LVL))
 	{
 		tADCcontrol * workCtl = &adcControl[adcPort];
 
-		// -- Allocate the averaging buffer -- //
-		workCtl->averagingBuffer = calloc(inputNb,sizeof(U32));
-		if (workCtl->averagingBuffer != NULL)
-		// ----------------------------------- //
-		{
-			// Count the allocated ram
-			heapAvailable -= sizeof(U32)*inputNb;
+		// -- Clear the sums -- //
+		for (wu0 = 0; wu0 < ADC_FIFO_LVL; wu0++)
+			workCtl->averagingBuffer[wu0] = 0;
+		// -------------------- //
 
-			workCtl->averagingSampleNb = sampleNb;
-			workCtl->averagingSampleDoneNb = 0;
-			workCtl->averaging = ENABLE;
-		}
+		workCtl->averagingSampleNb = sampleNb;
+		workCtl->averagingRecip = 0xFFFFFFFF / sampleNb;
+		workCtl->averagingSampleDoneNb = 0;
+		workCtl->averaging = ENABLE;
+	}
+}
+
+/**
+* \fn		U8 adcSetFilter(U8 adcPort, U8 resultIndex, tFilter * filterPtr)
+* @brief	Apply a filter on a result of the selected ADC port (result index is the order in the scan)
+* @note		The filter must be initialised with a filterInitx() function, use NULL to remove it
+*			A filtered result is written in the resultPtr only when the filter give an output
+*			(ex: a boxcar of 2^4 write 1 result every 16 conversion)
+*			Applied in the ISR for the queue and the timed scan, in adcEngine() for adcConvert()/adcStartScan()
+*			When streaming, the filter of result 0 process each half in place before the callback,
+*			which then get the number of outputs instead of the number of samples
+*			Return STD_EC_NOTFOUND if an invalid port or result index is given
+* @arg		U8 adcPort				Hardware ADC ID
+* @arg		U8 resultIndex				Result to filter (0 to ADC_FIFO_LVL-1)
+* @arg		tFilter * filterPtr			Filter to apply
+* @return	U8 errorCode				STD Error Code (STD_EC_SUCCESS if successful)
+*/
+U8 adcSetFilter(U8 adcPort, U8 resultIndex, tFilter * filterPtr)
+{
+	if ((adcPort >= ADC_MAX_PORT) || (resultIndex >= ADC_FIFO_LVL))
+		return STD_EC_NOTFOUND;
+
+	adcControl[adcPort].filterPtr[resultIndex] = filterPtr;
+
+	return STD_EC_SUCCESS;
+}
+
+/**
+* \fn		U8 adcSetWindow(U8 adcPort, U8 resultIndex, tADCWindow * windowPtr, U16 lowThreshold, U16 highThreshold, U16 hysteresis, void (*callback)(U8, U8, U8, U16, void*), void * contextPtr)
+* @brief	Watch a result of the selected ADC port with a window comparator, checked in adcISR() on each sample
+* @note		The window struct is declared by the user, use NULL to remove the window of this result
+*			ADC_WINDOW_HIGH is raised when a sample is above highThreshold, ADC_WINDOW_LOW when it is below lowThreshold
+*			The alarm is back to ADC_WINDOW_NORMAL only when the sample is inside the window by the hysteresis
+*			The callback is called from adcISR() on each change (port, result index, new state, sample, context)
+*			In streaming mode the window of result 0 is checked from dmaISR() when a half is filled,
+*			before the stream callback, so an alarm can come up to a half buffer late
+*			Return STD_EC_NOTFOUND if an invalid port or result index is given,
+*			STD_EC_INVALID if low > high or if 2*hysteresis > high - low (the window could never get back to normal)
+* @arg		U8 adcPort				Hardware ADC ID
+* @arg		U8 resultIndex				Result to watch (0 to ADC_FIFO_LVL-1, order in the scan)
+* @arg		tADCWindow * windowPtr			Window comparator storage
+* @arg		U16 lowThreshold			Lowest normal sample
+* @arg		U16 highThreshold			Highest normal sample
+* @arg		U16 hysteresis				Margin to get back to normal
+* @arg		void (*callback)(U8, U8, U8, U16, void*)	Alarm callback (NULL if unused)
+* @arg		void * contextPtr			Context given to the callback
+* @return	U8 errorCode				STD Error Code (STD_EC_SUCCESS if successful)
+*/
+U8 adcSetWindow(U8 adcPort, U8 resultIndex, tADCWindow * windowPtr, U16 lowThreshold, U16 highThreshold, U16 hysteresis, void (*callback)(U8, U8, U8, U16, void*), void * contextPtr)
+{
+	U32 intState;
+
+	// -- Handle invalid parameters -- //
+	if ((adcPort >= ADC_MAX_PORT) || (resultIndex >= ADC_FIFO_LVL))
+		return STD_EC_NOTFOUND;
+	if ((windowPtr != NULL) && ((lowThreshold > highThreshold) || ((2 * (U32)hysteresis) > (U32)(highThreshold - lowThreshold))))
+		return STD_EC_INVALID;					//Could never get back to normal
+	// ------------------------------- //
+
+	// Disable Global Interrupt
+	intState = intFastDisableGlobal();
+
+	if (windowPtr != NULL)
+	{
+		windowPtr->lowThreshold = lowThreshold;
+		windowPtr->highThreshold = highThreshold;
+		windowPtr->hysteresis = hysteresis;
+		windowPtr->state = ADC_WINDOW_NORMAL;
+		windowPtr->tripRegPtr = NULL;
+		windowPtr->tripMask = 0;
+		windowPtr->callback = callback;
+		windowPtr->contextPtr = contextPtr;
 	}
+	adcControl[adcPort].windowPtr[resultIndex] = windowPtr;
+
+	// Restore Interrupt state
+	intFastRestoreGlobal(intState);
+
+	return STD_EC_SUCCESS;
+}
+
+/**
+* \fn		U8 adcSetWindowTrip(U8 adcPort, U8 resultIndex, volatile U32 * tripRegPtr, U32 tripMask)
+* @brief	Write a mask in a register as soon as a window alarm is raised (ex: clear a PWM enable pin)
+* @note		The write is done in adcISR() right after the sample is read, before the callback
+*			Use a SET/CLR/INV register for an atomic write (ex: adcSetWindowTrip(ADC_1, 0, &LATBCLR, BIT5))
+*			The register is not restored when the alarm clear, use NULL to remove the trip
+*			Return STD_EC_NOTFOUND if no window is set on this result
+* @arg		U8 adcPort				Hardware ADC ID
+* @arg		U8 resultIndex				Watched result
+* @arg		volatile U32 * tripRegPtr		Register to write
+* @arg		U32 tripMask				Value to write
+* @return	U8 errorCode				STD Error Code (STD_EC_SUCCESS if successful)
+*/
+U8 adcSetWindowTrip(U8 adcPort, U8 resultIndex, volatile U32 * tripRegPtr, U32 tripMask)
+{
+	tADCWindow * workWindow;
+
+	if ((adcPort >= ADC_MAX_PORT) || (resultIndex >= ADC_FIFO_LVL))
+		return STD_EC_NOTFOUND;
+
+	workWindow = adcControl[adcPort].windowPtr[resultIndex];
+	if (workWindow == NULL)
+		return STD_EC_NOTFOUND;
+
+	workWindow->tripMask = tripMask;
+	workWindow->tripRegPtr = tripRegPtr;
+
+	return STD_EC_SUCCESS;
+}
+
+/**
+* \fn		U8 adcGetWindowState(U8 adcPort, U8 resultIndex)
+* @brief	Return the alarm state of a watched result
+* @note		Return ADC_WINDOW_NORMAL if no window is set on this result
+* @arg		U8 adcPort				Hardware ADC ID
+* @arg		U8 resultIndex				Watched result
+* @return	U8 state				ADC_WINDOW_NORMAL, ADC_WINDOW_HIGH or ADC_WINDOW_LOW
+*/
+U8 adcGetWindowState(U8 adcPort, U8 resultIndex)
+{
+	if ((adcPort >= ADC_MAX_PORT) || (resultIndex >= ADC_FIFO_LVL) || (adcControl[adcPort].windowPtr[resultIndex] == NULL))
+		return ADC_WINDOW_NORMAL;
+
+	return adcControl[adcPort].windowPtr[resultIndex]->state;
 }
 // ========================== //
 
@@ -490,8 +1023,9 @@ void adcEnableAveraging(U8 adcPort, U16 sampleNb, U8 inputNb)
 /**
 * \fn		U32 adcConvert(U8 adcPort)
 * @brief	Will start a specified number of conversion on a single channel
-* @note		This function can jam everything...
-*		Super ugly and crappy function, waiting for RTOS to be better
+* @note		Return STD_EC_BUSY if the ADC is not idle (use adcQueueConvert() to wait in a queue)
+*			API change: it used to restart the ADC over the conversion in progress, a busy ADC is now
+*			refused and nothing is started, the caller must check the return before waiting on donePtr
 * @arg		U8 adcPort				Hardware ADC ID
 * @arg		tADCInput adcInput			Analog input to convert
 * @arg		U8 conversionNb				Number of conversion to do and round up (maximum 16)
@@ -512,8 +1046,8 @@ U32 adcConvert(U8 adcPort, tADCInput adcInput, U8 conversionNb, U16 * resultPtr,
 			conversionNb = 16;
 		// --------------------- //
 
-		// Wait for the ADC to be idle
-		while (workCtl->state != ADCidle);
+		if (workCtl->state != ADCidle)
+			return STD_EC_BUSY;
 
 		// -- Select the correct channel -- //
 		workADC->ADxCHS.CH0NA = 0;			//Select VrefL as the negative input
@@ -539,6 +1073,8 @@ U32 adcConvert(U8 adcPort, tADCInput adcInput, U8 conversionNb, U16 * resultPtr,
 		workADC->ADxCON1.ASAM = ENABLE;			//Auto mode
 		workADC->ADxCON1.CLRASAM = ENABLE;			//Stop after SMPI nb of conversion (clear ASAM automaticaly)
 		workADC->ADxCON2.SMPI = conversionNb-1;		//Set the number of conversion to do
+		adcQueue[adcPort].appliedSMPI = 0xFF;		//Queue must rewrite the inputs
+		adcQueue[adcPort].appliedScan = 0xFF;
 
 		workADC->ADxCON1.SAMP = ENABLE;			//Start the sampling/conversion
 		// -------------------------- //
@@ -552,9 +1088,10 @@ U32 adcConvert(U8 adcPort, tADCInput adcInput, U8 conversionNb, U16 * resultPtr,
 /**
 * \fn		U8 adcStartScan(U8 adcPort, U16 * resultPtr, U8 * donePtr)
 * @brief	Start the scan mode on the previously selected input
-* @note		WARNING ! This function can jam everything...
-*		The $resultPtr must have enough space to store the entire result (use adcGetScanInputNb)
-*		Super ugly and crappy function, waiting for RTOS to be better
+* @note		The $resultPtr must have enough space to store the entire result (use adcGetScanInputNb)
+*		Return STD_EC_BUSY if the ADC is not idle (use adcQueueScan() to wait in a queue)
+*		API change: it used to restart the ADC over the conversion in progress, a busy ADC is now
+*		refused and nothing is started, the caller must check the return before waiting on donePtr
 * @arg		U8 adcPort				Hardware ADC ID
 * @arg		U16 * resultPtr				Pointer to store the result
 * @arg		U8 * donePtr				Pointer to flag the completion of the conversion (=ADC_CONV_DONE when done)
@@ -568,8 +1105,8 @@ U8 adcStartScan(U8 adcPort, U16 * resultPtr, U8 * donePtr)
 	errorCode = adcSelectPort(adcPort);
 	if (errorCode == STD_EC_SUCCESS)
 	{
-		// Wait for the ADC to be idle
-		while (workPtr->state != ADCidle);
+		if (workPtr->state != ADCidle)
+			return STD_EC_BUSY;
 
 		// -- Save the variables -- //
 		if (donePtr == NULL)
@@ -587,6 +1124,8 @@ U8 adcStartScan(U8 adcPort, U16 * resultPtr, U8 * donePtr)
 
 		// -- Count the number of conversion -- //
 		pADxCON2->SMPI = adcGetScanInputeNb(adcPort) -1;//Set the number of conversion to do
+		adcQueue[adcPort].appliedSMPI = 0xFF;		//Queue must rewrite the inputs
+		adcQueue[adcPort].appliedScan = 0xFF;
 		// ------------------------------------ //
 
 		// -- Start the scan -- //
@@ -620,5 +1159,325 @@ U8 adcStopScan(U8 adcPort)
 	return STD_EC_NOTFOUND;
 }
 // ============================= //
-// ############################################## //
 
+// == Queue Functions ===== //
+/**
+* \fn		U8 adcQueueConvert(U8 adcPort, tADCInput adcInput, U8 conversionNb, U16 * resultPtr, void (*callback)(U8, U16*, U8, void*), void * contextPtr)
+* @brief	Queue a number of conversion on a single input, never wait for the ADC
+* @note		Requests are done in order, the next one is started from adcISR() as soon as one is done
+*			The callback is called from adcEngine() with the port, the resultPtr, the number of result and the context
+*			The MUX and SMPI are not rewritten if they are the same as the previous request
+*			Return STD_EC_BUSY if the ADC is used by another mode, STD_EC_MEMORY if the request pool is empty
+* @arg		U8 adcPort				Hardware ADC ID
+* @arg		tADCInput adcInput			Analog input to convert
+* @arg		U8 conversionNb				Number of conversion (1 to ADC_FIFO_LVL)
+* @arg		U16 * resultPtr				Destination of the results
+* @arg		void (*callback)(U8, U16*, U8, void*)	Completion callback (NULL if unused)
+* @arg		void * contextPtr			Context given to the callback
+* @return	U8 errorCode				STD Error Code (STD_EC_SUCCESS if successful)
+*/
+U8 adcQueueConvert(U8 adcPort, tADCInput adcInput, U8 conversionNb, U16 * resultPtr, void (*callback)(U8, U16*, U8, void*), void * contextPtr)
+{
+	// -- Handle invalid parameters -- //
+	if (adcPort >= ADC_MAX_PORT)
+		return STD_EC_NOTFOUND;
+	if ((resultPtr == NULL) || (conversionNb == 0) || (conversionNb > ADC_FIFO_LVL))
+		return STD_EC_INVALID;
+	// ------------------------------- //
+
+	return adcQueueAdd(adcPort, 0, adcInput, conversionNb, resultPtr, callback, contextPtr);
+}
+
+/**
+* \fn		U8 adcQueueScan(U8 adcPort, tADCMuxInput scanInput, U16 * resultPtr, void (*callback)(U8, U16*, U8, void*), void * contextPtr)
+* @brief	Queue a scan of an input matrix, never wait for the ADC
+* @note		Same as adcQueueConvert(), there is 1 result per enabled input (in the order of the inputs)
+* @arg		U8 adcPort				Hardware ADC ID
+* @arg		tADCMuxInput scanInput			Input matrix to scan
+* @arg		U16 * resultPtr				Destination of the results
+* @arg		void (*callback)(U8, U16*, U8, void*)	Completion callback (NULL if unused)
+* @arg		void * contextPtr			Context given to the callback
+* @return	U8 errorCode				STD Error Code (STD_EC_SUCCESS if successful)
+*/
+U8 adcQueueScan(U8 adcPort, tADCMuxInput scanInput, U16 * resultPtr, void (*callback)(U8, U16*, U8, void*), void * contextPtr)
+{
+	// -- Handle invalid parameters -- //
+	if (adcPort >= ADC_MAX_PORT)
+		return STD_EC_NOTFOUND;
+	if ((resultPtr == NULL) || ((scanInput & 0xFFFF) == 0))
+		return STD_EC_INVALID;
+	// ------------------------------- //
+
+	return adcQueueAdd(adcPort, 1, scanInput & 0xFFFF, __builtin_popcount(scanInput & 0xFFFF), resultPtr, callback, contextPtr);
+}
+// ========================== //
+
+// == Timed Functions ====== //
+/**
+* \fn		U8 adcSetTimerTrigger(U8 adcPort, U32 sampleRate, U32 * achievedRatePtr)
+* @brief	Trigger each conversion of the ADC with the Timer 3 period match, for a jitter-free sample rate
+* @note		Timer 3 is reserved for the ADC while this trigger is used
+*			The prescaler and period are computed in integer, the achieved rate (PBCLK/(prescaler*period))
+*			is written in achievedRatePtr (can be NULL)
+*			Every mode (queue, scan, stream) then convert on the timer, use a sampleRate of 0 to go back to auto-convert
+*			Return STD_EC_TOOLARGE if the ADC timing (adcSetSampleRate) cannot convert at this rate
+*			Return STD_EC_TOOSMALL if the rate is too low for Timer 3
+* @arg		U8 adcPort				Hardware ADC ID
+* @arg		U32 sampleRate				Conversion rate (in conversion per second)
+* @arg		U32 * achievedRatePtr			Where to write the achieved rate (in conversion per second)
+* @return	U8 errorCode				STD Error Code (STD_EC_SUCCESS if successful)
+*/
+U8 adcSetTimerTrigger(U8 adcPort, U32 sampleRate, U32 * achievedRatePtr)
+{
+	U8 errorCode;
+	U8 adcON;
+	U64 achievedPeriod;
+
+	errorCode = adcSelectPort(adcPort);
+	if (errorCode != STD_EC_SUCCESS)
+		return errorCode;
+
+	// -- Back to auto-convert -- //
+	if (sampleRate == 0)
+	{
+		timerStop(TIMER_3);
+		adcON = pADxCON1->ON;
+		pADxCON1->ON = 0;
+		pADxCON1->SSRC = ADC_TRIG_AUTO;
+		pADxCON1->ON = adcON;
+		adcTimed[adcPort].sampleRate = 0;
+		return STD_EC_SUCCESS;
+	}
+	// -------------------------- //
+
+	// -- Check the ADC timing -- //
+	if (sampleRate > adcGetSampleRate(adcPort))
+		return STD_EC_TOOLARGE;					//Conversion is longer than the period
+	// -------------------------- //
+
+	// -- Smallest prescaler with a 16bit period -- //
+	timerStop(TIMER_3);
+	timerInit(TIMER_3, TMR_DIV_1|TMR_CS_PBCLK|TMR_16BIT|TMR_IDLE_RUN|TMR_GATE_DIS);
+	errorCode = timerSetPeriod(TIMER_3, (((U64)1000000000) + (sampleRate >> 1)) / sampleRate, &achievedPeriod);	//In ns, rounded once to the count
+	if (errorCode == STD_EC_TOOLARGE)
+		return STD_EC_TOOSMALL;					//Period too long for Timer 3
+	if ((errorCode != STD_EC_SUCCESS) || (timerGetPR(TIMER_3) == 0))
+		return STD_EC_TOOLARGE;					//Less than 2 count
+	// -------------------------------------------- //
+
+	// -- Start the timer -- //
+	timerClear(TIMER_3);
+	timerStart(TIMER_3);
+	// --------------------- //
+
+	// -- Convert on the Timer 3 period match -- //
+	adcSelectPort(adcPort);
+	adcON = pADxCON1->ON;
+	pADxCON1->ON = 0;
+	pADxCON1->SSRC = ADC_TRIG_TIMER3;
+	pADxCON1->ON = adcON;
+	// ----------------------------------------- //
+
+	adcTimed[adcPort].sampleRate = (U32)(1000000000 / achievedPeriod);
+	if (achievedRatePtr != NULL)
+		*achievedRatePtr = adcTimed[adcPort].sampleRate;
+
+	return STD_EC_SUCCESS;
+}
+
+/**
+* \fn		U8 adcStartTimedScan(U8 adcPort, tADCMuxInput scanInput, U16 * resultPtr, void (*callback)(U8, U16*, U8, void*), void * contextPtr)
+* @brief	Continuously scan an input matrix, 1 input per Timer 3 period (use adcSetTimerTrigger() before)
+* @note		Each input is sampled at sampleRate/inputNb, the input n always at n/sampleRate after the first one
+*			The callback is called from adcISR() after each complete scan with the results (1 per input)
+*			resultPtr must have space for 1 result per enabled input
+*			Return STD_EC_INVALID if the timer trigger is not set, STD_EC_BUSY if the ADC is not idle
+* @arg		U8 adcPort				Hardware ADC ID
+* @arg		tADCMuxInput scanInput			Input matrix to scan
+* @arg		U16 * resultPtr				Destination of the results
+* @arg		void (*callback)(U8, U16*, U8, void*)	Scan done callback (port, resultPtr, result nb, context)
+* @arg		void * contextPtr			Context given to the callback
+* @return	U8 errorCode				STD Error Code (STD_EC_SUCCESS if successful)
+*/
+U8 adcStartTimedScan(U8 adcPort, tADCMuxInput scanInput, U16 * resultPtr, void (*callback)(U8, U16*, U8, void*), void * contextPtr)
+{
+	U8 errorCode;
+	tADCTimedCtl * workTimed = &adcTimed[adcPort];
+
+	// -- Handle invalid parameters -- //
+	errorCode = adcSelectPort(adcPort);
+	if (errorCode != STD_EC_SUCCESS)
+		return errorCode;
+	if ((resultPtr == NULL) || ((scanInput & 0xFFFF) == 0) || (workTimed->sampleRate == 0))
+		return STD_EC_INVALID;
+	if (adcControl[adcPort].state != ADCidle)
+		return STD_EC_BUSY;
+	// ------------------------------- //
+
+	// -- Save the scan -- //
+	workTimed->resultPtr = resultPtr;
+	workTimed->inputNb = __builtin_popcount(scanInput & 0xFFFF);
+	workTimed->scanDoneNb = 0;
+	workTimed->callback = callback;
+	workTimed->contextPtr = contextPtr;
+	adcControl[adcPort].state = ADCtimedScan;
+	// ------------------- //
+
+	// -- Set the scan: 1 interrupt per complete scan -- //
+	pADxCON1->ASAM = DISABLE;
+	pADxCSSL->CSSL = scanInput & 0xFFFF;
+	pADxCON2->CSCNA = ENABLE;
+	pADxCON2->SMPI = workTimed->inputNb - 1;
+	adcQueue[adcPort].appliedSMPI = 0xFF;		//Queue must rewrite the inputs
+	adcQueue[adcPort].appliedScan = 0xFF;
+	// ------------------------------------------------- //
+
+	// -- Start: sample continuously, convert on the timer -- //
+	pADxCON1->CLRASAM = DISABLE;
+	pADxCON1->ASAM = ENABLE;
+	// ------------------------------------------------------ //
+
+	return STD_EC_SUCCESS;
+}
+
+/**
+* \fn		U8 adcStopTimedScan(U8 adcPort)
+* @brief	Stop the continuous timed scan of the selected ADC
+* @note		Stop after the actual conversion, the timer trigger stay set
+* @arg		U8 adcPort				Hardware ADC ID
+* @return	U8 errorCode				STD Error Code (STD_EC_SUCCESS if successful)
+*/
+U8 adcStopTimedScan(U8 adcPort)
+{
+	U8 errorCode = adcSelectPort(adcPort);
+
+	if (errorCode == STD_EC_SUCCESS)
+	{
+		if (adcControl[adcPort].state != ADCtimedScan)
+			return STD_EC_INVALID;
+
+		pADxCON1->ASAM = DISABLE;
+		pADxCON2->CSCNA = DISABLE;
+		adcControl[adcPort].state = ADCidle;
+	}
+
+	return errorCode;
+}
+// ========================== //
+
+// == Streaming Functions === //
+/**
+* \fn		U8 adcStartStream(U8 adcPort, U8 dmaChannel, U16 * bufferPtr, U16 sampleNb, void (*callback)(U8, U8, U16*, U16, void*), void * contextPtr)
+* @brief	Start a continuous capture of the actual input, moved by a DMA channel in a ping-pong buffer
+* @note		The ADC is set to interrupt on each conversion, its interrupt flag trigger the DMA (the CPU interrupt is disabled)
+*			The callback is called from dmaISR() with ADC_STREAM_HALF when the first half is filled
+*			and with ADC_STREAM_FULL when the second half is filled, the DMA then continue in the first half
+*			The half given to the callback must be processed before the DMA come back to it
+*			The sample rate and the input must be set before, the DMA channel must be allocated and its ISR call dmaISR()
+*			Use adcSetTimerTrigger() before for a jitter-free capture
+*			A window set on result 0 check every sample of a half before the callback get it
+*			A filter set on result 0 process the half in place, the callback then get the number of outputs
+*			Return STD_EC_INVALID if sampleNb is odd, null or bigger than the DMA can handle
+* @arg		U8 adcPort				Hardware ADC ID
+* @arg		U8 dmaChannel				DMA channel number
+* @arg		U16 * bufferPtr				Capture buffer
+* @arg		U16 sampleNb				Size of the capture buffer (in sample)
+* @arg		void (*callback)(U8, U8, U16*, U16, void*)	Half ready callback (port, event, half pointer, sample nb in the half, context)
+* @arg		void * contextPtr			Context given to the callback
+* @return	U8 errorCode				STD Error Code (STD_EC_SUCCESS if successful)
+*/
+U8 adcStartStream(U8 adcPort, U8 dmaChannel, U16 * bufferPtr, U16 sampleNb, void (*callback)(U8, U8, U16*, U16, void*), void * contextPtr)
+{
+	U8 errorCode;
+	U8 startIRQ;
+	tADCStreamCtl * workStream = &adcStream[adcPort];
+
+	// -- Handle invalid parameters -- //
+	errorCode = adcSelectPort(adcPort);
+	if (errorCode != STD_EC_SUCCESS)
+		return errorCode;
+	if ((bufferPtr == NULL) || (sampleNb < 2) || (sampleNb & 0x1) || (((U32)sampleNb * sizeof(U16)) > DMA_MAX_SIZE))
+		return STD_EC_INVALID;
+	// ------------------------------- //
+
+	if (adcControl[adcPort].state != ADCidle)
+		return STD_EC_BUSY;
+
+	// -- Stop the conversion -- //
+	pADxCON1->ASAM = DISABLE;
+	pADxCON2->CSCNA = DISABLE;
+	pADxCON2->SMPI = 0;				//Interrupt flag on each conversion, result always in ADCxBUF0
+	adcQueue[adcPort].appliedSMPI = 0xFF;		//Queue must rewrite the inputs
+	adcQueue[adcPort].appliedScan = 0xFF;
+	pADxCON2->BUFM = 0;				//16 word buffer
+	switch (adcPort)
+	{
+		case ADC_1:	startIRQ = IRQ_ADC_1; intFastDisable(INT_ADC_1);	break;
+		default:	return STD_EC_NOTFOUND;
+	}
+	// ------------------------- //
+
+	// -- Save the stream -- //
+	workStream->bufferPtr = bufferPtr;
+	workStream->halfSampleNb = sampleNb >> 1;
+	workStream->dmaChannel = dmaChannel;
+	workStream->adcPort = adcPort;
+	workStream->halfDoneNb = 0;
+	workStream->callback = callback;
+	workStream->contextPtr = contextPtr;
+	// --------------------- //
+
+	// -- Setup the DMA: 1 sample per ADC interrupt, restart at the end of the buffer -- //
+	errorCode = dmaSetupNormalTransfer(dmaChannel, DMA_PRIORITY_3|DMA_AUTO_ENABLE_ON, startIRQ, DMA_IRQ_NONE, (void*)pADxBUF, sizeof(U16), bufferPtr, (U32)sampleNb * sizeof(U16), sizeof(U16));
+	if (errorCode != STD_EC_SUCCESS)
+		return errorCode;
+	dmaSetCallback(dmaChannel, &adcStreamHandler, workStream, DMA_INT_DESTINATION_HALF|DMA_INT_BLOCK_DONE);
+	dmaEnable(dmaChannel);
+	// --------------------------------------------------------------------------------- //
+
+	// -- Start the conversion -- //
+	adcControl[adcPort].state = ADCstreaming;
+	pADxCON1->CLRASAM = DISABLE;			//Never stop
+	pADxCON1->ASAM = ENABLE;			//Auto mode
+	// -------------------------- //
+
+	return STD_EC_SUCCESS;
+}
+
+/**
+* \fn		U8 adcStopStream(U8 adcPort)
+* @brief	Stop the continuous capture of the selected ADC
+* @note		The DMA channel is disabled but stay allocated, the ADC interrupt is enabled again
+* @arg		U8 adcPort				Hardware ADC ID
+* @return	U8 errorCode				STD Error Code (STD_EC_SUCCESS if successful)
+*/
+U8 adcStopStream(U8 adcPort)
+{
+	U8 errorCode = adcSelectPort(adcPort);
+
+	if (errorCode == STD_EC_SUCCESS)
+	{
+		if (adcControl[adcPort].state != ADCstreaming)
+			return STD_EC_INVALID;
+
+		// -- Stop the conversion and the DMA -- //
+		pADxCON1->ASAM = DISABLE;
+		dmaAbort(adcStream[adcPort].dmaChannel);
+		dmaSetCallback(adcStream[adcPort].dmaChannel, NULL, NULL, 0);
+		// ------------------------------------- //
+
+		// -- Give back the interrupt to the CPU -- //
+		switch (adcPort)
+		{
+			case ADC_1:	intFastClearFlag(INT_ADC_1); intFastEnable(INT_ADC_1);	break;
+			default:	break;
+		}
+		// ---------------------------------------- //
+
+		adcControl[adcPort].state = ADCidle;
+	}
+
+	return errorCode;
+}
+// ========================== //
+// ############################################## //
@@ -21,6 +21,10 @@
 // Lib
 #include <peripheral/pic32_clock.h>
 #include <peripheral/pic32_interrupt.h>
+#include <peripheral/pic32_dma.h>
+#include <peripheral/pic32_timer.h>
+#include <soft/pic32_filter.h>
+#include <soft/pic32_pool.h>
 
 // Definition
 #include <definition/stddef_megaxone.h>
@@ -33,6 +37,12 @@
 
 
 // ################## Defines ################### //
+// == Application Dependant == //
+#ifndef ADC_REQUEST_POOL_SIZE
+	#define ADC_REQUEST_POOL_SIZE	8			//Number of conversion request that can be queued (all ports)
+#endif
+// =========================== //
+
 // == Flag State == //
 #define ADC_CONV_DONE			1
 #define ADC_CONV_BUSY			0
@@ -49,10 +59,25 @@
 #define ADC_BOOT_TIME			2000			//Stabilisation time at boot in ns
 // ======================= //
 
+// == Streaming Event ==== //
+#define ADC_STREAM_HALF			0			//First half of the capture buffer is ready
+#define ADC_STREAM_FULL			1			//Second half of the capture buffer is ready
+// ======================= //
+
+// == Window State ======= //
+#define ADC_WINDOW_NORMAL		0			//Sample is inside the window
+#define ADC_WINDOW_HIGH			1			//Sample went above the high threshold
+#define ADC_WINDOW_LOW			2			//Sample went below the low threshold
+// ======================= //
+
 // == Calibration ======== //
 #define ADC_CAL_CONV_NB			10
 // ======================= //
 
+// == Buffer ============= //
+#define ADC_FIFO_LVL			16			//Number of result buffer in the ADC
+// ======================= //
+
 // == Mode Selection ===== //
 #define ADC_MODE_SINGLE			0x0
 #define ADC_MODE_CONTINUOUS		0x1
@@ -91,6 +116,9 @@ typedef enum
 	ADCconfig,
 	ADCbusy,
 	ADCcalibration,
+	ADCstreaming,
+	ADCqueue,
+	ADCtimedScan,
 	ADCerror,
 }tADCState;
 
@@ -144,6 +172,20 @@ typedef enum
 	muxVss = 0x8000
 }tADCMuxInput;
 
+//ADC Window Comparator
+typedef struct
+{
+	U16 lowThreshold;			//Lowest normal sample
+	U16 highThreshold;			//Highest normal sample
+	U16 hysteresis;				//Margin inside the window to get back to normal
+	U8 state;				//Actual alarm (ADC_WINDOW_x)
+	U8 :8;
+	volatile U32 * tripRegPtr;		//Register written on an alarm (NULL if unused)
+	U32 tripMask;				//Value written in the trip register
+	void (*callback)(U8 adcPort, U8 resultIndex, U8 state, U16 sample, void * contextPtr);	//Alarm callback (NULL if unused)
+	void * contextPtr;			//Context given to the callback
+}tADCWindow;
+
 //ADC General Control
 typedef struct
 {
@@ -155,14 +197,64 @@ typedef struct
 	S16 offsetVal;
 	U16 averagingSampleNb;
 	U16 averagingSampleDoneNb;
+	U32 averagingRecip;			//0xFFFFFFFF / averagingSampleNb, the average is a multiply instead of a divide
 
-	U32 * averagingBuffer;
 	U8 * donePtr;
 	U16 * resultPtr;
 
 	U16 resultBuffer[ADC_FIFO_LVL];
+	tFilter * filterPtr[ADC_FIFO_LVL];	//Filter applied on each result (NULL if unused)
+	tADCWindow * windowPtr[ADC_FIFO_LVL];	//Window comparator on each result (NULL if unused)
+	U32 averagingBuffer[ADC_FIFO_LVL];	//Sum of each result while averaging
 }tADCcontrol;
 
+//ADC Conversion Request
+typedef struct sADCRequest
+{
+	struct sADCRequest * next;		//Next request in the queue
+	U16 * resultPtr;			//Destination of the results
+	U16 input;				//Input (tADCInput) or scan matrix (tADCMuxInput)
+	U8 scan;				//1: Scan the input matrix | 0: Convert a single input
+	U8 conversionNb;			//Number of result
+	void (*callback)(U8 adcPort, U16 * resultPtr, U8 resultNb, void * contextPtr);	//Completion callback (NULL if unused)
+	void * contextPtr;			//Context given to the callback
+}tADCRequest;
+
+//ADC Request Queue Control
+typedef struct
+{
+	tADCRequest * headPtr;			//Request in conversion
+	tADCRequest * tailPtr;			//Last queued request
+	tADCRequest * doneHeadPtr;		//Completed request waiting for adcEngine()
+	tADCRequest * doneTailPtr;
+	U16 appliedInput;			//Input or scan matrix actually set in the ADC
+	U8 appliedScan;				//Scan mode actually set in the ADC (0xFF if unknown)
+	U8 appliedSMPI;				//SMPI actually set in the ADC
+}tADCQueueCtl;
+
+//ADC Timed Scan Control
+typedef struct
+{
+	U16 * resultPtr;			//Destination of the results
+	U8 inputNb;				//Number of input in the scan
+	U32 sampleRate;				//Achieved conversion rate (0 if the timer trigger is not set)
+	U32 scanDoneNb;				//Number of scan done since the start
+	void (*callback)(U8 adcPort, U16 * resultPtr, U8 resultNb, void * contextPtr);	//Scan done callback (NULL if unused)
+	void * contextPtr;			//Context given to the callback
+}tADCTimedCtl;
+
+//ADC Streaming Control
+typedef struct
+{
+	U16 * bufferPtr;			//Capture buffer (2 halves)
+	U16 halfSampleNb;			//Number of sample in a half
+	U8 dmaChannel;				//DMA channel moving the samples
+	U8 adcPort;				//Hardware ADC ID
+	U32 halfDoneNb;				//Number of half delivered since the start
+	void (*callback)(U8 adcPort, U8 event, U16 * dataPtr, U16 sampleNb, void * contextPtr);	//Half ready callback
+	void * contextPtr;			//Context given to the callback
+}tADCStreamCtl;
+
 // == Register Pointer == //
 //ADxCON1
 typedef union
@@ -409,20 +501,88 @@ U8 adcGetScanInputNb(U8 adcPort);
 * @brief	Enable the auto-averaging function of the ADC
 * @note		Will convert all the enabled input and wait for the specified number of sample
 *		and then average the result and save it in the resultPtr
+*		The sums are kept in the port control (no allocation), the average use a reciprocal instead of a divide
+*		Nothing is done if sampleNb is 0 or inputNb is bigger than ADC_FIFO_LVL
 * @arg		U8 adcPort				Hardware ADC ID
 * @arg		U16 sampleNb				Number of sample to average out
 * @arg		U8 inputNb				Number of input actually enabled
 * @return	U8 errorCode				STD Error Code (STD_EC_SUCCESS if successful)
 */
 void adcEnableAveraging(U8 adcPort, U16 sampleNb, U8 inputNb);
+
+/**
+* \fn		U8 adcSetFilter(U8 adcPort, U8 resultIndex, tFilter * filterPtr)
+* @brief	Apply a filter on a result of the selected ADC port (result index is the order in the scan)
+* @note		The filter must be initialised with a filterInitx() function, use NULL to remove it
+*			A filtered result is written in the resultPtr only when the filter give an output
+*			(ex: a boxcar of 2^4 write 1 result every 16 conversion)
+*			Applied in the ISR for the queue and the timed scan, in adcEngine() for adcConvert()/adcStartScan()
+*			When streaming, the filter of result 0 process each half in place before the callback,
+*			which then get the number of outputs instead of the number of samples
+*			Return STD_EC_NOTFOUND if an invalid port or result index is given
+* @arg		U8 adcPort				Hardware ADC ID
+* @arg		U8 resultIndex				Result to filter (0 to ADC_FIFO_LVL-1)
+* @arg		tFilter * filterPtr			Filter to apply
+* @return	U8 errorCode				STD Error Code (STD_EC_SUCCESS if successful)
+*/
+U8 adcSetFilter(U8 adcPort, U8 resultIndex, tFilter * filterPtr);
+
+/**
+* \fn		U8 adcSetWindow(U8 adcPort, U8 resultIndex, tADCWindow * windowPtr, U16 lowThreshold, U16 highThreshold, U16 hysteresis, void (*callback)(U8, U8, U8, U16, void*), void * contextPtr)
+* @brief	Watch a result of the selected ADC port with a window comparator, checked in adcISR() on each sample
+* @note		The window struct is declared by the user, use NULL to remove the window of this result
+*			ADC_WINDOW_HIGH is raised when a sample is above highThreshold, ADC_WINDOW_LOW when it is below lowThreshold
+*			The alarm is back to ADC_WINDOW_NORMAL only when the sample is inside the window by the hysteresis
+*			The callback is called from adcISR() on each change (port, result index, new state, sample, context)
+*			In streaming mode the window of result 0 is checked from dmaISR() when a half is filled,
+*			before the stream callback, so an alarm can come up to a half buffer late
+*			Return STD_EC_NOTFOUND if an invalid port or result index is given,
+*			STD_EC_INVALID if low > high or if 2*hysteresis > high - low (the window could never get back to normal)
+* @arg		U8 adcPort				Hardware ADC ID
+* @arg		U8 resultIndex				Result to watch (0 to ADC_FIFO_LVL-1, order in the scan)
+* @arg		tADCWindow * windowPtr			Window comparator storage
+* @arg		U16 lowThreshold			Lowest normal sample
+* @arg		U16 highThreshold			Highest normal sample
+* @arg		U16 hysteresis				Margin to get back to normal
+* @arg		void (*callback)(U8, U8, U8, U16, void*)	Alarm callback (NULL if unused)
+* @arg		void * contextPtr			Context given to the callback
+* @return	U8 errorCode				STD Error Code (STD_EC_SUCCESS if successful)
+*/
+U8 adcSetWindow(U8 adcPort, U8 resultIndex, tADCWindow * windowPtr, U16 lowThreshold, U16 highThreshold, U16 hysteresis, void (*callback)(U8, U8, U8, U16, void*), void * contextPtr);
+
+/**
+* \fn		U8 adcSetWindowTrip(U8 adcPort, U8 resultIndex, volatile U32 * tripRegPtr, U32 tripMask)
+* @brief	Write a mask in a register as soon as a window alarm is raised (ex: clear a PWM enable pin)
+* @note		The write is done in adcISR() right after the sample is read, before the callback
+*			Use a SET/CLR/INV register for an atomic write (ex: adcSetWindowTrip(ADC_1, 0, &LATBCLR, BIT5))
+*			The register is not restored when the alarm clear, use NULL to remove the trip
+*			Return STD_EC_NOTFOUND if no window is set on this result
+* @arg		U8 adcPort				Hardware ADC ID
+* @arg		U8 resultIndex				Watched result
+* @arg		volatile U32 * tripRegPtr		Register to write
+* @arg		U32 tripMask				Value to write
+* @return	U8 errorCode				STD Error Code (STD_EC_SUCCESS if successful)
+*/
+U8 adcSetWindowTrip(U8 adcPort, U8 resultIndex, volatile U32 * tripRegPtr, U32 tripMask);
+
+/**
+* \fn		U8 adcGetWindowState(U8 adcPort, U8 resultIndex)
+* @brief	Return the alarm state of a watched result
+* @note		Return ADC_WINDOW_NORMAL if no window is set on this result
+* @arg		U8 adcPort				Hardware ADC ID
+* @arg		U8 resultIndex				Watched result
+* @return	U8 state				ADC_WINDOW_NORMAL, ADC_WINDOW_HIGH or ADC_WINDOW_LOW
+*/
+U8 adcGetWindowState(U8 adcPort, U8 resultIndex);
 // ========================== //
 
 // == Conversion Functions == //
 /**
 * \fn		U32 adcConvert(U8 adcPort)
 * @brief	Will start a specified number of conversion on a single channel
-* @note		This function can jam everything...
-*		Super ugly and crappy function, waiting for RTOS to be better
+* @note		Return STD_EC_BUSY if the ADC is not idle (use adcQueueConvert() to wait in a queue)
+*			API change: it used to restart the ADC over the conversion in progress, a busy ADC is now
+*			refused and nothing is started, the caller must check the return before waiting on donePtr
 * @arg		U8 adcPort				Hardware ADC ID
 * @arg		tADCInput adcInput			Analog input to convert
 * @arg		U8 conversionNb				Number of conversion to do and round up (maximum 16)
@@ -435,9 +595,10 @@ U32 adcConvert(U8 adcPort, tADCInput adcInput, U8 conversionNb, U16 * resultPtr,
 /**
 * \fn		U8 adcStartScan(U8 adcPort, U16 * resultPtr, U8 * donePtr)
 * @brief	Start the scan mode on the previously selected input
-* @note		WARNING ! This function can jam everything...
-*		The $resultPtr must have enough space to store the entire result (use adcGetScanInputNb)
-*		Super ugly and crappy function, waiting for RTOS to be better
+* @note		The $resultPtr must have enough space to store the entire result (use adcGetScanInputNb)
+*		Return STD_EC_BUSY if the ADC is not idle (use adcQueueScan() to wait in a queue)
+*		API change: it used to restart the ADC over the conversion in progress, a busy ADC is now
+*		refused and nothing is started, the caller must check the return before waiting on donePtr
 * @arg		U8 adcPort				Hardware ADC ID
 * @arg		U16 * resultPtr				Pointer to store the result
 * @arg		U8 * donePtr				Pointer to flag the completion of the conversion (=ADC_CONV_DONE when done)
@@ -454,13 +615,120 @@ U8 adcStartScan(U8 adcPort, U16 * resultPtr, U8 * donePtr);
 */
 U8 adcStopScan(U8 adcPort);
 // ========================== //
+
+// == Queue Functions ===== //
+/**
+* \fn		U8 adcQueueConvert(U8 adcPort, tADCInput adcInput, U8 conversionNb, U16 * resultPtr, void (*callback)(U8, U16*, U8, void*), void * contextPtr)
+* @brief	Queue a number of conversion on a single input, never wait for the ADC
+* @note		Requests are done in order, the next one is started from adcISR() as soon as one is done
+*			The callback is called from adcEngine() with the port, the resultPtr, the number of result and the context
+*			The MUX and SMPI are not rewritten if they are the same as the previous request
+*			Return STD_EC_BUSY if the ADC is used by another mode, STD_EC_MEMORY if the request pool is empty
+* @arg		U8 adcPort				Hardware ADC ID
+* @arg		tADCInput adcInput			Analog input to convert
+* @arg		U8 conversionNb				Number of conversion (1 to ADC_FIFO_LVL)
+* @arg		U16 * resultPtr				Destination of the results
+* @arg		void (*callback)(U8, U16*, U8, void*)	Completion callback (NULL if unused)
+* @arg		void * contextPtr			Context given to the callback
+* @return	U8 errorCode				STD Error Code (STD_EC_SUCCESS if successful)
+*/
+U8 adcQueueConvert(U8 adcPort, tADCInput adcInput, U8 conversionNb, U16 * resultPtr, void (*callback)(U8, U16*, U8, void*), void * contextPtr);
+
+/**
+* \fn		U8 adcQueueScan(U8 adcPort, tADCMuxInput scanInput, U16 * resultPtr, void (*callback)(U8, U16*, U8, void*), void * contextPtr)
+* @brief	Queue a scan of an input matrix, never wait for the ADC
+* @note		Same as adcQueueConvert(), there is 1 result per enabled input (in the order of the inputs)
+* @arg		U8 adcPort				Hardware ADC ID
+* @arg		tADCMuxInput scanInput			Input matrix to scan
+* @arg		U16 * resultPtr				Destination of the results
+* @arg		void (*callback)(U8, U16*, U8, void*)	Completion callback (NULL if unused)
+* @arg		void * contextPtr			Context given to the callback
+* @return	U8 errorCode				STD Error Code (STD_EC_SUCCESS if successful)
+*/
+U8 adcQueueScan(U8 adcPort, tADCMuxInput scanInput, U16 * resultPtr, void (*callback)(U8, U16*, U8, void*), void * contextPtr);
+// ========================== //
+
+// == Timed Functions ====== //
+/**
+* \fn		U8 adcSetTimerTrigger(U8 adcPort, U32 sampleRate, U32 * achievedRatePtr)
+* @brief	Trigger each conversion of the ADC with the Timer 3 period match, for a jitter-free sample rate
+* @note		Timer 3 is reserved for the ADC while this trigger is used
+*			The prescaler and period are computed in integer, the achieved rate (PBCLK/(prescaler*period))
+*			is written in achievedRatePtr (can be NULL)
+*			Every mode (queue, scan, stream) then convert on the timer, use a sampleRate of 0 to go back to auto-convert
+*			Return STD_EC_TOOLARGE if the ADC timing (adcSetSampleRate) cannot convert at this rate
+*			Return STD_EC_TOOSMALL if the rate is too low for Timer 3
+* @arg		U8 adcPort				Hardware ADC ID
+* @arg		U32 sampleRate				Conversion rate (in conversion per second)
+* @arg		U32 * achievedRatePtr			Where to write the achieved rate (in conversion per second)
+* @return	U8 errorCode				STD Error Code (STD_EC_SUCCESS if successful)
+*/
+U8 adcSetTimerTrigger(U8 adcPort, U32 sampleRate, U32 * achievedRatePtr);
+
+/**
+* \fn		U8 adcStartTimedScan(U8 adcPort, tADCMuxInput scanInput, U16 * resultPtr, void (*callback)(U8, U16*, U8, void*), void * contextPtr)
+* @brief	Continuously scan an input matrix, 1 input per Timer 3 period (use adcSetTimerTrigger() before)
+* @note		Each input is sampled at sampleRate/inputNb, the input n always at n/sampleRate after the first one
+*			The callback is called from adcISR() after each complete scan with the results (1 per input)
+*			resultPtr must have space for 1 result per enabled input
+*			Return STD_EC_INVALID if the timer trigger is not set, STD_EC_BUSY if the ADC is not idle
+* @arg		U8 adcPort				Hardware ADC ID
+* @arg		tADCMuxInput scanInput			Input matrix to scan
+* @arg		U16 * resultPtr				Destination of the results
+* @arg		void (*callback)(U8, U16*, U8, void*)	Scan done callback (port, resultPtr, result nb, context)
+* @arg		void * contextPtr			Context given to the callback
+* @return	U8 errorCode				STD Error Code (STD_EC_SUCCESS if successful)
+*/
+U8 adcStartTimedScan(U8 adcPort, tADCMuxInput scanInput, U16 * resultPtr, void (*callback)(U8, U16*, U8, void*), void * contextPtr);
+
+/**
+* \fn		U8 adcStopTimedScan(U8 adcPort)
+* @brief	Stop the continuous timed scan of the selected ADC
+* @note		Stop after the actual conversion, the timer trigger stay set
+* @arg		U8 adcPort				Hardware ADC ID
+* @return	U8 errorCode				STD Error Code (STD_EC_SUCCESS if successful)
+*/
+U8 adcStopTimedScan(U8 adcPort);
+// ========================== //
+
+// == Streaming Functions === //
+/**
+* \fn		U8 adcStartStream(U8 adcPort, U8 dmaChannel, U16 * bufferPtr, U16 sampleNb, void (*callback)(U8, U8, U16*, U16, void*), void * contextPtr)
+* @brief	Start a continuous capture of the actual input, moved by a DMA channel in a ping-pong buffer
+* @note		The ADC is set to interrupt on each conversion, its interrupt flag trigger the DMA (the CPU interrupt is disabled)
+*			The callback is called from dmaISR() with ADC_STREAM_HALF when the first half is filled
+*			and with ADC_STREAM_FULL when the second half is filled, the DMA then continue in the first half
+*			The half given to the callback must be processed before the DMA come back to it
+*			The sample rate and the input must be set before, the DMA channel must be allocated and its ISR call dmaISR()
+*			Use adcSetTimerTrigger() before for a jitter-free capture
+*			A window set on result 0 check every sample of a half before the callback get it
+*			A filter set on result 0 process the half in place, the callback then get the number of outputs
+*			Return STD_EC_INVALID if sampleNb is odd, null or bigger than the DMA can handle
+* @arg		U8 adcPort				Hardware ADC ID
+* @arg		U8 dmaChannel				DMA channel number
+* @arg		U16 * bufferPtr				Capture buffer
+* @arg		U16 sampleNb				Size of the capture buffer (in sample)
+* @arg		void (*callback)(U8, U8, U16*, U16, void*)	Half ready callback (port, event, half pointer, sample nb in the half, context)
+* @arg		void * contextPtr			Context given to the callback
+* @return	U8 errorCode				STD Error Code (STD_EC_SUCCESS if successful)
+*/
+U8 adcStartStream(U8 adcPort, U8 dmaChannel, U16 * bufferPtr, U16 sampleNb, void (*callback)(U8, U8, U16*, U16, void*), void * contextPtr);
+
+/**
+* \fn		U8 adcStopStream(U8 adcPort)
+* @brief	Stop the continuous capture of the selected ADC
+* @note		The DMA channel is disabled but stay allocated, the ADC interrupt is enabled again
+* @arg		U8 adcPort				Hardware ADC ID
+* @return	U8 errorCode				STD Error Code (STD_EC_SUCCESS if successful)
+*/
+U8 adcStopStream(U8 adcPort);
+// ========================== //
 // ############################################## //
 
 
 // ############### Internal Define ############## //
 #define	ADC_SAMC_MAX		31
 #define ADC_SAMP_RATE_MAX	1000000
-#define ADC_FIFO_LVL		16
 // ############################################## //
 
 #endif
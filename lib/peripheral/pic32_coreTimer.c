@@ -0,0 +1,345 @@
+/*!
+ @file		pic32_coreTimer.c
+ @brief		Core timer functions for pic32 (tickless high-resolution timers)
+
+ @version	0.1
+ @note		The core timer count at SYSCLK/2 (25ns at 80MHz)
+ 		The 32bit Count reg is extended to 64bit in software, coreTimerGetCount64() never wrap
+ 		Events are one-shot, sorted by deadline and Compare is programmed to the earliest one,
+ 		so no interrupt happen when nothing is due (except one every CORE_TMR_MAX_SLEEP tick to keep the extension)
+ 		All Function are Non-Blocking, the events are protected with critEnter()
+
+ @date		October 19th 2026
+ @author	Laurence DV
+*/
+
+// ################## Includes ################## //
+#include "pic32_coreTimer.h"
+// ############################################## //
+
+
+// ################## Variables ################# //
+U32 coreTimerFreq = 0;							//Core timer frequency (in Hz)
+U32 coreTimerHigh = 0;							//Upper part of the 64bit count
+U32 coreTimerLastCount = 0;						//Last Count read (to detect the wrap)
+tCoreTimerEvent * coreTimerHeadPtr = NULL;				//Earliest pending event
+// ############################################## //
+
+
+// ############## Internal Functions ############ //
+/**
+* \fn		U8 _coreTimerProgram(void)
+* @brief	Program Compare to the earliest deadline (or to CORE_TMR_MAX_SLEEP)
+* @note		Must be called in a critical section
+*		Return STD_EC_FAIL if the deadline is too close or was passed during the programming
+*		The flag is cleared right after Compare is written, a match after the Count check stay flagged
+* @arg		nothing
+* @return	U8 errorCode			STD Error Code (return STD_EC_SUCCESS if successful)
+*/
+U8 _coreTimerProgram(void)
+{
+	U64 nowTick = coreTimerGetCount64();
+	U64 targetTick = nowTick + CORE_TMR_MAX_SLEEP;
+
+	if ((coreTimerHeadPtr != NULL) && (coreTimerHeadPtr->deadline < targetTick))
+		targetTick = coreTimerHeadPtr->deadline;
+
+	// -- Too close to be caught by Compare -- //
+	if (targetTick < (nowTick + CORE_TMR_MIN_DELTA))
+		return STD_EC_FAIL;
+	// --------------------------------------- //
+
+	_CP0_SET_COMPARE((U32)targetTick);				//Also clear the core timer request
+	intFastClearFlag(CORE_TMR_INT_ID);				//Before the check, a later match must not be lost
+
+	// -- Check that the Count did not pass it -- //
+	if ((S32)((U32)targetTick - _CP0_GET_COUNT()) <= 0)
+		return STD_EC_FAIL;
+	// ------------------------------------------ //
+
+	return STD_EC_SUCCESS;
+}
+
+/**
+* \fn		void _coreTimerReschedule(void)
+* @brief	Update Compare after a change of the earliest event
+* @note		Must be called in a critical section outside the ISR
+*		If Compare cannot be programmed in time, the interrupt is forced
+* @arg		nothing
+* @return	nothing
+*/
+void _coreTimerReschedule(void)
+{
+	if (_coreTimerProgram() != STD_EC_SUCCESS)
+		intFastSetFlag(CORE_TMR_INT_ID);			//Let the ISR handle it now
+}
+
+/**
+* \fn		void _coreTimerUnlink(tCoreTimerEvent * eventPtr)
+* @brief	Remove an event from the pending list
+* @note		Must be called in a critical section
+* @arg		tCoreTimerEvent * eventPtr	Event to remove
+* @return	U8 wasFirst			1 if the event was the earliest
+*/
+U8 _coreTimerUnlink(tCoreTimerEvent * eventPtr)
+{
+	tCoreTimerEvent ** linkPtr = &coreTimerHeadPtr;
+
+	while (*linkPtr != NULL)
+	{
+		if (*linkPtr == eventPtr)
+		{
+			*linkPtr = eventPtr->next;
+			eventPtr->next = NULL;
+			eventPtr->pending = 0;
+			return (linkPtr == &coreTimerHeadPtr);
+		}
+		linkPtr = &((*linkPtr)->next);
+	}
+
+	return 0;
+}
+// ############################################## //
+
+
+// ############ Core Timer Functions ############ //
+// === Interrupt Handler ===== //
+/**
+* \fn		void coreTimerISR(void)
+* @brief	Interrupt Service Routine of the core timer, call every due event and program the next one
+* @note		Place it in the core timer vector at CORE_TMR_INT_PRIORITY
+* @arg		nothing
+* @return	nothing
+*/
+/*	Vector Example (the IPL must match CORE_TMR_INT_PRIORITY)
+ void __ISR(CORE_TMR_VECTOR, IPL6SOFT)coreTimerVectorISR(void)
+{
+	coreTimerISR();
+}*/
+
+void coreTimerISR(void)
+{
+	tCoreTimerEvent * eventPtr;
+	U32 critState = critEnter();
+
+	do
+	{
+		// -- Call every due event -- //
+		while ((coreTimerHeadPtr != NULL) && (coreTimerHeadPtr->deadline <= coreTimerGetCount64()))
+		{
+			eventPtr = coreTimerHeadPtr;
+			coreTimerHeadPtr = eventPtr->next;
+			eventPtr->next = NULL;
+			eventPtr->pending = 0;
+
+			critExit(critState);
+			eventPtr->callback(eventPtr, eventPtr->contextPtr);	//Can reschedule itself
+			critState = critEnter();
+		}
+		// -------------------------- //
+	}while (_coreTimerProgram() != STD_EC_SUCCESS);			//Retry if the next one is already due (the flag is cleared there)
+
+	critExit(critState);
+}
+// =========================== //
+
+
+// ==== Control Functions ==== //
+/**
+* \fn		U8 coreTimerInit(void)
+* @brief	Initialise the core timer scheduler and enable its interrupt
+* @note		The Count reg is not modified (it is free running)
+*		Call it again if SYSCLK is changed
+* @arg		nothing
+* @return	U8 errorCode			STD Error Code (return STD_EC_SUCCESS if successful)
+*/
+U8 coreTimerInit(void)
+{
+	U32 critState = critEnter();
+
+	coreTimerFreq = clockGetSYSCLK() >> 1;				//Core timer count at half the SYSCLK
+	coreTimerGetCount64();						//Synchronise the extension
+
+	// -- Init the interrupt -- //
+	intFastDisable(CORE_TMR_INT_ID);
+	intFastSetPriority(CORE_TMR_INT_ID, CORE_TMR_INT_PRIORITY);
+	intFastSetSubPriority(CORE_TMR_INT_ID, 0);
+	intFastClearFlag(CORE_TMR_INT_ID);
+	_coreTimerReschedule();						//Force the interrupt if an event is already due
+	intFastEnable(CORE_TMR_INT_ID);
+	// ------------------------ //
+
+	critExit(critState);
+
+	return STD_EC_SUCCESS;
+}
+
+/**
+* \fn		U64 coreTimerGetCount64(void)
+* @brief	Return the 64bit extended count of the core timer
+* @note		Can be called from any context at or below INT_CRIT_IPL
+* @arg		nothing
+* @return	U64 count			Number of core timer tick since the init
+*/
+U64 coreTimerGetCount64(void)
+{
+	U32 countTemp;
+	U64 count;
+	U32 critState = critEnter();
+
+	countTemp = _CP0_GET_COUNT();
+	if (countTemp < coreTimerLastCount)
+		coreTimerHigh++;					//Count has wrapped since the last read
+	coreTimerLastCount = countTemp;
+	count = (((U64)coreTimerHigh) << 32) | countTemp;
+
+	critExit(critState);
+
+	return count;
+}
+
+/**
+* \fn		U32 coreTimerGetFreq(void)
+* @brief	Return the frequency of the core timer
+* @note		SYSCLK/2 saved at init
+* @arg		nothing
+* @return	U32 freq			Core timer frequency (in Hz)
+*/
+U32 coreTimerGetFreq(void)
+{
+	return coreTimerFreq;
+}
+
+/**
+* \fn		U64 coreTimerUsToTick(U32 time)
+* @brief	Convert a time in us to core timer tick
+* @note		Integer only, rounded to the nearest tick
+* @arg		U32 time			Time to convert (in us)
+* @return	U64 tickNb			Number of core timer tick
+*/
+U64 coreTimerUsToTick(U32 time)
+{
+	return ((((U64)time) * coreTimerFreq) + 500000) / 1000000;
+}
+
+/**
+* \fn		U64 coreTimerNsToTick(U32 time)
+* @brief	Convert a time in ns to core timer tick
+* @note		Integer only, rounded to the nearest tick
+* @arg		U32 time			Time to convert (in ns)
+* @return	U64 tickNb			Number of core timer tick
+*/
+U64 coreTimerNsToTick(U32 time)
+{
+	return ((((U64)time) * coreTimerFreq) + 500000000) / 1000000000;
+}
+
+/**
+* \fn		U64 coreTimerTickToUs(U64 tickNb)
+* @brief	Convert a number of core timer tick to us
+* @note		Integer only, truncated
+* @arg		U64 tickNb			Number of core timer tick
+* @return	U64 time			Time (in us)
+*/
+U64 coreTimerTickToUs(U64 tickNb)
+{
+	if (coreTimerFreq == 0)
+		return 0;
+
+	return ((tickNb / coreTimerFreq) * 1000000) + (((tickNb % coreTimerFreq) * 1000000) / coreTimerFreq);
+}
+// =========================== //
+
+
+// ===== Event Functions ===== //
+/**
+* \fn		void coreTimerEventInit(tCoreTimerEvent * eventPtr, void (*callback)(tCoreTimerEvent*, void*), void * contextPtr)
+* @brief	Initialise an event and set its callback
+* @note		Must be done once before the first use of an event
+* @arg		tCoreTimerEvent * eventPtr	Event to initialise
+* @arg		void (*callback)(tCoreTimerEvent*, void*)	Function called at the expiration (in coreTimerISR())
+* @arg		void * contextPtr		Context given to the callback
+* @return	nothing
+*/
+void coreTimerEventInit(tCoreTimerEvent * eventPtr, void (*callback)(tCoreTimerEvent*, void*), void * contextPtr)
+{
+	eventPtr->next = NULL;
+	eventPtr->deadline = 0;
+	eventPtr->callback = callback;
+	eventPtr->contextPtr = contextPtr;
+	eventPtr->pending = 0;
+}
+
+/**
+* \fn		void coreTimerStartEvent(tCoreTimerEvent * eventPtr, U64 deadline)
+* @brief	Schedule an event at an absolute 64bit count
+* @note		A pending event is rescheduled, a deadline already passed expire as soon as possible
+*		Use eventPtr->deadline + period in the callback to reschedule without drift
+* @arg		tCoreTimerEvent * eventPtr	Event to schedule
+* @arg		U64 deadline			Count of the expiration (see coreTimerGetCount64())
+* @return	nothing
+*/
+void coreTimerStartEvent(tCoreTimerEvent * eventPtr, U64 deadline)
+{
+	tCoreTimerEvent ** linkPtr = &coreTimerHeadPtr;
+	U8 headChanged;
+	U32 critState = critEnter();
+
+	// -- Remove it if already pending -- //
+	headChanged = 0;
+	if (eventPtr->pending)
+		headChanged = _coreTimerUnlink(eventPtr);
+	// ---------------------------------- //
+
+	// -- Insert by deadline (after the equal ones) -- //
+	eventPtr->deadline = deadline;
+	while ((*linkPtr != NULL) && ((*linkPtr)->deadline <= deadline))
+		linkPtr = &((*linkPtr)->next);
+
+	eventPtr->next = *linkPtr;
+	*linkPtr = eventPtr;
+	eventPtr->pending = 1;
+	if (linkPtr == &coreTimerHeadPtr)
+		headChanged = 1;
+	// ----------------------------------------------- //
+
+	if (headChanged)
+		_coreTimerReschedule();
+
+	critExit(critState);
+}
+
+/**
+* \fn		void coreTimerStartEventIn(tCoreTimerEvent * eventPtr, U32 delay)
+* @brief	Schedule an event after a delay
+* @note		Use coreTimerUsToTick() or coreTimerNsToTick() to compute the delay
+* @arg		tCoreTimerEvent * eventPtr	Event to schedule
+* @arg		U32 delay			Delay before the expiration (in core timer tick)
+* @return	nothing
+*/
+void coreTimerStartEventIn(tCoreTimerEvent * eventPtr, U32 delay)
+{
+	coreTimerStartEvent(eventPtr, coreTimerGetCount64() + delay);
+}
+
+/**
+* \fn		void coreTimerCancelEvent(tCoreTimerEvent * eventPtr)
+* @brief	Remove a pending event
+* @note		Nothing is done if the event is not pending
+* @arg		tCoreTimerEvent * eventPtr	Event to cancel
+* @return	nothing
+*/
+void coreTimerCancelEvent(tCoreTimerEvent * eventPtr)
+{
+	U32 critState = critEnter();
+
+	if (eventPtr->pending)
+	{
+		if (_coreTimerUnlink(eventPtr))
+			_coreTimerReschedule();				//Do not wake up for nothing
+	}
+
+	critExit(critState);
+}
+// =========================== //
+// ############################################## //
@@ -0,0 +1,181 @@
+/*!
+ @file		pic32_coreTimer.h
+ @brief		Core timer functions for pic32 (tickless high-resolution timers)
+
+ @version	0.1
+ @note		The core timer count at SYSCLK/2 (25ns at 80MHz)
+ 		The 32bit Count reg is extended to 64bit in software, coreTimerGetCount64() never wrap
+ 		Events are one-shot, sorted by deadline and Compare is programmed to the earliest one,
+ 		so no interrupt happen when nothing is due (except one every CORE_TMR_MAX_SLEEP tick to keep the extension)
+ 		All Function are Non-Blocking, the events are protected with critEnter()
+
+ @date		October 19th 2026
+ @author	Laurence DV
+*/
+
+#ifndef _PIC32_CORETIMER_H
+#define _PIC32_CORETIMER_H 1
+// ################## Includes ################## //
+// Hardware
+#include <hardware.h>
+
+// Lib
+#include <peripheral/pic32_clock.h>
+#include <peripheral/pic32_interrupt.h>
+
+// Definition
+#include <definition/stddef_megaxone.h>
+#include <definition/datatype_megaxone.h>
+// ############################################## //
+
+
+// ################## Defines ################### //
+// Interrupt
+#define CORE_TMR_INT_ID				INT_CORE_TIMER
+#define CORE_TMR_VECTOR				INT_VEC_CORE_TIMER
+#ifndef CORE_TMR_INT_PRIORITY
+	#define CORE_TMR_INT_PRIORITY			INT_CRIT_IPL	//Must not be above INT_CRIT_IPL, the events are protected with critEnter()
+#endif
+
+#if CORE_TMR_INT_PRIORITY > INT_CRIT_IPL
+	#error "CORE_TMR_INT_PRIORITY must not be above INT_CRIT_IPL"
+#endif
+
+// Scheduler
+#ifndef CORE_TMR_MIN_DELTA
+	#define CORE_TMR_MIN_DELTA			40		//Closest Compare that can be programmed safely (in tick)
+#endif
+#define CORE_TMR_MAX_SLEEP			0x40000000	//Longest time without interrupt (in tick, keep the 64bit extension valid)
+// ############################################## //
+
+
+// ################# Data Type ################## //
+// Core timer event //
+typedef struct sCoreTimerEvent
+{
+	struct sCoreTimerEvent * next;				//Next event by deadline
+	U64 deadline;						//Count of the expiration (64bit)
+	void (*callback)(struct sCoreTimerEvent*, void*);	//Function called at the expiration (in coreTimerISR())
+	void * contextPtr;					//Context given to the callback
+	U8 pending;						//The event is waiting
+}tCoreTimerEvent;
+// ---------------- //
+// ############################################## //
+
+
+// ################# Prototypes ################# //
+// === Interrupt Handler ===== //
+/**
+* \fn		void coreTimerISR(void)
+* @brief	Interrupt Service Routine of the core timer, call every due event and program the next one
+* @note		Place it in the core timer vector at CORE_TMR_INT_PRIORITY
+* @arg		nothing
+* @return	nothing
+*/
+void coreTimerISR(void);
+// =========================== //
+
+
+// ==== Control Functions ==== //
+/**
+* \fn		U8 coreTimerInit(void)
+* @brief	Initialise the core timer scheduler and enable its interrupt
+* @note		The Count reg is not modified (it is free running)
+*		Call it again if SYSCLK is changed
+* @arg		nothing
+* @return	U8 errorCode			STD Error Code (return STD_EC_SUCCESS if successful)
+*/
+U8 coreTimerInit(void);
+
+/**
+* \fn		U64 coreTimerGetCount64(void)
+* @brief	Return the 64bit extended count of the core timer
+* @note		Can be called from any context at or below INT_CRIT_IPL
+* @arg		nothing
+* @return	U64 count			Number of core timer tick since the init
+*/
+U64 coreTimerGetCount64(void);
+
+/**
+* \fn		U32 coreTimerGetFreq(void)
+* @brief	Return the frequency of the core timer
+* @note		SYSCLK/2 saved at init
+* @arg		nothing
+* @return	U32 freq			Core timer frequency (in Hz)
+*/
+U32 coreTimerGetFreq(void);
+
+/**
+* \fn		U64 coreTimerUsToTick(U32 time)
+* @brief	Convert a time in us to core timer tick
+* @note		Integer only, rounded to the nearest tick
+* @arg		U32 time			Time to convert (in us)
+* @return	U64 tickNb			Number of core timer tick
+*/
+U64 coreTimerUsToTick(U32 time);
+
+/**
+* \fn		U64 coreTimerNsToTick(U32 time)
+* @brief	Convert a time in ns to core timer tick
+* @note		Integer only, rounded to the nearest tick
+* @arg		U32 time			Time to convert (in ns)
+* @return	U64 tickNb			Number of core timer tick
+*/
+U64 coreTimerNsToTick(U32 time);
+
+/**
+* \fn		U64 coreTimerTickToUs(U64 tickNb)
+* @brief	Convert a number of core timer tick to us
+* @note		Integer only, truncated
+* @arg		U64 tickNb			Number of core timer tick
+* @return	U64 time			Time (in us)
+*/
+U64 coreTimerTickToUs(U64 tickNb);
+// =========================== //
+
+
+// ===== Event Functions ===== //
+/**
+* \fn		void coreTimerEventInit(tCoreTimerEvent * eventPtr, void (*callback)(tCoreTimerEvent*, void*), void * contextPtr)
+* @brief	Initialise an event and set its callback
+* @note		Must be done once before the first use of an event
+* @arg		tCoreTimerEvent * eventPtr	Event to initialise
+* @arg		void (*callback)(tCoreTimerEvent*, void*)	Function called at the expiration (in coreTimerISR())
+* @arg		void * contextPtr		Context given to the callback
+* @return	nothing
+*/
+void coreTimerEventInit(tCoreTimerEvent * eventPtr, void (*callback)(tCoreTimerEvent*, void*), void * contextPtr);
+
+/**
+* \fn		void coreTimerStartEvent(tCoreTimerEvent * eventPtr, U64 deadline)
+* @brief	Schedule an event at an absolute 64bit count
+* @note		A pending event is rescheduled, a deadline already passed expire as soon as possible
+*		Use eventPtr->deadline + period in the callback to reschedule without drift
+* @arg		tCoreTimerEvent * eventPtr	Event to schedule
+* @arg		U64 deadline			Count of the expiration (see coreTimerGetCount64())
+* @return	nothing
+*/
+void coreTimerStartEvent(tCoreTimerEvent * eventPtr, U64 deadline);
+
+/**
+* \fn		void coreTimerStartEventIn(tCoreTimerEvent * eventPtr, U32 delay)
+* @brief	Schedule an event after a delay
+* @note		Use coreTimerUsToTick() or coreTimerNsToTick() to compute the delay
+* @arg		tCoreTimerEvent * eventPtr	Event to schedule
+* @arg		U32 delay			Delay before the expiration (in core timer tick)
+* @return	nothing
+*/
+void coreTimerStartEventIn(tCoreTimerEvent * eventPtr, U32 delay);
+
+/**
+* \fn		void coreTimerCancelEvent(tCoreTimerEvent * eventPtr)
+* @brief	Remove a pending event
+* @note		Nothing is done if the event is not pending
+* @arg		tCoreTimerEvent * eventPtr	Event to cancel
+* @return	nothing
+*/
+void coreTimerCancelEvent(tCoreTimerEvent * eventPtr);
+// =========================== //
+// ############################################## //
+
+#endif
@@ -2,8 +2,9 @@
  @file		pic32_dma.c
  @brief		DMA Control lib for pic32
 
- @version	0.1
- @note		DMA control use the physical Address not the virtual one!
+ @version	0.2
+ @note		DMA control use the physical Address not the virtual one! (pointers are translated by the lib)
+ 		Channels must be allocated before use, completion callbacks are dispatched from dmaISR()
  @todo		
 
  @date		February 16th 2012
@@ -16,38 +17,628 @@
 
 
 // ################## Variables ################# //
-tDCHxCON * pDCHxCON = NULL;
-tDCHxECON * pDCHxECON = NULL;
-tDCHxINT * pDCHxINT = NULL;
-U32 * pDCHxSSA = NULL;
-U32 * pDCHxDSA = NULL;
-tDCHxSSIZ * pDCHxSSIZ = NULL;
-tDCHxDSIZ * pDCHxDSIZ = NULL;
-tDCHxSPTR * pDCHxSPTR = NULL;
-tDCHxDPTR * pDCHxDPTR = NULL;
-tDCHxCSIZ * pDCHxCSIZ = NULL;
-tDCHxCPTR * pDCHxCPTR = NULL;
-tDCHxDAT * pDCHxDAT = NULL;
+tDMAChannelCtl dmaChannelCtl[DMA_CHANNEL_NB];			//Callback of each channel
+U32 dmaChannelUsed = 0;						//Allocated channel mask (1 bit per channel)
+
+// Memory offload
+poolDeclareStorage(dmaMemStorage, tDMAMemRequest, DMA_MEM_REQUEST_POOL_SIZE);
+tPoolCtl dmaMemPool;
+tDMAMemRequest * dmaMemHead[DMA_CHANNEL_NB];			//Request in progress on each channel
+tDMAMemRequest * dmaMemTail[DMA_CHANNEL_NB];			//Last queued request on each channel
+// ############################################## //
+
+
+// ############## Internal Functions ############ //
+/**
+* \fn		U8 dmaSetupTransfer(U8 channel, U32 option, U8 startIRQ, U8 abortIRQ, U32 econ, void * sourcePtr, U32 sourceSize, void * destinationPtr, U32 destinationSize, U32 cellSize)
+* @brief	Common part of the transfer setup
+* @note		econ contain the pattern and pattern enable bit (if used)
+* @arg		U8 channel				DMA channel number
+* @arg		U32 option				Channel option
+* @arg		U8 startIRQ				IRQ starting a cell transfer (IRQ_x or DMA_IRQ_NONE)
+* @arg		U8 abortIRQ				IRQ aborting the transfer (IRQ_x or DMA_IRQ_NONE)
+* @arg		U32 econ				Initial DCHxECON value
+* @arg		void * sourcePtr			Source start address
+* @arg		U32 sourceSize				Source size (in byte)
+* @arg		void * destinationPtr			Destination start address
+* @arg		U32 destinationSize			Destination size (in byte)
+* @arg		U32 cellSize				Byte transfered on each start event
+* @return	U8 errorCode				STD Error Code (return STD_EC_SUCCESS if successful)
+*/
+U8 dmaSetupTransfer(U8 channel, U32 option, U8 startIRQ, U8 abortIRQ, U32 econ, void * sourcePtr, U32 sourceSize, void * destinationPtr, U32 destinationSize, U32 cellSize)
+{
+	tDMAChannelReg * channelReg;
+
+	// -- Handle invalid parameters -- //
+	if (channel >= DMA_CHANNEL_NB)
+		return STD_EC_NOTFOUND;
+	if ((sourceSize == 0) || (sourceSize > DMA_MAX_SIZE) || (destinationSize == 0) || (destinationSize > DMA_MAX_SIZE))
+		return STD_EC_INVALID;
+	if ((cellSize == 0) || (cellSize > DMA_MAX_SIZE))
+		return STD_EC_INVALID;
+	if (((startIRQ != DMA_IRQ_NONE) && (startIRQ & BIT7)) || ((abortIRQ != DMA_IRQ_NONE) && (abortIRQ & BIT7)))
+		return STD_EC_INVALID;					//Group IRQ cannot trigger the DMA
+	// ------------------------------- //
+
+	channelReg = DMA_CHANNEL_REG(channel);
+
+	// -- Stop the channel -- //
+	channelReg->DCHxCONCLR = DMA_MASK_CHEN;
+	while (channelReg->DCHxCON.CHBUSY);
+	// ---------------------- //
+
+	// -- Set the triggers -- //
+	if (startIRQ != DMA_IRQ_NONE)
+		econ |= (((U32)startIRQ) << 8) | DMA_MASK_SIRQEN;
+	if (abortIRQ != DMA_IRQ_NONE)
+		econ |= (((U32)abortIRQ) << 16) | DMA_MASK_AIRQEN;
+	channelReg->DCHxECON.all = econ;
+	// ---------------------- //
+
+	// -- Set the transfer -- //
+	channelReg->DCHxCON.all = option & DMA_OPTION_MASK;
+	channelReg->DCHxSSA = DMA_PHY_ADDRESS(sourcePtr);
+	channelReg->DCHxDSA = DMA_PHY_ADDRESS(destinationPtr);
+	channelReg->DCHxSSIZ.all = sourceSize & 0xFFFF;		//DMA_MAX_SIZE is written as 0
+	channelReg->DCHxDSIZ.all = destinationSize & 0xFFFF;
+	channelReg->DCHxCSIZ.all = cellSize & 0xFFFF;
+	// ---------------------- //
+
+	// Clear old flags
+	channelReg->DCHxINTCLR = 0xFF;
+
+	return STD_EC_SUCCESS;
+}
+
+/**
+* \fn		void dmaMemStartChunk(U8 channel, tDMAMemRequest * requestPtr)
+* @brief	Start the transfer of the next chunk of a memory request
+* @note		A chunk is at most DMA_MAX_SIZE byte and is moved in a single cell (forced start)
+*			For a memset, the source is the 1 byte value of the request, repeated by the DMA
+* @arg		U8 channel				DMA channel number
+* @arg		tDMAMemRequest * requestPtr		Request to continue
+* @return	nothing
+*/
+void dmaMemStartChunk(U8 channel, tDMAMemRequest * requestPtr)
+{
+	U32 chunkSize = requestPtr->remainingSize;
+
+	if (chunkSize > DMA_MAX_SIZE)
+		chunkSize = DMA_MAX_SIZE;
+
+	if (requestPtr->sourcePtr != NULL)
+		dmaSetupTransfer(channel, DMA_MEM_PRIORITY, DMA_IRQ_NONE, DMA_IRQ_NONE, 0, (void*)requestPtr->sourcePtr, chunkSize, requestPtr->destinationPtr, chunkSize, chunkSize);
+	else
+		dmaSetupTransfer(channel, DMA_MEM_PRIORITY, DMA_IRQ_NONE, DMA_IRQ_NONE, 0, &requestPtr->value, 1, requestPtr->destinationPtr, chunkSize, chunkSize);
+
+	dmaEnable(channel);
+	dmaForceStart(channel);
+}
+
+/**
+* \fn		void dmaMemHandler(U8 channel, U32 flags, void * contextPtr)
+* @brief	Channel callback of the memory offload, advance the request in progress
+* @note		Called from dmaISR(), start the next chunk or the next request of the channel
+*			The request callback is called from the DMA ISR
+* @arg		U8 channel				DMA channel number
+* @arg		U32 flags				Channel interrupt flags
+* @arg		void * contextPtr			Unused
+* @return	nothing
+*/
+void dmaMemHandler(U8 channel, U32 flags, void * contextPtr)
+{
+	tDMAMemRequest * requestPtr = dmaMemHead[channel];
+	U32 chunkSize;
+	U8 errorCode = STD_EC_SUCCESS;
+
+	if (requestPtr == NULL)
+		return;
+
+	// -- Advance the request -- //
+	if (flags & DMA_INT_ADDRESS_ERR)
+		errorCode = STD_EC_FAIL;					//Stop the request on an address error
+	else
+	{
+		chunkSize = requestPtr->remainingSize;
+		if (chunkSize > DMA_MAX_SIZE)
+			chunkSize = DMA_MAX_SIZE;
+
+		requestPtr->remainingSize -= chunkSize;
+		requestPtr->destinationPtr += chunkSize;
+		if (requestPtr->sourcePtr != NULL)
+			requestPtr->sourcePtr += chunkSize;
+
+		if (requestPtr->remainingSize)
+		{
+			dmaMemStartChunk(channel, requestPtr);
+			return;
+		}
+	}
+	// ------------------------- //
+
+	// -- Complete the request -- //
+	dmaDisable(channel);
+	dmaMemHead[channel] = requestPtr->next;
+	if (dmaMemHead[channel] == NULL)
+		dmaMemTail[channel] = NULL;
+	else
+		dmaMemStartChunk(channel, dmaMemHead[channel]);
+
+	if (requestPtr->callback != NULL)
+		requestPtr->callback(errorCode, requestPtr->contextPtr);
+	poolFree(&dmaMemPool, requestPtr);
+	// -------------------------- //
+}
+
+/**
+* \fn		U8 dmaMemQueue(U8 channel, void * destinationPtr, const void * sourcePtr, U8 value, U32 size, void (*callback)(U8, void*), void * contextPtr)
+* @brief	Queue a memory request on a channel, or do it with the CPU if it is small and the channel is idle
+* @note		sourcePtr is NULL for a memset
+* @arg		U8 channel				DMA channel number
+* @arg		void * destinationPtr			Destination start address
+* @arg		const void * sourcePtr			Source start address (NULL for a memset)
+* @arg		U8 value				Memset value
+* @arg		U32 size				Size to transfer (in byte)
+* @arg		void (*callback)(U8, void*)		Completion callback
+* @arg		void * contextPtr			Context given to the callback
+* @return	U8 errorCode				STD Error Code (return STD_EC_SUCCESS if successful)
+*/
+U8 dmaMemQueue(U8 channel, void * destinationPtr, const void * sourcePtr, U8 value, U32 size, void (*callback)(U8, void*), void * contextPtr)
+{
+	tDMAMemRequest * requestPtr;
+	U32 intState;
+
+	// -- Handle invalid parameters -- //
+	if ((channel >= DMA_CHANNEL_NB) || ((dmaChannelUsed & (1 << channel)) == 0))
+		return STD_EC_NOTFOUND;
+	if ((destinationPtr == NULL) || (size == 0))
+		return STD_EC_INVALID;
+	// ------------------------------- //
+
+	// -- Small request on an idle channel: use the CPU -- //
+	if ((size < DMA_MEM_CPU_THRESHOLD) && (dmaMemHead[channel] == NULL))
+	{
+		if (sourcePtr != NULL)
+			memcpy(destinationPtr, sourcePtr, size);
+		else
+			memset(destinationPtr, value, size);
+
+		if (callback != NULL)
+			callback(STD_EC_SUCCESS, contextPtr);
+		return STD_EC_SUCCESS;
+	}
+	// --------------------------------------------------- //
+
+	// -- Create the request -- //
+	requestPtr = poolAlloc(&dmaMemPool);
+	if (requestPtr == NULL)
+		return STD_EC_MEMORY;
+
+	requestPtr->next = NULL;
+	requestPtr->destinationPtr = destinationPtr;
+	requestPtr->sourcePtr = sourcePtr;
+	requestPtr->remainingSize = size;
+	requestPtr->value = value;
+	requestPtr->callback = callback;
+	requestPtr->contextPtr = contextPtr;
+	// ------------------------ //
+
+	// Disable Global Interrupt
+	intState = intFastDisableGlobal();
+
+	// -- Append to the channel queue -- //
+	if (dmaMemHead[channel] == NULL)
+	{
+		dmaMemHead[channel] = requestPtr;
+		dmaMemTail[channel] = requestPtr;
+		dmaSetCallback(channel, &dmaMemHandler, NULL, DMA_INT_BLOCK_DONE|DMA_INT_ADDRESS_ERR);
+		dmaMemStartChunk(channel, requestPtr);
+	}
+	else
+	{
+		dmaMemTail[channel]->next = requestPtr;
+		dmaMemTail[channel] = requestPtr;
+	}
+	// --------------------------------- //
+
+	// Restore Interrupt state
+	intFastRestoreGlobal(intState);
+
+	return STD_EC_SUCCESS;
+}
 // ############################################## //
 
 
 // ################ DMA Functions ############### //
+// === Interrupt Handler ===== //
+/**
+* \fn		void dmaISR(U8 channel)
+* @brief	DMA channel interrupt handler, clear the flags and dispatch them to the channel callback
+* @note		This function must be placed in the ISR of the corresponding DMA channel
+*			Only the flags enabled with dmaSetCallback() are reported
+* @arg		U8 channel				DMA channel number
+* @return	nothing
+*/
+void dmaISR(U8 channel)
+{
+	tDMAChannelReg * channelReg = DMA_CHANNEL_REG(channel);
+	U32 flags;
+
+	// -- Get and clear the enabled flags -- //
+	flags = channelReg->DCHxINT.all;
+	flags &= (flags >> 16);
+	flags &= 0xFF;
+	channelReg->DCHxINTCLR = flags;
+	CONCAT3(IFS,_REG_INT_DMA_0,CLR) = DMA_INT_MASK(channel);
+	// ------------------------------------- //
+
+	// -- Dispatch -- //
+	if ((flags) && (dmaChannelCtl[channel].callback != NULL))
+		dmaChannelCtl[channel].callback(channel, flags, dmaChannelCtl[channel].contextPtr);
+	// -------------- //
+}
+// =========================== //
+
+
+// === Control Functions ===== //
+/**
+* \fn		void dmaInit(void)
+* @brief	Start the DMA module and release every channel
+* @note		Must be called before any other DMA function
+* @arg		nothing
+* @return	nothing
+*/
+void dmaInit(void)
+{
+	U8 wu0;
+
+	// -- Reset every channel -- //
+	for (wu0 = 0; wu0 < DMA_CHANNEL_NB; wu0++)
+	{
+		DMA_CHANNEL_REG(wu0)->DCHxCONCLR = DMA_MASK_CHEN;
+		DMA_CHANNEL_REG(wu0)->DCHxINT.all = 0;
+		dmaChannelCtl[wu0].callback = NULL;
+		dmaChannelCtl[wu0].contextPtr = NULL;
+		CONCAT3(IEC,_REG_INT_DMA_0,CLR) = DMA_INT_MASK(wu0);
+		CONCAT3(IFS,_REG_INT_DMA_0,CLR) = DMA_INT_MASK(wu0);
+		dmaMemHead[wu0] = NULL;
+		dmaMemTail[wu0] = NULL;
+	}
+	dmaChannelUsed = 0;
+	poolInit(&dmaMemPool, dmaMemStorage, sizeof(tDMAMemRequest), DMA_MEM_REQUEST_POOL_SIZE);
+	// ------------------------- //
+
+	// Start the module
+	DMACONSET = DMA_MASK_ON;
+}
+
+/**
+* \fn		U8 dmaAllocChannel(void)
+* @brief	Allocate the first free DMA channel
+* @note		Return DMA_NO_CHANNEL if every channel is used
+*			Channel 0 has the highest natural priority
+* @arg		nothing
+* @return	U8 channel				Allocated DMA channel number
+*/
+U8 dmaAllocChannel(void)
+{
+	U8 channel;
+	U32 freeMask;
+	U32 intState;
+
+	// Disable Global Interrupt
+	intState = intFastDisableGlobal();
+
+	// -- Take the lowest free channel -- //
+	freeMask = (~dmaChannelUsed) & ((1 << DMA_CHANNEL_NB) - 1);
+	if (freeMask)
+	{
+		channel = __builtin_ctz(freeMask);
+		dmaChannelUsed |= (1 << channel);
+	}
+	else
+		channel = DMA_NO_CHANNEL;
+	// ---------------------------------- //
+
+	// Restore Interrupt state
+	intFastRestoreGlobal(intState);
+
+	return channel;
+}
+
+/**
+* \fn		U8 dmaReserveChannel(U8 channel)
+* @brief	Allocate a specific DMA channel
+* @note		Usefull for chaining, which need neighbour channels
+*			Return STD_EC_BUSY if the channel is already allocated, STD_EC_NOTFOUND if it does not exist
+* @arg		U8 channel				DMA channel number
+* @return	U8 errorCode				STD Error Code (return STD_EC_SUCCESS if successful)
+*/
+U8 dmaReserveChannel(U8 channel)
+{
+	U8 errorCode = STD_EC_SUCCESS;
+	U32 intState;
+
+	if (channel >= DMA_CHANNEL_NB)
+		return STD_EC_NOTFOUND;
+
+	// Disable Global Interrupt
+	intState = intFastDisableGlobal();
+
+	if (dmaChannelUsed & (1 << channel))
+		errorCode = STD_EC_BUSY;
+	else
+		dmaChannelUsed |= (1 << channel);
 
-// Channel Init
+	// Restore Interrupt state
+	intFastRestoreGlobal(intState);
 
-// setup normal transfert
-U8 dmaSetupNormalTransfer(U32 option, U8 eventSource, U32 * sourcePtr, U32 * destinationPtr)
+	return errorCode;
+}
+
+/**
+* \fn		U8 dmaReleaseChannel(U8 channel)
+* @brief	Abort any transfer on a channel, disable it and give it back to the free channels
+* @note		Return STD_EC_NOTFOUND if the channel does not exist
+*			Queued memory requests (dmaMemcpyAsync()/dmaMemsetAsync()) are dropped,
+*			their callback receive STD_EC_SHUTDOWN
+* @arg		U8 channel				DMA channel number
+* @return	U8 errorCode				STD Error Code (return STD_EC_SUCCESS if successful)
+*/
+U8 dmaReleaseChannel(U8 channel)
 {
+	tDMAMemRequest * requestPtr;
+	tDMAMemRequest * nextPtr;
+	U32 intState;
+
+	if (channel >= DMA_CHANNEL_NB)
+		return STD_EC_NOTFOUND;
+
+	// -- Stop the channel -- //
+	dmaAbort(channel);
+	DMA_CHANNEL_REG(channel)->DCHxINT.all = 0;
+	CONCAT3(IEC,_REG_INT_DMA_0,CLR) = DMA_INT_MASK(channel);
+	CONCAT3(IFS,_REG_INT_DMA_0,CLR) = DMA_INT_MASK(channel);
+	// ---------------------- //
+
+	// Disable Global Interrupt
+	intState = intFastDisableGlobal();
+
+	dmaChannelCtl[channel].callback = NULL;
+	dmaChannelCtl[channel].contextPtr = NULL;
+	dmaChannelUsed &= ~(1 << channel);
+
+	//Detach the memory request queue
+	requestPtr = dmaMemHead[channel];
+	dmaMemHead[channel] = NULL;
+	dmaMemTail[channel] = NULL;
+
+	// Restore Interrupt state
+	intFastRestoreGlobal(intState);
+
+	// -- Drop the queued memory requests -- //
+	while (requestPtr != NULL)
+	{
+		nextPtr = requestPtr->next;
+		if (requestPtr->callback != NULL)
+			requestPtr->callback(STD_EC_SHUTDOWN, requestPtr->contextPtr);
+		poolFree(&dmaMemPool, requestPtr);
+		requestPtr = nextPtr;
+	}
+	// ------------------------------------- //
 
 	return STD_EC_SUCCESS;
 }
 
-// setup pattern match transfert
-U8 dmaSetupPatternTransfer(U32 option, U8 eventSource, U8 pattern, U32 *sourcePtr, U32 * destinationPtr)
+/**
+* \fn		U8 dmaSetCallback(U8 channel, void (*callback)(U8, U32, void*), void * contextPtr, U32 intMask)
+* @brief	Set the function called from dmaISR() and the channel events that trigger it
+* @note		intMask is a combination of DMA_INT_x (ex: DMA_INT_BLOCK_DONE|DMA_INT_ABORT)
+*			The channel interrupt is enabled if intMask is not 0, its priority must be set in the main
+*			Return STD_EC_NOTFOUND if the channel does not exist
+* @arg		U8 channel				DMA channel number
+* @arg		void (*callback)(U8, U32, void*)	Function receiving the channel, the flags and the context
+* @arg		void * contextPtr			Context given to the callback
+* @arg		U32 intMask				Channel events to report
+* @return	U8 errorCode				STD Error Code (return STD_EC_SUCCESS if successful)
+*/
+U8 dmaSetCallback(U8 channel, void (*callback)(U8, U32, void*), void * contextPtr, U32 intMask)
 {
+	tDMAChannelReg * channelReg;
+
+	if (channel >= DMA_CHANNEL_NB)
+		return STD_EC_NOTFOUND;
+
+	channelReg = DMA_CHANNEL_REG(channel);
+
+	// -- Mask the channel while changing the callback -- //
+	CONCAT3(IEC,_REG_INT_DMA_0,CLR) = DMA_INT_MASK(channel);
+
+	dmaChannelCtl[channel].callback = callback;
+	dmaChannelCtl[channel].contextPtr = contextPtr;
+	channelReg->DCHxINT.all = (intMask & 0xFF) << 16;	//Set the enables, clear the flags
+	CONCAT3(IFS,_REG_INT_DMA_0,CLR) = DMA_INT_MASK(channel);
+
+	if (intMask & 0xFF)
+		CONCAT3(IEC,_REG_INT_DMA_0,SET) = DMA_INT_MASK(channel);
+	// -------------------------------------------------- //
 
 	return STD_EC_SUCCESS;
 }
+// =========================== //
 
-// ############################################## //
 
+// === Transfer Functions ==== //
+/**
+* \fn		U8 dmaSetupNormalTransfer(U8 channel, U32 option, U8 startIRQ, U8 abortIRQ, void * sourcePtr, U32 sourceSize, void * destinationPtr, U32 destinationSize, U32 cellSize)
+* @brief	Configure a channel for a block transfer, a cell is transfered on each start IRQ
+* @note		Option are the Channel Option (ex: DMA_PRIORITY_3|DMA_AUTO_ENABLE_ON)
+*			Use DMA_IRQ_NONE for no start IRQ (use dmaForceStart()) or no abort IRQ
+*			Sizes are in byte, from 1 to DMA_MAX_SIZE, pointers are virtual address
+*			The channel is left disabled, use dmaEnable()
+*			Return STD_EC_NOTFOUND for an invalid channel, STD_EC_INVALID for an invalid size or IRQ
+* @arg		U8 channel				DMA channel number
+* @arg		U32 option				Channel option
+* @arg		U8 startIRQ				IRQ starting a cell transfer (IRQ_x or DMA_IRQ_NONE)
+* @arg		U8 abortIRQ				IRQ aborting the transfer (IRQ_x or DMA_IRQ_NONE)
+* @arg		void * sourcePtr			Source start address
+* @arg		U32 sourceSize				Source size (in byte)
+* @arg		void * destinationPtr			Destination start address
+* @arg		U32 destinationSize			Destination size (in byte)
+* @arg		U32 cellSize				Byte transfered on each start event
+* @return	U8 errorCode				STD Error Code (return STD_EC_SUCCESS if successful)
+*/
+U8 dmaSetupNormalTransfer(U8 channel, U32 option, U8 startIRQ, U8 abortIRQ, void * sourcePtr, U32 sourceSize, void * destinationPtr, U32 destinationSize, U32 cellSize)
+{
+	return dmaSetupTransfer(channel, option, startIRQ, abortIRQ, 0, sourcePtr, sourceSize, destinationPtr, destinationSize, cellSize);
+}
+
+/**
+* \fn		U8 dmaSetupPatternTransfer(U8 channel, U32 option, U8 startIRQ, U8 pattern, void * sourcePtr, U32 sourceSize, void * destinationPtr, U32 destinationSize, U32 cellSize)
+* @brief	Configure a channel for a block transfer that is aborted when a pattern byte is transfered
+* @note		Same as dmaSetupNormalTransfer() but the abort IRQ is replaced by the pattern match (ex: '\r' for a text line)
+*			The abort is reported with DMA_INT_ABORT
+* @arg		U8 channel				DMA channel number
+* @arg		U32 option				Channel option
+* @arg		U8 startIRQ				IRQ starting a cell transfer (IRQ_x or DMA_IRQ_NONE)
+* @arg		U8 pattern				Byte ending the transfer
+* @arg		void * sourcePtr			Source start address
+* @arg		U32 sourceSize				Source size (in byte)
+* @arg		void * destinationPtr			Destination start address
+* @arg		U32 destinationSize			Destination size (in byte)
+* @arg		U32 cellSize				Byte transfered on each start event
+* @return	U8 errorCode				STD Error Code (return STD_EC_SUCCESS if successful)
+*/
+U8 dmaSetupPatternTransfer(U8 channel, U32 option, U8 startIRQ, U8 pattern, void * sourcePtr, U32 sourceSize, void * destinationPtr, U32 destinationSize, U32 cellSize)
+{
+	U8 errorCode;
+
+	errorCode = dmaSetupTransfer(channel, option, startIRQ, DMA_IRQ_NONE, DMA_MASK_PATEN, sourcePtr, sourceSize, destinationPtr, destinationSize, cellSize);
+	if (errorCode == STD_EC_SUCCESS)
+		DMA_CHANNEL_REG(channel)->DCHxDAT.all = pattern;
+
+	return errorCode;
+}
+
+/**
+* \fn		void dmaEnable(U8 channel)
+* @brief	Enable a channel, it will transfer on each start event
+* @note
+* @arg		U8 channel				DMA channel number
+* @return	nothing
+*/
+void dmaEnable(U8 channel)
+{
+	DMA_CHANNEL_REG(channel)->DCHxCONSET = DMA_MASK_CHEN;
+}
+
+/**
+* \fn		void dmaDisable(U8 channel)
+* @brief	Disable a channel, the transfer is suspended (the pointers are kept)
+* @note
+* @arg		U8 channel				DMA channel number
+* @return	nothing
+*/
+void dmaDisable(U8 channel)
+{
+	DMA_CHANNEL_REG(channel)->DCHxCONCLR = DMA_MASK_CHEN;
+}
+
+/**
+* \fn		void dmaForceStart(U8 channel)
+* @brief	Start a cell transfer now, as if the start IRQ occured
+* @note		The channel must be enabled
+* @arg		U8 channel				DMA channel number
+* @return	nothing
+*/
+void dmaForceStart(U8 channel)
+{
+	DMA_CHANNEL_REG(channel)->DCHxECONSET = DMA_MASK_CFORCE;
+}
+
+/**
+* \fn		void dmaAbort(U8 channel)
+* @brief	Abort the transfer of a channel and reset its pointers
+* @note		The channel is disabled
+* @arg		U8 channel				DMA channel number
+* @return	nothing
+*/
+void dmaAbort(U8 channel)
+{
+	tDMAChannelReg * channelReg = DMA_CHANNEL_REG(channel);
+
+	channelReg->DCHxECONSET = DMA_MASK_CABORT;
+	while (channelReg->DCHxECON.CABORT);			//Wait for the abort to complete
+	channelReg->DCHxCONCLR = DMA_MASK_CHEN;
+}
+
+/**
+* \fn		U8 dmaIsBusy(U8 channel)
+* @brief	Return the activity state of a channel
+* @note		A channel stay busy between its enabling and the end of the block (or its abortion)
+* @arg		U8 channel				DMA channel number
+* @return	U8 busy					1: Channel is active | 0: Channel is idle
+*/
+U8 dmaIsBusy(U8 channel)
+{
+	return DMA_CHANNEL_REG(channel)->DCHxCON.CHBUSY;
+}
+// =========================== //
+
+
+// === Memory Functions ====== //
+/**
+* \fn		U8 dmaMemcpyAsync(U8 channel, void * destinationPtr, const void * sourcePtr, U32 size, void (*callback)(U8, void*), void * contextPtr)
+* @brief	Copy a memory block with a DMA channel, without blocking the CPU
+* @note		The channel must be allocated and its interrupt priority set, dmaISR() must be in its ISR
+*			Requests on the same channel are done in order, a block bigger than DMA_MAX_SIZE is split in chunks
+*			Below DMA_MEM_CPU_THRESHOLD byte (and if the channel is idle) the copy is done by the CPU,
+*			the callback is then called before returning
+*			Callback receive STD_EC_SUCCESS, or STD_EC_FAIL on a DMA address error, and the context
+*			Return STD_EC_MEMORY if the request pool is empty
+* @arg		U8 channel				DMA channel number
+* @arg		void * destinationPtr			Destination start address
+* @arg		const void * sourcePtr			Source start address (RAM or Flash)
+* @arg		U32 size				Size to copy (in byte)
+* @arg		void (*callback)(U8, void*)		Completion callback (NULL if unused)
+* @arg		void * contextPtr			Context given to the callback
+* @return	U8 errorCode				STD Error Code (return STD_EC_SUCCESS if successful)
+*/
+U8 dmaMemcpyAsync(U8 channel, void * destinationPtr, const void * sourcePtr, U32 size, void (*callback)(U8, void*), void * contextPtr)
+{
+	if (sourcePtr == NULL)
+		return STD_EC_INVALID;
+
+	return dmaMemQueue(channel, destinationPtr, sourcePtr, 0, size, callback, contextPtr);
+}
+
+/**
+* \fn		U8 dmaMemsetAsync(U8 channel, void * destinationPtr, U8 value, U32 size, void (*callback)(U8, void*), void * contextPtr)
+* @brief	Fill a memory block with a DMA channel, without blocking the CPU
+* @note		Same behavior as dmaMemcpyAsync()
+* @arg		U8 channel				DMA channel number
+* @arg		void * destinationPtr			Destination start address
+* @arg		U8 value				Value to write in each byte
+* @arg		U32 size				Size to fill (in byte)
+* @arg		void (*callback)(U8, void*)		Completion callback (NULL if unused)
+* @arg		void * contextPtr			Context given to the callback
+* @return	U8 errorCode				STD Error Code (return STD_EC_SUCCESS if successful)
+*/
+U8 dmaMemsetAsync(U8 channel, void * destinationPtr, U8 value, U32 size, void (*callback)(U8, void*), void * contextPtr)
+{
+	return dmaMemQueue(channel, destinationPtr, NULL, value, size, callback, contextPtr);
+}
+
+/**
+* \fn		U8 dmaMemIsBusy(U8 channel)
+* @brief	Return if a memory request is in progress or queued on a channel
+* @note
+* @arg		U8 channel				DMA channel number
+* @return	U8 busy					1: Request pending | 0: Channel queue is empty
+*/
+U8 dmaMemIsBusy(U8 channel)
+{
+	return (dmaMemHead[channel] != NULL);
+}
+// =========================== //
+// ############################################## //
@@ -2,8 +2,9 @@
  @file		pic32_dma.h
  @brief		DMA Control lib for pic32
 
- @version	0.1
- @note		DMA control use the physical Address not the virtual one!
+ @version	0.2
+ @note		DMA control use the physical Address not the virtual one! (pointers are translated by the lib)
+ 		Channels must be allocated before use, completion callbacks are dispatched from dmaISR()
  @todo		
 
  @date		February 16th 2011
@@ -18,40 +19,99 @@
 // Hardware
 #include <hardware.h>
 
+// Librairies
+#include <peripheral/pic32_interrupt.h>
+#include <soft/pic32_pool.h>
+#include <string.h>
+
 // Definition
 #include <definition/stddef_megaxone.h>
 #include <definition/datatype_megaxone.h>
 
 // Dev Macro
 #include <tool/splitvar_megaxone.h>
-#include <toolbitmanip_megaxone.h>
+#include <tool/bitmanip_megaxone.h>
 // ############################################## //
 
 
 // ################## Defines ################### //
-// ############################################## //
+// == Application dependant == //
+#ifndef DMA_MEM_REQUEST_POOL_SIZE
+	#define DMA_MEM_REQUEST_POOL_SIZE	8		//Number of memory request that can be queued (all channels)
+#endif
+#ifndef DMA_MEM_CPU_THRESHOLD
+	#define DMA_MEM_CPU_THRESHOLD		64		//Memory request smaller than this (in byte) are done by the CPU
+#endif
+#ifndef DMA_MEM_PRIORITY
+	#define DMA_MEM_PRIORITY		DMA_PRIORITY_0	//Channel priority of the memory request
+#endif
+// ============================ //
 
+// == Hardware dependant == //
+#ifndef DMA_CHANNEL_NB
+	#if CPU_FAMILY == PIC32MX5xxH || CPU_FAMILY == PIC32MX5xxL || CPU_FAMILY == PIC32MX6xx || CPU_FAMILY == PIC32MX7xx
+		#define DMA_CHANNEL_NB		8		//Number of DMA channel
+	#else
+		#define DMA_CHANNEL_NB		4		//Number of DMA channel
+	#endif
+#endif
 
-// ################# Data Type ################## //
-//DMA channel control structure
-typedef union
-{
+#if CPU_FAMILY == PIC32MX3xx || CPU_FAMILY == PIC32MX4xx
+	#define DMA_MAX_SIZE			256		//Maximum source/destination/cell size (in byte)
+#else
+	#define DMA_MAX_SIZE			65536		//Maximum source/destination/cell size (in byte)
+#endif
+// ======================== //
 
-	struct
-	{
-		U32 * sourcePtr;
-		U32 * destinationPtr;
-		U16 cellSize;
-		U16 blockSize;
-		U32 startEvent;
-		U32 abortEvent;
-		struct
-		{
-			
-		}option;
-	};
-};
+// == Special value == //
+#define DMA_NO_CHANNEL				0xFF		//Returned when no channel is available
+#define DMA_IRQ_NONE				0xFF		//No start/abort IRQ
+// =================== //
+
+// == Address translation == //
+/**
+* \fn		DMA_PHY_ADDRESS(ptr)
+* @brief	Translate a KSEG0/KSEG1 virtual address to the physical address seen by the DMA
+* @note
+* @arg		ptr				Virtual address (pointer)
+* @return	U32 phyAddress			Physical address
+*/
+#define DMA_PHY_ADDRESS(ptr)			(((U32)(ptr)) & 0x1FFFFFFF)
+// ========================= //
+
+// ==== Channel Option ==== //
+#define DMA_PRIORITY_0				0		//Lowest channel priority
+#define DMA_PRIORITY_1				(BIT0)
+#define DMA_PRIORITY_2				(BIT1)
+#define DMA_PRIORITY_3				(BIT0|BIT1)	//Highest channel priority
+
+#define DMA_AUTO_ENABLE_ON			(BIT4)		//Channel stay enabled after a block transfer (continuous mode)
+#define DMA_AUTO_ENABLE_OFF			0
 
+#define DMA_CHAIN_ON				(BIT5)		//Channel is enabled by the completion of its chained channel
+#define DMA_CHAIN_OFF				0
+#define DMA_CHAIN_FROM_PREVIOUS			0		//Enabled by the channel n-1
+#define DMA_CHAIN_FROM_NEXT			(BIT8)		//Enabled by the channel n+1
+
+#define DMA_EVENT_WHEN_DISABLED			(BIT6)		//Register the start event even if the channel is disabled
+
+#define DMA_OPTION_MASK				(BIT0|BIT1|BIT4|BIT5|BIT6|BIT8)
+// ======================== //
+
+// ==== Channel Interrupt ==== //
+#define DMA_INT_ADDRESS_ERR			(BIT0)		//Address error
+#define DMA_INT_ABORT				(BIT1)		//Transfer aborted (abort IRQ or pattern match)
+#define DMA_INT_CELL_DONE			(BIT2)		//Cell transfer completed
+#define DMA_INT_BLOCK_DONE			(BIT3)		//Block transfer completed
+#define DMA_INT_DESTINATION_HALF		(BIT4)		//Destination pointer reached the middle
+#define DMA_INT_DESTINATION_FULL		(BIT5)		//Destination pointer reached the end
+#define DMA_INT_SOURCE_HALF			(BIT6)		//Source pointer reached the middle
+#define DMA_INT_SOURCE_EMPTY			(BIT7)		//Source pointer reached the end
+// =========================== //
+// ############################################## //
+
+
+// ################# Data Type ################## //
 //DCHxCON	DMA channel control
 typedef union
 {
@@ -193,13 +253,306 @@ typedef union
 		U32 :24;
 	};
 }tDCHxDAT;
+
+//Working Pointer Struct (each reg is followed by its CLR, SET and INV reg)
+typedef struct
+{
+	volatile tDCHxCON	DCHxCON;
+	volatile U32		DCHxCONCLR;
+	volatile U32		DCHxCONSET;
+	volatile U32		DCHxCONINV;
+	volatile tDCHxECON	DCHxECON;
+	volatile U32		DCHxECONCLR;
+	volatile U32		DCHxECONSET;
+	volatile U32		DCHxECONINV;
+	volatile tDCHxINT	DCHxINT;
+	volatile U32		DCHxINTCLR;
+	volatile U32		DCHxINTSET;
+	volatile U32		DCHxINTINV;
+	volatile U32		DCHxSSA;
+	volatile U32		DCHxSSACLR;
+	volatile U32		DCHxSSASET;
+	volatile U32		DCHxSSAINV;
+	volatile U32		DCHxDSA;
+	volatile U32		DCHxDSACLR;
+	volatile U32		DCHxDSASET;
+	volatile U32		DCHxDSAINV;
+	volatile tDCHxSSIZ	DCHxSSIZ;
+	volatile U32		DCHxSSIZCLR;
+	volatile U32		DCHxSSIZSET;
+	volatile U32		DCHxSSIZINV;
+	volatile tDCHxDSIZ	DCHxDSIZ;
+	volatile U32		DCHxDSIZCLR;
+	volatile U32		DCHxDSIZSET;
+	volatile U32		DCHxDSIZINV;
+	volatile tDCHxSPTR	DCHxSPTR;
+	volatile U32		DCHxSPTRCLR;
+	volatile U32		DCHxSPTRSET;
+	volatile U32		DCHxSPTRINV;
+	volatile tDCHxDPTR	DCHxDPTR;
+	volatile U32		DCHxDPTRCLR;
+	volatile U32		DCHxDPTRSET;
+	volatile U32		DCHxDPTRINV;
+	volatile tDCHxCSIZ	DCHxCSIZ;
+	volatile U32		DCHxCSIZCLR;
+	volatile U32		DCHxCSIZSET;
+	volatile U32		DCHxCSIZINV;
+	volatile tDCHxCPTR	DCHxCPTR;
+	volatile U32		DCHxCPTRCLR;
+	volatile U32		DCHxCPTRSET;
+	volatile U32		DCHxCPTRINV;
+	volatile tDCHxDAT	DCHxDAT;
+	volatile U32		DCHxDATCLR;
+	volatile U32		DCHxDATSET;
+	volatile U32		DCHxDATINV;
+}tDMAChannelReg;
+
+//DMA channel control structure
+typedef struct
+{
+	void (*callback)(U8 channel, U32 flags, void * contextPtr);	//Interrupt callback (NULL if unused)
+	void * contextPtr;			//Context given to the callback
+}tDMAChannelCtl;
+
+//Memory request (memcpy/memset offload)
+typedef struct sDMAMemRequest
+{
+	struct sDMAMemRequest * next;		//Next request on the same channel
+	U8 * destinationPtr;			//Destination of the next chunk
+	const U8 * sourcePtr;			//Source of the next chunk (NULL for a memset)
+	U32 remainingSize;			//Byte left to transfer
+	void (*callback)(U8 errorCode, void * contextPtr);	//Completion callback (NULL if unused)
+	void * contextPtr;			//Context given to the callback
+	U8 value;				//Memset value (source of the DMA for a memset)
+}tDMAMemRequest;
 // ############################################## //
 
 
 // ################# Prototypes ################# //
+// === Interrupt Handler ===== //
+/**
+* \fn		void dmaISR(U8 channel)
+* @brief	DMA channel interrupt handler, clear the flags and dispatch them to the channel callback
+* @note		This function must be placed in the ISR of the corresponding DMA channel
+*			Only the flags enabled with dmaSetCallback() are reported
+* @arg		U8 channel				DMA channel number
+* @return	nothing
+*/
+void dmaISR(U8 channel);
+// =========================== //
+
+
 // === Control Functions ===== //
+/**
+* \fn		void dmaInit(void)
+* @brief	Start the DMA module and release every channel
+* @note		Must be called before any other DMA function
+* @arg		nothing
+* @return	nothing
+*/
+void dmaInit(void);
+
+/**
+* \fn		U8 dmaAllocChannel(void)
+* @brief	Allocate the first free DMA channel
+* @note		Return DMA_NO_CHANNEL if every channel is used
+*			Channel 0 has the highest natural priority
+* @arg		nothing
+* @return	U8 channel				Allocated DMA channel number
+*/
+U8 dmaAllocChannel(void);
+
+/**
+* \fn		U8 dmaReserveChannel(U8 channel)
+* @brief	Allocate a specific DMA channel
+* @note		Usefull for chaining, which need neighbour channels
+*			Return STD_EC_BUSY if the channel is already allocated, STD_EC_NOTFOUND if it does not exist
+* @arg		U8 channel				DMA channel number
+* @return	U8 errorCode				STD Error Code (return STD_EC_SUCCESS if successful)
+*/
+U8 dmaReserveChannel(U8 channel);
+
+/**
+* \fn		U8 dmaReleaseChannel(U8 channel)
+* @brief	Abort any transfer on a channel, disable it and give it back to the free channels
+* @note		Return STD_EC_NOTFOUND if the channel does not exist
+*			Queued memory requests (dmaMemcpyAsync()/dmaMemsetAsync()) are dropped,
+*			their callback receive STD_EC_SHUTDOWN
+* @arg		U8 channel				DMA channel number
+* @return	U8 errorCode				STD Error Code (return STD_EC_SUCCESS if successful)
+*/
+U8 dmaReleaseChannel(U8 channel);
+
+/**
+* \fn		U8 dmaSetCallback(U8 channel, void (*callback)(U8, U32, void*), void * contextPtr, U32 intMask)
+* @brief	Set the function called from dmaISR() and the channel events that trigger it
+* @note		intMask is a combination of DMA_INT_x (ex: DMA_INT_BLOCK_DONE|DMA_INT_ABORT)
+*			The channel interrupt is enabled if intMask is not 0, its priority must be set in the main
+*			Return STD_EC_NOTFOUND if the channel does not exist
+* @arg		U8 channel				DMA channel number
+* @arg		void (*callback)(U8, U32, void*)	Function receiving the channel, the flags and the context
+* @arg		void * contextPtr			Context given to the callback
+* @arg		U32 intMask				Channel events to report
+* @return	U8 errorCode				STD Error Code (return STD_EC_SUCCESS if successful)
+*/
+U8 dmaSetCallback(U8 channel, void (*callback)(U8, U32, void*), void * contextPtr, U32 intMask);
+// =========================== //
+
+
+// === Transfer Functions ==== //
+/**
+* \fn		U8 dmaSetupNormalTransfer(U8 channel, U32 option, U8 startIRQ, U8 abortIRQ, void * sourcePtr, U32 sourceSize, void * destinationPtr, U32 destinationSize, U32 cellSize)
+* @brief	Configure a channel for a block transfer, a cell is transfered on each start IRQ
+* @note		Option are the Channel Option (ex: DMA_PRIORITY_3|DMA_AUTO_ENABLE_ON)
+*			Use DMA_IRQ_NONE for no start IRQ (use dmaForceStart()) or no abort IRQ
+*			Sizes are in byte, from 1 to DMA_MAX_SIZE, pointers are virtual address
+*			The channel is left disabled, use dmaEnable()
+*			Return STD_EC_NOTFOUND for an invalid channel, STD_EC_INVALID for an invalid size or IRQ
+* @arg		U8 channel				DMA channel number
+* @arg		U32 option				Channel option
+* @arg		U8 startIRQ				IRQ starting a cell transfer (IRQ_x or DMA_IRQ_NONE)
+* @arg		U8 abortIRQ				IRQ aborting the transfer (IRQ_x or DMA_IRQ_NONE)
+* @arg		void * sourcePtr			Source start address
+* @arg		U32 sourceSize				Source size (in byte)
+* @arg		void * destinationPtr			Destination start address
+* @arg		U32 destinationSize			Destination size (in byte)
+* @arg		U32 cellSize				Byte transfered on each start event
+* @return	U8 errorCode				STD Error Code (return STD_EC_SUCCESS if successful)
+*/
+U8 dmaSetupNormalTransfer(U8 channel, U32 option, U8 startIRQ, U8 abortIRQ, void * sourcePtr, U32 sourceSize, void * destinationPtr, U32 destinationSize, U32 cellSize);
+
+/**
+* \fn		U8 dmaSetupPatternTransfer(U8 channel, U32 option, U8 startIRQ, U8 pattern, void * sourcePtr, U32 sourceSize, void * destinationPtr, U32 destinationSize, U32 cellSize)
+* @brief	Configure a channel for a block transfer that is aborted when a pattern byte is transfered
+* @note		Same as dmaSetupNormalTransfer() but the abort IRQ is replaced by the pattern match (ex: '\r' for a text line)
+*			The abort is reported with DMA_INT_ABORT
+* @arg		U8 channel				DMA channel number
+* @arg		U32 option				Channel option
+* @arg		U8 startIRQ				IRQ starting a cell transfer (IRQ_x or DMA_IRQ_NONE)
+* @arg		U8 pattern				Byte ending the transfer
+* @arg		void * sourcePtr			Source start address
+* @arg		U32 sourceSize				Source size (in byte)
+* @arg		void * destinationPtr			Destination start address
+* @arg		U32 destinationSize			Destination size (in byte)
+* @arg		U32 cellSize				Byte transfered on each start event
+* @return	U8 errorCode				STD Error Code (return STD_EC_SUCCESS if successful)
+*/
+U8 dmaSetupPatternTransfer(U8 channel, U32 option, U8 startIRQ, U8 pattern, void * sourcePtr, U32 sourceSize, void * destinationPtr, U32 destinationSize, U32 cellSize);
+
+/**
+* \fn		void dmaEnable(U8 channel)
+* @brief	Enable a channel, it will transfer on each start event
+* @note
+* @arg		U8 channel				DMA channel number
+* @return	nothing
+*/
+void dmaEnable(U8 channel);
+
+/**
+* \fn		void dmaDisable(U8 channel)
+* @brief	Disable a channel, the transfer is suspended (the pointers are kept)
+* @note
+* @arg		U8 channel				DMA channel number
+* @return	nothing
+*/
+void dmaDisable(U8 channel);
+
+/**
+* \fn		void dmaForceStart(U8 channel)
+* @brief	Start a cell transfer now, as if the start IRQ occured
+* @note		The channel must be enabled
+* @arg		U8 channel				DMA channel number
+* @return	nothing
+*/
+void dmaForceStart(U8 channel);
+
+/**
+* \fn		void dmaAbort(U8 channel)
+* @brief	Abort the transfer of a channel and reset its pointers
+* @note		The channel is disabled
+* @arg		U8 channel				DMA channel number
+* @return	nothing
+*/
+void dmaAbort(U8 channel);
+
+/**
+* \fn		U8 dmaIsBusy(U8 channel)
+* @brief	Return the activity state of a channel
+* @note		A channel stay busy between its enabling and the end of the block (or its abortion)
+* @arg		U8 channel				DMA channel number
+* @return	U8 busy					1: Channel is active | 0: Channel is idle
+*/
+U8 dmaIsBusy(U8 channel);
+// =========================== //
+
+
+// === Memory Functions ====== //
+/**
+* \fn		U8 dmaMemcpyAsync(U8 channel, void * destinationPtr, const void * sourcePtr, U32 size, void (*callback)(U8, void*), void * contextPtr)
+* @brief	Copy a memory block with a DMA channel, without blocking the CPU
+* @note		The channel must be allocated and its interrupt priority set, dmaISR() must be in its ISR
+*			Requests on the same channel are done in order, a block bigger than DMA_MAX_SIZE is split in chunks
+*			Below DMA_MEM_CPU_THRESHOLD byte (and if the channel is idle) the copy is done by the CPU,
+*			the callback is then called before returning
+*			Callback receive STD_EC_SUCCESS, or STD_EC_FAIL on a DMA address error, and the context
+*			Return STD_EC_MEMORY if the request pool is empty
+* @arg		U8 channel				DMA channel number
+* @arg		void * destinationPtr			Destination start address
+* @arg		const void * sourcePtr			Source start address (RAM or Flash)
+* @arg		U32 size				Size to copy (in byte)
+* @arg		void (*callback)(U8, void*)		Completion callback (NULL if unused)
+* @arg		void * contextPtr			Context given to the callback
+* @return	U8 errorCode				STD Error Code (return STD_EC_SUCCESS if successful)
+*/
+U8 dmaMemcpyAsync(U8 channel, void * destinationPtr, const void * sourcePtr, U32 size, void (*callback)(U8, void*), void * contextPtr);
+
+/**
+* \fn		U8 dmaMemsetAsync(U8 channel, void * destinationPtr, U8 value, U32 size, void (*callback)(U8, void*), void * contextPtr)
+* @brief	Fill a memory block with a DMA channel, without blocking the CPU
+* @note		Same behavior as dmaMemcpyAsync()
+* @arg		U8 channel				DMA channel number
+* @arg		void * destinationPtr			Destination start address
+* @arg		U8 value				Value to write in each byte
+* @arg		U32 size				Size to fill (in byte)
+* @arg		void (*callback)(U8, void*)		Completion callback (NULL if unused)
+* @arg		void * contextPtr			Context given to the callback
+* @return	U8 errorCode				STD Error Code (return STD_EC_SUCCESS if successful)
+*/
+U8 dmaMemsetAsync(U8 channel, void * destinationPtr, U8 value, U32 size, void (*callback)(U8, void*), void * contextPtr);
+
+/**
+* \fn		U8 dmaMemIsBusy(U8 channel)
+* @brief	Return if a memory request is in progress or queued on a channel
+* @note
+* @arg		U8 channel				DMA channel number
+* @return	U8 busy					1: Request pending | 0: Channel queue is empty
+*/
+U8 dmaMemIsBusy(U8 channel);
+// =========================== //
+// ############################################## //
+
+
+// ############### Internal Define ############## //
+// Register access
+#define DMA_CHANNEL_REG(channel)		(((tDMAChannelReg *)&DCH0CON) + (channel))
+
+// DMACON bits
+#define DMA_MASK_ON				BIT15
+#define DMA_MASK_SUSPEND			BIT12
+
+// DCHxCON bits
+#define DMA_MASK_CHEN				BIT7
+#define DMA_MASK_CHBUSY				BIT15
+
+// DCHxECON bits
+#define DMA_MASK_AIRQEN				BIT3
+#define DMA_MASK_SIRQEN				BIT4
+#define DMA_MASK_PATEN				BIT5
+#define DMA_MASK_CABORT				BIT6
+#define DMA_MASK_CFORCE				BIT7
 
-// ========================== //
+// DMA interrupt bits in the IFS/IEC reg (channels are contiguous)
+#define DMA_INT_MASK(channel)			((_MASK_INT_DMA_0) << (channel))
 // ############################################## //
 
 #endif
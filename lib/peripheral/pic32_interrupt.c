@@ -21,10 +21,252 @@
 // ################### Define ################### //
 #define INT_IRQ_PER_IPC_REG		4
 #define INT_IRQ_PER_IEC_REG		32
+#define INT_IPC_FIELD_MASK		0x1F		//Priority and sub-priority bits of a vector in an IPC reg
+#define INT_IRQ_NB			(sizeof(intIRQInfo)/sizeof(tIntIRQInfo))
+
+/**
+* \fn		_INT_IRQ_INFO(name)
+* @brief	Build the lookup entry of a single IRQ from its Internal Definition
+* @arg		name				Interrupt name without INT_ (ex: TIMER_1)
+*/
+#define _INT_IRQ_INFO(name)			[CONCAT(IRQ_,name)] = {CONCAT(_MASK_INT_,name), CONCAT(_MASK_INT_,name), CONCAT(_REG_INT_,name), CONCAT(_POS_INT_,name), \
+						((CONCAT(INT_VEC_,name)) / INT_IRQ_PER_IPC_REG) * REG_OFFSET_NEXT_32, ((CONCAT(INT_VEC_,name)) % INT_IRQ_PER_IPC_REG) << 3}
+
+/**
+* \fn		_INT_IRQ_INFO_GROUP(name, group)
+* @brief	Build the lookup entry of the first IRQ of a group, the group mask is used when the IRQ group flag is set
+* @arg		name				Interrupt name without INT_ of the first IRQ of the group (ex: UART_1_ERR)
+* @arg		group				Group name without INT_ (ex: UART_1)
+*/
+#define _INT_IRQ_INFO_GROUP(name, group)	[CONCAT(IRQ_,name)] = {CONCAT(_MASK_INT_,name), CONCAT(_MASK_INT_,group), CONCAT(_REG_INT_,name), CONCAT(_POS_INT_,name), \
+						((CONCAT(INT_VEC_,name)) / INT_IRQ_PER_IPC_REG) * REG_OFFSET_NEXT_32, ((CONCAT(INT_VEC_,name)) % INT_IRQ_PER_IPC_REG) << 3}
 // ############################################## //
 
 
 // ################# Variables ################## //
+// -- IRQ Lookup Table -- //
+// Indexed by tIntIRQ (without the group flag), unused IRQ are left at 0 and are ignored
+#if CPU_FAMILY == PIC32MX1xx || CPU_FAMILY == PIC32MX2xx
+const tIntIRQInfo intIRQInfo[] =
+{
+	_INT_IRQ_INFO(CORE_TIMER),
+	_INT_IRQ_INFO(CORE_SOFT_0),
+	_INT_IRQ_INFO(CORE_SOFT_1),
+	_INT_IRQ_INFO(EXT_INT_0),
+	_INT_IRQ_INFO(TIMER_1),
+	_INT_IRQ_INFO(INPUT_CAPTURE_1_ERR),
+	_INT_IRQ_INFO(INPUT_CAPTURE_1),
+	_INT_IRQ_INFO(OUTPUT_COMPARE_1),
+	_INT_IRQ_INFO(EXT_INT_1),
+	_INT_IRQ_INFO_GROUP(TIMER_2, TIMER_23),
+	_INT_IRQ_INFO(INPUT_CAPTURE_2_ERR),
+	_INT_IRQ_INFO(INPUT_CAPTURE_2),
+	_INT_IRQ_INFO(OUTPUT_COMPARE_2),
+	_INT_IRQ_INFO(EXT_INT_2),
+	_INT_IRQ_INFO(TIMER_3),
+	_INT_IRQ_INFO(INPUT_CAPTURE_3_ERR),
+	_INT_IRQ_INFO(INPUT_CAPTURE_3),
+	_INT_IRQ_INFO(OUTPUT_COMPARE_3),
+	_INT_IRQ_INFO(EXT_INT_3),
+	_INT_IRQ_INFO_GROUP(TIMER_4, TIMER_45),
+	_INT_IRQ_INFO(INPUT_CAPTURE_4_ERR),
+	_INT_IRQ_INFO(INPUT_CAPTURE_4),
+	_INT_IRQ_INFO(OUTPUT_COMPARE_4),
+	_INT_IRQ_INFO(EXT_INT_4),
+	_INT_IRQ_INFO(TIMER_5),
+	_INT_IRQ_INFO(INPUT_CAPTURE_5_ERR),
+	_INT_IRQ_INFO(INPUT_CAPTURE_5),
+	_INT_IRQ_INFO(OUTPUT_COMPARE_5),
+	_INT_IRQ_INFO(ADC_1),
+	_INT_IRQ_INFO(FAIL_SAFE_CLOCK_MON),
+	_INT_IRQ_INFO(RTCC),
+	_INT_IRQ_INFO(FLASH_CONTROL_EVENT),
+	_INT_IRQ_INFO(COMPARATOR_1),
+	_INT_IRQ_INFO(COMPARATOR_2),
+	_INT_IRQ_INFO(COMPARATOR_3),
+	_INT_IRQ_INFO(USB),
+	_INT_IRQ_INFO_GROUP(SPI_1_ERR, SPI_1),
+	_INT_IRQ_INFO(SPI_1_RX),
+	_INT_IRQ_INFO(SPI_1_TX),
+	_INT_IRQ_INFO_GROUP(UART_1_ERR, UART_1),
+	_INT_IRQ_INFO(UART_1_RX),
+	_INT_IRQ_INFO(UART_1_TX),
+	_INT_IRQ_INFO_GROUP(I2C_1_COL, I2C_1),
+	_INT_IRQ_INFO(I2C_1_SLAVE),
+	_INT_IRQ_INFO(I2C_1_MASTER),
+	_INT_IRQ_INFO_GROUP(INPUT_CHANGE_PORT_A, INPUT_CHANGE),
+	_INT_IRQ_INFO(INPUT_CHANGE_PORT_B),
+	_INT_IRQ_INFO(INPUT_CHANGE_PORT_C),
+	_INT_IRQ_INFO(PMP),
+	_INT_IRQ_INFO(PMP_ERR),
+	_INT_IRQ_INFO_GROUP(SPI_2_ERR, SPI_2),
+	_INT_IRQ_INFO(SPI_2_RX),
+	_INT_IRQ_INFO(SPI_2_TX),
+	_INT_IRQ_INFO_GROUP(UART_2_ERR, UART_2),
+	_INT_IRQ_INFO(UART_2_RX),
+	_INT_IRQ_INFO(UART_2_TX),
+	_INT_IRQ_INFO_GROUP(I2C_2_COL, I2C_2),
+	_INT_IRQ_INFO(I2C_2_SLAVE),
+	_INT_IRQ_INFO(I2C_2_MASTER),
+	_INT_IRQ_INFO(CTMU),
+	_INT_IRQ_INFO(DMA_0),
+	_INT_IRQ_INFO(DMA_1),
+	_INT_IRQ_INFO(DMA_2),
+	_INT_IRQ_INFO(DMA_3)
+};
+#elif CPU_FAMILY == PIC32MX3xx || CPU_FAMILY == PIC32MX4xx
+const tIntIRQInfo intIRQInfo[] =
+{
+	_INT_IRQ_INFO(CORE_TIMER),
+	_INT_IRQ_INFO(CORE_SOFT_0),
+	_INT_IRQ_INFO(CORE_SOFT_1),
+	_INT_IRQ_INFO(EXT_INT_0),
+	_INT_IRQ_INFO(TIMER_1),
+	_INT_IRQ_INFO(INPUT_CAPTURE_1),
+	_INT_IRQ_INFO(OUTPUT_COMPARE_1),
+	_INT_IRQ_INFO(EXT_INT_1),
+	_INT_IRQ_INFO_GROUP(TIMER_2, TIMER_23),
+	_INT_IRQ_INFO(INPUT_CAPTURE_2),
+	_INT_IRQ_INFO(OUTPUT_COMPARE_2),
+	_INT_IRQ_INFO(EXT_INT_2),
+	_INT_IRQ_INFO(TIMER_3),
+	_INT_IRQ_INFO(INPUT_CAPTURE_3),
+	_INT_IRQ_INFO(OUTPUT_COMPARE_3),
+	_INT_IRQ_INFO(EXT_INT_3),
+	_INT_IRQ_INFO_GROUP(TIMER_4, TIMER_45),
+	_INT_IRQ_INFO(INPUT_CAPTURE_4),
+	_INT_IRQ_INFO(OUTPUT_COMPARE_4),
+	_INT_IRQ_INFO(EXT_INT_4),
+	_INT_IRQ_INFO(TIMER_5),
+	_INT_IRQ_INFO(INPUT_CAPTURE_5),
+	_INT_IRQ_INFO(OUTPUT_COMPARE_5),
+	_INT_IRQ_INFO_GROUP(SPI_1_ERR, SPI_1),
+	_INT_IRQ_INFO(SPI_1_RX),
+	_INT_IRQ_INFO(SPI_1_TX),
+	_INT_IRQ_INFO_GROUP(UART_1_ERR, UART_1),
+	_INT_IRQ_INFO(UART_1_RX),
+	_INT_IRQ_INFO(UART_1_TX),
+	_INT_IRQ_INFO_GROUP(I2C_1_COL, I2C_1),
+	_INT_IRQ_INFO(I2C_1_SLAVE),
+	_INT_IRQ_INFO(I2C_1_MASTER),
+	_INT_IRQ_INFO(INPUT_CHANGE),
+	_INT_IRQ_INFO(ADC_1),
+	_INT_IRQ_INFO(PMP),
+	_INT_IRQ_INFO(COMPARATOR_1),
+	_INT_IRQ_INFO(COMPARATOR_2),
+	_INT_IRQ_INFO_GROUP(SPI_2_ERR, SPI_2),
+	_INT_IRQ_INFO(SPI_2_RX),
+	_INT_IRQ_INFO(SPI_2_TX),
+	_INT_IRQ_INFO_GROUP(UART_2_ERR, UART_2),
+	_INT_IRQ_INFO(UART_2_RX),
+	_INT_IRQ_INFO(UART_2_TX),
+	_INT_IRQ_INFO_GROUP(I2C_2_COL, I2C_2),
+	_INT_IRQ_INFO(I2C_2_SLAVE),
+	_INT_IRQ_INFO(I2C_2_MASTER),
+	_INT_IRQ_INFO(FAIL_SAFE_CLOCK_MON),
+	_INT_IRQ_INFO(RTCC),
+	_INT_IRQ_INFO(DMA_0),
+	_INT_IRQ_INFO(DMA_1),
+	_INT_IRQ_INFO(DMA_2),
+	_INT_IRQ_INFO(DMA_3),
+	_INT_IRQ_INFO(FLASH_CONTROL_EVENT),
+	_INT_IRQ_INFO(USB)
+};
+#elif CPU_FAMILY == PIC32MX5xxH || CPU_FAMILY == PIC32MX5xxL || CPU_FAMILY == PIC32MX6xx || CPU_FAMILY == PIC32MX7xx
+const tIntIRQInfo intIRQInfo[] =
+{
+	_INT_IRQ_INFO(CORE_TIMER),
+	_INT_IRQ_INFO(CORE_SOFT_0),
+	_INT_IRQ_INFO(CORE_SOFT_1),
+	_INT_IRQ_INFO(EXT_INT_0),
+	_INT_IRQ_INFO(TIMER_1),
+	_INT_IRQ_INFO(INPUT_CAPTURE_1),
+	_INT_IRQ_INFO(OUTPUT_COMPARE_1),
+	_INT_IRQ_INFO(EXT_INT_1),
+	_INT_IRQ_INFO_GROUP(TIMER_2, TIMER_23),
+	_INT_IRQ_INFO(INPUT_CAPTURE_2),
+	_INT_IRQ_INFO(OUTPUT_COMPARE_2),
+	_INT_IRQ_INFO(EXT_INT_2),
+	_INT_IRQ_INFO(TIMER_3),
+	_INT_IRQ_INFO(INPUT_CAPTURE_3),
+	_INT_IRQ_INFO(OUTPUT_COMPARE_3),
+	_INT_IRQ_INFO(EXT_INT_3),
+	_INT_IRQ_INFO_GROUP(TIMER_4, TIMER_45),
+	_INT_IRQ_INFO(INPUT_CAPTURE_4),
+	_INT_IRQ_INFO(OUTPUT_COMPARE_4),
+	_INT_IRQ_INFO(EXT_INT_4),
+	_INT_IRQ_INFO(TIMER_5),
+	_INT_IRQ_INFO(INPUT_CAPTURE_5),
+	_INT_IRQ_INFO(OUTPUT_COMPARE_5),
+	_INT_IRQ_INFO_GROUP(SPI_1_ERR, SPI_1),
+	_INT_IRQ_INFO(SPI_1_RX),
+	_INT_IRQ_INFO(SPI_1_TX),
+	_INT_IRQ_INFO_GROUP(UART_1_ERR, UART_1),
+	_INT_IRQ_INFO(UART_1_RX),
+	_INT_IRQ_INFO(UART_1_TX),
+	_INT_IRQ_INFO_GROUP(I2C_1_COL, I2C_1),
+	_INT_IRQ_INFO(I2C_1_SLAVE),
+	_INT_IRQ_INFO(I2C_1_MASTER),
+	_INT_IRQ_INFO(INPUT_CHANGE),
+	_INT_IRQ_INFO(ADC_1),
+	_INT_IRQ_INFO(PMP),
+	_INT_IRQ_INFO(COMPARATOR_1),
+	_INT_IRQ_INFO(COMPARATOR_2),
+	_INT_IRQ_INFO_GROUP(UART_3_ERR, UART_3),
+	_INT_IRQ_INFO(UART_3_RX),
+	_INT_IRQ_INFO(UART_3_TX),
+	_INT_IRQ_INFO_GROUP(UART_2_ERR, UART_2),
+	_INT_IRQ_INFO(UART_2_RX),
+	_INT_IRQ_INFO(UART_2_TX),
+	_INT_IRQ_INFO_GROUP(I2C_2_COL, I2C_2),
+	_INT_IRQ_INFO(I2C_2_SLAVE),
+	_INT_IRQ_INFO(I2C_2_MASTER),
+	_INT_IRQ_INFO(FAIL_SAFE_CLOCK_MON),
+	_INT_IRQ_INFO(RTCC),
+	_INT_IRQ_INFO(DMA_0),
+	_INT_IRQ_INFO(DMA_1),
+	_INT_IRQ_INFO(DMA_2),
+	_INT_IRQ_INFO(DMA_3),
+	_INT_IRQ_INFO(DMA_4),
+	_INT_IRQ_INFO(DMA_5),
+	_INT_IRQ_INFO(DMA_6),
+	_INT_IRQ_INFO(DMA_7),
+	_INT_IRQ_INFO(FLASH_CONTROL_EVENT),
+	_INT_IRQ_INFO(USB),
+	_INT_IRQ_INFO(CAN_1),
+	_INT_IRQ_INFO(CAN_2),
+	_INT_IRQ_INFO(ETHERNET),
+	_INT_IRQ_INFO(INPUT_CAPTURE_1_ERR),
+	_INT_IRQ_INFO(INPUT_CAPTURE_2_ERR),
+	_INT_IRQ_INFO(INPUT_CAPTURE_3_ERR),
+	_INT_IRQ_INFO(INPUT_CAPTURE_4_ERR),
+	_INT_IRQ_INFO(INPUT_CAPTURE_5_ERR),
+	_INT_IRQ_INFO(PMP_ERR),
+	_INT_IRQ_INFO_GROUP(UART_4_ERR, UART_4),
+	_INT_IRQ_INFO(UART_4_RX),
+	_INT_IRQ_INFO(UART_4_TX),
+	_INT_IRQ_INFO_GROUP(UART_6_ERR, UART_6),
+	_INT_IRQ_INFO(UART_6_RX),
+	_INT_IRQ_INFO(UART_6_TX),
+	_INT_IRQ_INFO_GROUP(UART_5_ERR, UART_5),
+	_INT_IRQ_INFO(UART_5_RX),
+	_INT_IRQ_INFO(UART_5_TX)
+};
+#endif
+// ---------------------- //
+
+// -- Dispatch Table -- //
+tIntHandler intHandlerTable[INT_IRQ_NB];
+tIntVectorCtl intVectorCtl[INT_VECTOR_NB];
+// -------------------- //
+
+// -- Profiler -- //
+#ifdef INT_PROFILER
+tIntProfileStats intProfileStats[INT_VECTOR_NB];
+U32 intProfileLoadSum = 0;			//Total of every durationSum at the previous intProfileGetLoad()
+U32 intProfileLoadTick = 0;			//Core timer at the previous intProfileGetLoad()
+#endif
+// -------------- //
 // ############################################## //
 
 
@@ -33,6 +275,8 @@
 * \fn		void _intSetReg(U32 * regPtr, tIntIRQ intIRQSource, U8 state)
 * @brief	Write access to a interrupt register
 * @note		INTERNAL FUNCTION Do not use directly!!!
+*		The IRQ is found in the lookup table, the bits are written with the SET/CLR reg
+*		For an IRQ group, bit n of the state is written to the IRQ n after the first IRQ of the group
 * @arg		U32 * regPtr			Pointer to the register being written
 * @arg		tIntIRQ intIRQSource		Which interrupt to set
 * @arg		U8 state			State to set the bit
@@ -40,30 +284,29 @@
 */
 void _intSetReg(volatile U32 * regPtr, tIntIRQ intIRQSource, U8 state)
 {
-	U8 maskTemp = BIT0;				//Default mask for only 1 bit
-	
-	// -- Intercept the Group flag -- //
-	if (intIRQSource & BIT7)
-	{
-		maskTemp = BIT1|BIT0;			//Group at at least 2 bit wide
-		if (intIRQSource > 22)
-			maskTemp |= BIT2;		//Higher group are 3 bit wide
-		intIRQSource &= 0x7F;			//Remove the flag
-	}
-	// ------------------------------ //
+	const tIntIRQInfo * infoPtr;
+	U32 maskTemp;
+	U32 bitTemp;
 
-	// -- Point the correct IEC Reg -- //
-	while (intIRQSource > (INT_IRQ_PER_IEC_REG-1))
-	{
-		regPtr += REG_OFFSET_NEXT_32;		//Point to the next reg
-		intIRQSource -= INT_IRQ_PER_IEC_REG;	//Substract the IRQ skipped
-	}
-	// ------------------------------- //
+	if ((intIRQSource & 0x7F) >= INT_IRQ_NB)
+		return;
+	infoPtr = &intIRQInfo[intIRQSource & 0x7F];
 
-	// -- Set the state -- //
-	state &= maskTemp;				//Leave only the first bit
-	*regPtr |= state << intIRQSource;
-	// ------------------- //
+	// -- Select the bit or the group -- //
+	if (intIRQSource & BIT7)
+		maskTemp = infoPtr->groupMask;
+	else
+		maskTemp = infoPtr->mask;
+	bitTemp = ((U32)state << infoPtr->pos) & maskTemp;	//Align the state on the first IRQ
+	// --------------------------------- //
+
+	// -- Write the state -- //
+	regPtr += infoPtr->regIndex * REG_OFFSET_NEXT_32;	//Point the correct IFS/IEC Reg
+	if (bitTemp)
+		regPtr[REG_OFFSET_SET_32] = bitTemp;
+	if (maskTemp & ~bitTemp)
+		regPtr[REG_OFFSET_CLR_32] = maskTemp & ~bitTemp;
+	// --------------------- //
 }
 
 /**
@@ -76,27 +319,21 @@ void _intSetReg(volatile U32 * regPtr, tIntIRQ intIRQSource, U8 state)
 */
 U8 _intGetReg(volatile U32 * regPtr, tIntIRQ intIRQSource)
 {
-	U8 maskTemp = BIT0;				//Default mask for only 1 bit
+	const tIntIRQInfo * infoPtr;
+	U32 maskTemp;
 
-	// -- Intercept the Group flag -- //
-	if (intIRQSource & BIT7)
-	{
-		maskTemp = BIT1|BIT0;			//Group at at least 2 bit wide
-		if (intIRQSource > 22)
-			maskTemp |= BIT2;		//Higher group are 3 bit wide
-		intIRQSource &= 0x7F;			//Remove the flag
-	}
-	// ------------------------------ //
+	if ((intIRQSource & 0x7F) >= INT_IRQ_NB)
+		return 0;
+	infoPtr = &intIRQInfo[intIRQSource & 0x7F];
 
-	// -- Point the correct IFS Reg -- //
-	while (intIRQSource > (INT_IRQ_PER_IEC_REG-1))
-	{
-		regPtr += REG_OFFSET_NEXT_32;		//Point to the next reg
-		intIRQSource -= INT_IRQ_PER_IEC_REG;	//Substract the IRQ skipped
-	}
-	// ------------------------------- //
+	// -- Select the bit or the group -- //
+	if (intIRQSource & BIT7)
+		maskTemp = infoPtr->groupMask;
+	else
+		maskTemp = infoPtr->mask;
+	// --------------------------------- //
 
-	return ((*regPtr & (maskTemp << intIRQSource)) >> intIRQSource);
+	return (regPtr[infoPtr->regIndex * REG_OFFSET_NEXT_32] & maskTemp) >> infoPtr->pos;
 }
 
 /**
@@ -110,94 +347,24 @@ U8 _intGetReg(volatile U32 * regPtr, tIntIRQ intIRQSource)
 */
 void intSetPriority(tIntIRQ intIRQSource, U8 priorityLvl, U8 subPriorityLvl)
 {
-	subPriorityLvl &= 0x3;				//Leave only the 2 LSb
-	priorityLvl &= 0x7;				//Leave only the 3 LSb
-
-	// -- Matrix -- //
+	const tIntIRQInfo * infoPtr;
+	volatile U32 * regPtr;
+	U32 fieldTemp;
 
+	if ((intIRQSource & 0x7F) >= INT_IRQ_NB)
+		return;
+	infoPtr = &intIRQInfo[intIRQSource & 0x7F];
+	if (infoPtr->mask == 0)
+		return;						//Unused IRQ
 
-	// ------------ //
-
-	switch (intIRQSource)
-	{
-		case IRQ_CORE_TIMER:		_IPC_INT_CORE_TIMER = priorityLvl;	_SIPC_INT_CORE_TIMER = subPriorityLvl;		break;
-		case IRQ_CORE_SOFT_0:		_IPC_INT_CORE_SOFT_0 = priorityLvl;	_SIPC_INT_CORE_SOFT_0 = subPriorityLvl;		break;
-		case IRQ_CORE_SOFT_1:		_IPC_INT_CORE_SOFT_1 = priorityLvl;	_SIPC_INT_CORE_SOFT_1 = subPriorityLvl;		break;
-		case IRQ_EXT_INT_0:		_IPC_INT_EXT_INT_0 = priorityLvl;	_SIPC_INT_EXT_INT_0 = subPriorityLvl;		break;
-		case IRQ_TIMER_1:		_IPC_INT_TIMER_1 = priorityLvl;		_SIPC_INT_TIMER_1 = subPriorityLvl;		break;
-		case IRQ_INPUT_CAPTURE_1:	_IPC_INT_INPUT_CAPTURE_1 = priorityLvl;	_SIPC_INT_INPUT_CAPTURE_1 = subPriorityLvl;	break;
-		case IRQ_OUTPUT_COMPARE_1:	_IPC_INT_OUTPUT_COMPARE_1 = priorityLvl;_SIPC_INT_OUTPUT_COMPARE_1 = subPriorityLvl;	break;
-		case IRQ_EXT_INT_1:		_IPC_INT_EXT_INT_1 = priorityLvl;	_SIPC_INT_EXT_INT_1 = subPriorityLvl;		break;
-		case IRQ_TIMER_2:		_IPC_INT_TIMER_2 = priorityLvl;		_SIPC_INT_TIMER_2 = subPriorityLvl;		break;
-		case IRQ_INPUT_CAPTURE_2:	_IPC_INT_INPUT_CAPTURE_2 = priorityLvl;	_SIPC_INT_INPUT_CAPTURE_2 = subPriorityLvl;	break;
-		case IRQ_OUTPUT_COMPARE_2:	_IPC_INT_OUTPUT_COMPARE_2 = priorityLvl;_SIPC_INT_OUTPUT_COMPARE_2 = subPriorityLvl;	break;
-		case IRQ_EXT_INT_2:		_IPC_INT_EXT_INT_2 = priorityLvl;	_SIPC_INT_EXT_INT_2 = subPriorityLvl;		break;		
-		case IRQ_TIMER_3:		_IPC_INT_TIMER_3 = priorityLvl;		_SIPC_INT_TIMER_3 = subPriorityLvl;		break;
-		case IRQ_INPUT_CAPTURE_3:	_IPC_INT_INPUT_CAPTURE_3 = priorityLvl;	_SIPC_INT_INPUT_CAPTURE_3 = subPriorityLvl;	break;
-		case IRQ_OUTPUT_COMPARE_3:	_IPC_INT_OUTPUT_COMPARE_3 = priorityLvl;_SIPC_INT_OUTPUT_COMPARE_3 = subPriorityLvl;	break;
-		case IRQ_EXT_INT_3:		_IPC_INT_EXT_INT_3 = priorityLvl;	_SIPC_INT_EXT_INT_3 = subPriorityLvl;		break;
-		case IRQ_TIMER_4:		_IPC_INT_TIMER_4 = priorityLvl;		_SIPC_INT_TIMER_4 = subPriorityLvl;		break;
-		case IRQ_INPUT_CAPTURE_4:	_IPC_INT_INPUT_CAPTURE_4 = priorityLvl;	_SIPC_INT_INPUT_CAPTURE_4 = subPriorityLvl;	break;
-		case IRQ_OUTPUT_COMPARE_4:	_IPC_INT_OUTPUT_COMPARE_4 = priorityLvl;_SIPC_INT_OUTPUT_COMPARE_4 = subPriorityLvl;	break;
-		case IRQ_EXT_INT_4:		_IPC_INT_EXT_INT_4 = priorityLvl;	_SIPC_INT_EXT_INT_4 = subPriorityLvl;		break;
-		case IRQ_TIMER_5:		_IPC_INT_TIMER_5 = priorityLvl;		_SIPC_INT_TIMER_5 = subPriorityLvl;		break;
-		case IRQ_INPUT_CAPTURE_5:	_IPC_INT_INPUT_CAPTURE_5 = priorityLvl;	_SIPC_INT_INPUT_CAPTURE_5 = subPriorityLvl;	break;
-		case IRQ_OUTPUT_COMPARE_5:	_IPC_INT_OUTPUT_COMPARE_5 = priorityLvl;_SIPC_INT_OUTPUT_COMPARE_5 = subPriorityLvl;	break;
-		
-		case IRQ_SPI_1:			_IPC_INT_SPI_1 = priorityLvl;		_SIPC_INT_SPI_1 = subPriorityLvl;		break;
-		case IRQ_SPI_2:			_IPC_INT_SPI_2 = priorityLvl;		_SIPC_INT_SPI_2 = subPriorityLvl;		break;
-#if CPU_FAMILY == PIC32MX5xxH || CPU_FAMILY == PIC32MX5xxL || CPU_FAMILY == PIC32MX6xx || CPU_FAMILY == PIC32MX7xx		
-//		case IRQ_SPI_3:			_IPC_INT_SPI_3 = priorityLvl;		_SIPC_INT_SPI_3 = subPriorityLvl;		break;
-//		case IRQ_SPI_4:			_IPC_INT_SPI_4 = priorityLvl;		_SIPC_INT_SPI_4 = subPriorityLvl;		break;
-#endif		
-		case IRQ_UART_1:		_IPC_INT_UART_1 = priorityLvl;		_SIPC_INT_UART_1 = subPriorityLvl;		break;		
-		case IRQ_UART_2:		_IPC_INT_UART_2 = priorityLvl;		_SIPC_INT_UART_2 = subPriorityLvl;		break;
-#if CPU_FAMILY == PIC32MX5xxH || CPU_FAMILY == PIC32MX5xxL || CPU_FAMILY == PIC32MX6xx || CPU_FAMILY == PIC32MX7xx		
-//		case IRQ_UART_3:		_IPC_INT_UART_3 = priorityLvl;		_SIPC_INT_UART_3 = subPriorityLvl;		break;
-		case IRQ_UART_4:		_IPC_INT_UART_4 = priorityLvl;		_SIPC_INT_UART_4 = subPriorityLvl;		break;		
-		case IRQ_UART_5:		_IPC_INT_UART_5 = priorityLvl;		_SIPC_INT_UART_5 = subPriorityLvl;		break;		
-		case IRQ_UART_6:		_IPC_INT_UART_6 = priorityLvl;		_SIPC_INT_UART_6 = subPriorityLvl;		break;
-#endif		
-		case IRQ_I2C_1:			_IPC_INT_I2C_1 = priorityLvl;		_SIPC_INT_I2C_1 = subPriorityLvl;		break;		
-		case IRQ_I2C_2:			_IPC_INT_I2C_2 = priorityLvl;		_SIPC_INT_I2C_2 = subPriorityLvl;		break;
-#if CPU_FAMILY == PIC32MX5xxH || CPU_FAMILY == PIC32MX5xxL || CPU_FAMILY == PIC32MX6xx || CPU_FAMILY == PIC32MX7xx
-//		case IRQ_I2C_3:			_IPC_INT_I2C_3 = priorityLvl;		_SIPC_INT_I2C_3 = subPriorityLvl;		break;
-//		case IRQ_I2C_4:			_IPC_INT_I2C_4 = priorityLvl;		_SIPC_INT_I2C_4 = subPriorityLvl;		break;
-//		case IRQ_I2C_5:			_IPC_INT_I2C_5 = priorityLvl;		_SIPC_INT_I2C_5 = subPriorityLvl;		break;
-#endif
-		case IRQ_INPUT_CHANGE:		_IPC_INT_INPUT_CHANGE = priorityLvl;	_SIPC_INT_INPUT_CHANGE = subPriorityLvl;	break;
-		case IRQ_ADC_1:			_IPC_INT_ADC_1 = priorityLvl;		_SIPC_INT_ADC_1 = subPriorityLvl;		break;
-		case IRQ_PMP:			_IPC_INT_PMP = priorityLvl;		_SIPC_INT_PMP = subPriorityLvl;			break;
-		case IRQ_PMP_ERR:		_IPC_INT_PMP_ERR = priorityLvl;		_SIPC_INT_PMP_ERR = subPriorityLvl;		break;
-		case IRQ_COMPARATOR_1:		_IPC_INT_COMPARATOR_1 = priorityLvl;	_SIPC_INT_COMPARATOR_1 = subPriorityLvl;	break;
-		case IRQ_COMPARATOR_2:		_IPC_INT_COMPARATOR_2 = priorityLvl;	_SIPC_INT_COMPARATOR_2 = subPriorityLvl;	break;
-		case IRQ_FAIL_SAFE_CLOCK_MON:	_IPC_INT_FAIL_SAFE_CLOCK_MON = priorityLvl;_SIPC_INT_FAIL_SAFE_CLOCK_MON = subPriorityLvl;break;
-		case IRQ_RTCC:			_IPC_INT_RTCC = priorityLvl;		_SIPC_INT_RTCC = subPriorityLvl;		break;
-		case IRQ_DMA_0:			_IPC_INT_DMA_0 = priorityLvl;		_SIPC_INT_DMA_0 = subPriorityLvl;		break;
-		case IRQ_DMA_1:			_IPC_INT_DMA_1 = priorityLvl;		_SIPC_INT_DMA_1 = subPriorityLvl;		break;
-		case IRQ_DMA_2:			_IPC_INT_DMA_2 = priorityLvl;		_SIPC_INT_DMA_2 = subPriorityLvl;		break;
-		case IRQ_DMA_3:			_IPC_INT_DMA_3 = priorityLvl;		_SIPC_INT_DMA_3 = subPriorityLvl;		break;
-#if CPU_FAMILY == PIC32MX5xxH || CPU_FAMILY == PIC32MX5xxL || CPU_FAMILY == PIC32MX6xx || CPU_FAMILY == PIC32MX7xx
-		case IRQ_DMA_4:			_IPC_INT_DMA_4 = priorityLvl;		_SIPC_INT_DMA_4 = subPriorityLvl;		break;
-		case IRQ_DMA_5:			_IPC_INT_DMA_5 = priorityLvl;		_SIPC_INT_DMA_5 = subPriorityLvl;		break;
-		case IRQ_DMA_6:			_IPC_INT_DMA_6 = priorityLvl;		_SIPC_INT_DMA_6 = subPriorityLvl;		break;
-		case IRQ_DMA_7:			_IPC_INT_DMA_7 = priorityLvl;		_SIPC_INT_DMA_7 = subPriorityLvl;		break;
-#endif
-		case IRQ_FLASH_CONTROL_EVENT:	_IPC_INT_FLASH_CONTROL_EVENT = priorityLvl;_SIPC_INT_FLASH_CONTROL_EVENT = subPriorityLvl;break;
-#if CPU_FAMILY == PIC32MX5xxH || CPU_FAMILY == PIC32MX5xxL || CPU_FAMILY == PIC32MX6xx || CPU_FAMILY == PIC32MX7xx
-		case IRQ_USB:			_IPC_INT_USB = priorityLvl;		_SIPC_INT_USB = subPriorityLvl;			break;
-		case IRQ_CAN_1:			_IPC_INT_CAN_1 = priorityLvl;		_SIPC_INT_CAN_1 = subPriorityLvl;		break;
-#endif
-//		case IRQ_CAN_2:			_IPC_INT_CAN_2 = priorityLvl;		_SIPC_INT_CAN_2 = subPriorityLvl;		break;
-//		case IRQ_ETHERNET:		_IPC_INT_ETHERNET = priorityLvl;	_SIPC_INT_ETHERNET = subPriorityLvl;		break;
-		case IRQ_INPUT_CAPTURE_1_ERR:	_IPC_INT_INPUT_CAPTURE_1_ERR = priorityLvl;_SIPC_INT_INPUT_CAPTURE_1_ERR = subPriorityLvl;break;
-		case IRQ_INPUT_CAPTURE_2_ERR:	_IPC_INT_INPUT_CAPTURE_2_ERR = priorityLvl;_SIPC_INT_INPUT_CAPTURE_2_ERR = subPriorityLvl;break;
-		case IRQ_INPUT_CAPTURE_3_ERR:	_IPC_INT_INPUT_CAPTURE_3_ERR = priorityLvl;_SIPC_INT_INPUT_CAPTURE_3_ERR = subPriorityLvl;break;
-		case IRQ_INPUT_CAPTURE_4_ERR:	_IPC_INT_INPUT_CAPTURE_4_ERR = priorityLvl;_SIPC_INT_INPUT_CAPTURE_4_ERR = subPriorityLvl;break;
-		case IRQ_INPUT_CAPTURE_5_ERR:	_IPC_INT_INPUT_CAPTURE_5_ERR = priorityLvl;_SIPC_INT_INPUT_CAPTURE_5_ERR = subPriorityLvl;break;
-		default: return;
-	}
+	subPriorityLvl &= 0x3;				//Leave only the 2 LSb
+	priorityLvl &= 0x7;				//Leave only the 3 LSb
 
+	// -- Flip only the bits that change -- //
+	regPtr = ((volatile U32 *)&IPC0) + infoPtr->ipcOffset;
+	fieldTemp = ((priorityLvl << 2) | subPriorityLvl) << infoPtr->ipcShift;
+	regPtr[REG_OFFSET_INV_32] = (*regPtr ^ fieldTemp) & (INT_IPC_FIELD_MASK << infoPtr->ipcShift);
+	// ------------------------------------ //
 }
 
 /**
@@ -209,20 +376,13 @@ void intSetPriority(tIntIRQ intIRQSource, U8 priorityLvl, U8 subPriorityLvl)
 */
 U8 intGetPriority(tIntIRQ intIRQSource)
 {
-	U32 * regPtr = (U32*)&IPC0;
-	U8 returnPriority;
-
-	// -- Point the correct IPC Reg -- //
-	regPtr += REG_OFFSET_NEXT_32 * (((U8)intIRQSource)/INT_IRQ_PER_IPC_REG);
-	intIRQSource %= INT_IRQ_PER_IPC_REG;		//Adjust to the current pointer reg
-	// ------------------------------- //
+	const tIntIRQInfo * infoPtr;
 
-	// -- Format the result -- //
-	returnPriority = (*regPtr >> (intIRQSource << 3)) & (BIT4|BIT3|BIT2) ;	//Extract, mask and align the priority
-	returnPriority >>= 2;				//Realign the priority
-	// ----------------------- //
+	if ((intIRQSource & 0x7F) >= INT_IRQ_NB)
+		return 0;
+	infoPtr = &intIRQInfo[intIRQSource & 0x7F];
 
-	return returnPriority;
+	return (((volatile U32 *)&IPC0)[infoPtr->ipcOffset] >> (infoPtr->ipcShift + 2)) & 0x7;	//Extract, align and mask the priority
 }
 
 /**
@@ -234,14 +394,13 @@ U8 intGetPriority(tIntIRQ intIRQSource)
 */
 U8 intGetSubPriority(tIntIRQ intIRQSource)
 {
-	U32 * regPtr = (U32*)&IPC0;
+	const tIntIRQInfo * infoPtr;
 
-	// -- Point the correct IPC Reg -- //
-	regPtr += REG_OFFSET_NEXT_32 * (((U8)intIRQSource)/INT_IRQ_PER_IPC_REG);
-	intIRQSource %= INT_IRQ_PER_IPC_REG;		//Adjust to the current pointer reg
-	// ------------------------------- //
+	if ((intIRQSource & 0x7F) >= INT_IRQ_NB)
+		return 0;
+	infoPtr = &intIRQInfo[intIRQSource & 0x7F];
 
-	return (*regPtr >> (intIRQSource << 3)) & (BIT1|BIT0);	//Extract, mask and align the subPriority
+	return (((volatile U32 *)&IPC0)[infoPtr->ipcOffset] >> infoPtr->ipcShift) & (BIT1|BIT0);	//Extract, align and mask the subPriority
 }
 
 /**
@@ -264,6 +423,340 @@ void intSetExternalEdge(tIntIRQ intIRQSource, U8 edgeDirection)
 		default: break;
 	}
 }
+
+#ifdef INT_SHADOW_IPL
+/**
+* \fn		U8 intShadowInit(void)
+* @brief	Check that the shadow register set is given to the INT_SHADOW_IPL level
+* @note		Only available when INT_SHADOW_IPL is defined
+*		Return STD_EC_NOTFOUND if the core has no shadow set
+*		Return STD_EC_INVALID if the FSRSSEL config bits do not give the shadow set to INT_SHADOW_IPL
+*		Nothing is written: MX3/4/5/6/7 map the set with FSRSSEL, MX1/2 always give it to IPL7 in multi-vector mode
+* @return	U8 errorCode			STD Error Code (STD_EC_SUCCESS if successful)
+*/
+U8 intShadowInit(void)
+{
+	// -- Check that the core has a shadow set -- //
+	if ((_CP0_GET_SRSCTL() & INT_SRSCTL_HSS_MASK) == 0)
+		return STD_EC_NOTFOUND;
+	// ------------------------------------------ //
+
+	// -- Check the priority mapping (fixed to IPL7 on MX1/2, checked at compile time) -- //
+#if CPU_FAMILY != PIC32MX1xx && CPU_FAMILY != PIC32MX2xx
+	if (DEVCFG3bits.FSRSSEL != INT_SHADOW_IPL)
+		return STD_EC_INVALID;			//Config bits give the shadow set to another level
+#endif
+	// ---------------------------------------------------------------------------------- //
+
+	return STD_EC_SUCCESS;
+}
+#endif
+// ############################################## //
+
+
+// ############# Dispatch Functions ############# //
+/**
+* \fn		void _intSetVectorMask(const tIntIRQInfo * infoPtr, U32 mask, U8 state)
+* @brief	Add or remove IRQ bits in the dispatch mask of their vector
+* @note		INTERNAL FUNCTION Do not use directly!!!
+*		Must be called with the interrupts disabled
+* @arg		const tIntIRQInfo * infoPtr	Lookup entry of the IRQ
+* @arg		U32 mask			Bits to add or remove
+* @arg		U8 state			ENABLE to add, DISABLE to remove
+* @return	nothing
+*/
+void _intSetVectorMask(const tIntIRQInfo * infoPtr, U32 mask, U8 state)
+{
+	tIntVectorCtl * vectorPtr = &intVectorCtl[infoPtr->ipcOffset + (infoPtr->ipcShift >> 3)];
+	U8 wu0;
+
+	// -- Find the slot of this reg -- //
+	for (wu0 = 0; wu0 < INT_VECTOR_REG_NB; wu0++)
+		if (vectorPtr->mask[wu0] && (vectorPtr->regIndex[wu0] == infoPtr->regIndex))
+			break;
+	if ((wu0 == INT_VECTOR_REG_NB) && state)
+	{
+		for (wu0 = 0; wu0 < INT_VECTOR_REG_NB; wu0++)
+			if (vectorPtr->mask[wu0] == 0)
+				break;
+	}
+	if (wu0 == INT_VECTOR_REG_NB)
+		return;
+	// ------------------------------- //
+
+	vectorPtr->regIndex[wu0] = infoPtr->regIndex;
+	if (state)
+		vectorPtr->mask[wu0] |= mask;
+	else
+		vectorPtr->mask[wu0] &= ~mask;
+}
+
+/**
+* \fn		U8 intAttachHandler(tIntIRQ intIRQSource, void (*handler)(tIntIRQ, void*), void * contextPtr)
+* @brief	Attach a handler to an IRQ in the dispatch table
+* @note		The handler is called from intDispatch() with the IRQ and the context, only when its flag
+*		and its enable bit are both set, it must clear the flag itself
+*		An IRQ group attach the same handler to every IRQ of the group (ex: IRQ_UART_1)
+*		Use a NULL handler to detach
+*		Return STD_EC_NOTFOUND if the IRQ is not valid for this family
+* @arg		tIntIRQ intIRQSource				IRQ to attach
+* @arg		void (*handler)(tIntIRQ, void*)			Handler to call
+* @arg		void * contextPtr				Context given to the handler
+* @return	U8 errorCode					STD Error Code (STD_EC_SUCCESS if successful)
+*/
+U8 intAttachHandler(tIntIRQ intIRQSource, void (*handler)(tIntIRQ, void*), void * contextPtr)
+{
+	const tIntIRQInfo * infoPtr;
+	U32 maskTemp;
+	U32 intState;
+	U8 irqTemp;
+
+	// -- Handle invalid parameters -- //
+	if ((intIRQSource & 0x7F) >= INT_IRQ_NB)
+		return STD_EC_NOTFOUND;
+	infoPtr = &intIRQInfo[intIRQSource & 0x7F];
+	if (infoPtr->mask == 0)
+		return STD_EC_NOTFOUND;				//Unused IRQ
+	// ------------------------------- //
+
+	if (intIRQSource & BIT7)
+		maskTemp = infoPtr->groupMask;
+	else
+		maskTemp = infoPtr->mask;
+
+	// Disable Global Interrupt
+	intState = intFastDisableGlobal();
+
+	// -- Fill every IRQ of the group -- //
+	do
+	{
+		irqTemp = (infoPtr->regIndex * INT_IRQ_PER_IEC_REG) + __builtin_ctz(maskTemp);
+		intHandlerTable[irqTemp].handler = handler;
+		intHandlerTable[irqTemp].contextPtr = contextPtr;
+		_intSetVectorMask(&intIRQInfo[irqTemp], intIRQInfo[irqTemp].mask, (handler != NULL));
+		maskTemp &= maskTemp - 1;			//Next IRQ
+	}while (maskTemp);
+	// --------------------------------- //
+
+	// Restore Interrupt state
+	intFastRestoreGlobal(intState);
+
+	return STD_EC_SUCCESS;
+}
+
+/**
+* \fn		void intDispatch(U8 vector)
+* @brief	Call the handler of every pending IRQ of a vector
+* @note		Place this in the ISR of the vector (or use intDeclareDispatchISR())
+*		The IFS and IEC reg of the vector are read once, then the pending IRQ are found with a bit scan
+* @arg		U8 vector			Vector number (INT_VEC_x)
+* @return	nothing
+*/
+void intDispatch(U8 vector)
+{
+	tIntVectorCtl * vectorPtr = &intVectorCtl[vector];
+	tIntHandler * handlerPtr;
+	U32 pendingTemp;
+	U8 irqTemp;
+	U8 wu0;
+
+	intProfileEnter(vector);
+
+	for (wu0 = 0; wu0 < INT_VECTOR_REG_NB; wu0++)
+	{
+		if (vectorPtr->mask[wu0] == 0)
+			continue;
+
+		// -- Read the pending IRQ once -- //
+		pendingTemp = (&IFS0)[vectorPtr->regIndex[wu0] * REG_OFFSET_NEXT_32];
+		pendingTemp &= (&IEC0)[vectorPtr->regIndex[wu0] * REG_OFFSET_NEXT_32];
+		pendingTemp &= vectorPtr->mask[wu0];
+		// ------------------------------- //
+
+		// -- Call each pending handler -- //
+		while (pendingTemp)
+		{
+			irqTemp = (vectorPtr->regIndex[wu0] * INT_IRQ_PER_IEC_REG) + __builtin_ctz(pendingTemp);
+			handlerPtr = &intHandlerTable[irqTemp];
+			handlerPtr->handler(irqTemp, handlerPtr->contextPtr);
+			pendingTemp &= pendingTemp - 1;		//Next IRQ
+		}
+		// ------------------------------- //
+	}
+
+	intProfileExit(vector);
+}
+// ############################################## //
+
+
+// ############# Profiler Functions ############# //
+#ifdef INT_PROFILER
+/**
+* \fn		void intProfileSaveLatency(tIntProfileStats * statsPtr)
+* @brief	Add the latency of the entry following the last trigger to the stats
+* @note		Call it with the interrupts disabled
+*		entryTick is only the one following the trigger if a single ISR ended since,
+*		otherwise the sample is dropped
+* @arg		tIntProfileStats * statsPtr	Stats of the vector
+* @return	nothing
+*/
+void intProfileSaveLatency(tIntProfileStats * statsPtr)
+{
+	U32 latencyTemp;
+
+	if ((statsPtr->triggerValid == 0) || (statsPtr->callNb == statsPtr->triggerCallNb))
+		return;						//No entry since the trigger
+
+	if ((statsPtr->callNb - statsPtr->triggerCallNb) == 1)
+	{
+		latencyTemp = statsPtr->entryTick - statsPtr->triggerTick;
+		if (latencyTemp > statsPtr->latencyMax)
+			statsPtr->latencyMax = latencyTemp;
+		statsPtr->latencyAvg += latencyTemp - (statsPtr->latencyAvg >> INT_PROFILER_AVG_SHIFT);
+	}
+	statsPtr->triggerValid = 0;
+}
+
+/**
+* \fn		void intProfileMarkTrigger(vector)
+* @brief	Timestamp the event that will trigger a vector, to measure its entry latency
+* @note		Use it where the interrupt is raised (ex: before setting a software interrupt flag)
+*		The latency is taken from the first entry after the mark, by the next
+*		intProfileMarkTrigger() or intProfileGetStats()
+* @arg		U8 vector			Vector number (INT_VEC_x)
+* @return	nothing
+*/
+void _intProfileMarkTrigger(U8 vector)
+{
+	tIntProfileStats * statsPtr = &intProfileStats[vector];
+	U32 intState;
+
+	// Disable Global Interrupt
+	intState = intFastDisableGlobal();
+
+	intProfileSaveLatency(statsPtr);
+	statsPtr->triggerCallNb = statsPtr->callNb;
+	statsPtr->triggerTick = _CP0_GET_COUNT();
+	statsPtr->triggerValid = 1;
+
+	// Restore Interrupt state
+	intFastRestoreGlobal(intState);
+}
+
+/**
+* \fn		tIntProfileStats * intProfileGetStats(U8 vector)
+* @brief	Update the min, avg and latency of a vector and return its stats
+* @note		Only available when INT_PROFILER is defined, return a NULL pointer for an invalid vector
+*		The avg cover the ISR since the previous call, call it at least every 2^32 core timer tick
+* @arg		U8 vector			Vector number (INT_VEC_x)
+* @return	tIntProfileStats * statsPtr	Stats of the vector
+*/
+tIntProfileStats * intProfileGetStats(U8 vector)
+{
+	tIntProfileStats * statsPtr;
+	U32 sumTemp;
+	U32 callTemp;
+	U32 intState;
+
+	if (vector >= INT_VECTOR_NB)
+		return NULL;
+	statsPtr = &intProfileStats[vector];
+
+	// Disable Global Interrupt
+	intState = intFastDisableGlobal();
+
+	// -- Duration since the previous call -- //
+	sumTemp = statsPtr->durationSum - statsPtr->lastSum;
+	callTemp = statsPtr->callNb - statsPtr->lastCallNb;
+	statsPtr->lastSum = statsPtr->durationSum;
+	statsPtr->lastCallNb = statsPtr->callNb;
+	// -------------------------------------- //
+
+	intProfileSaveLatency(statsPtr);
+
+	// Restore Interrupt state
+	intFastRestoreGlobal(intState);
+
+	// -- Min and avg -- //
+	if (callTemp)
+	{
+		statsPtr->durationAvg = sumTemp / callTemp;
+		if ((statsPtr->durationAvg < statsPtr->durationMin) || (statsPtr->durationMin == 0))
+			statsPtr->durationMin = statsPtr->durationAvg;
+	}
+	// ----------------- //
+
+	return statsPtr;
+}
+
+/**
+* \fn		U8 intProfileGetLoad(void)
+* @brief	Return the part of the CPU time spent in the profiled ISR since the previous call
+* @note		Only available when INT_PROFILER is defined, call it at least every 2^32 core timer tick
+*		A nested ISR is counted in its own vector and in the one it interrupted
+* @return	U8 loadPercent			Interrupt load (in %)
+*/
+U8 intProfileGetLoad(void)
+{
+	U32 nowTick = _CP0_GET_COUNT();
+	U32 sumTemp = 0;
+	U32 busyTemp;
+	U32 spanTemp;
+	U8 wu0;
+
+	// -- Total of every vector -- //
+	// Each durationSum is a single 32bit read, a wrap of the total cancel out in the subtraction
+	for (wu0 = 0; wu0 < INT_VECTOR_NB; wu0++)
+		sumTemp += intProfileStats[wu0].durationSum;
+	// --------------------------- //
+
+	busyTemp = sumTemp - intProfileLoadSum;
+	spanTemp = nowTick - intProfileLoadTick;
+	intProfileLoadSum = sumTemp;
+	intProfileLoadTick = nowTick;
+
+	if (spanTemp == 0)
+		return 0;
+	if (busyTemp >= spanTemp)
+		return 100;					//Nested ISR counted twice
+
+	return (U8)(((U64)busyTemp * 100) / spanTemp);
+}
+
+/**
+* \fn		void intProfileReset(void)
+* @brief	Clear the stats of every vector and restart the load period
+* @note		Only available when INT_PROFILER is defined
+* @return	nothing
+*/
+void intProfileReset(void)
+{
+	U32 intState;
+	U8 wu0;
+
+	// Disable Global Interrupt
+	intState = intFastDisableGlobal();
+
+	for (wu0 = 0; wu0 < INT_VECTOR_NB; wu0++)
+	{
+		intProfileStats[wu0].durationMax = 0;
+		intProfileStats[wu0].durationSum = 0;
+		intProfileStats[wu0].callNb = 0;
+		intProfileStats[wu0].durationMin = 0;
+		intProfileStats[wu0].durationAvg = 0;
+		intProfileStats[wu0].latencyMax = 0;
+		intProfileStats[wu0].latencyAvg = 0;
+		intProfileStats[wu0].lastSum = 0;
+		intProfileStats[wu0].lastCallNb = 0;
+		intProfileStats[wu0].triggerValid = 0;
+	}
+	intProfileLoadSum = 0;
+	intProfileLoadTick = _CP0_GET_COUNT();
+
+	// Restore Interrupt state
+	intFastRestoreGlobal(intState);
+}
+#endif
 // ############################################## //
 
 
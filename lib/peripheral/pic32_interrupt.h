@@ -142,6 +142,8 @@
 	#define INT_VEC_DMA_1				41
 	#define INT_VEC_DMA_2				42
 	#define INT_VEC_DMA_3				43
+
+	#define INT_VECTOR_NB				44
 #elif CPU_FAMILY == PIC32MX3xx || CPU_FAMILY == PIC32MX4xx
 	#define INT_VEC_CORE_TIMER			0
 	#define INT_VEC_CORE_SOFT_0			1
@@ -203,6 +205,8 @@
 	#define INT_VEC_DMA_3				39
 	#define INT_VEC_FLASH_CONTROL_EVENT		44
 	#define INT_VEC_USB				45
+
+	#define INT_VECTOR_NB				46
 #elif CPU_FAMILY == PIC32MX5xxH || CPU_FAMILY == PIC32MX5xxL || CPU_FAMILY == PIC32MX6xx || CPU_FAMILY == PIC32MX7xx
 	#define INT_VEC_CORE_TIMER			0
 	#define INT_VEC_CORE_SOFT_0			1
@@ -313,8 +317,45 @@
 	#define INT_VEC_UART_5_ERR			51
 	#define INT_VEC_UART_5_RX			51
 	#define INT_VEC_UART_5_TX			51
+
+	#define INT_VECTOR_NB				52
 #endif
 // ------------------- //
+
+// -- Dispatch Table -- //
+#define INT_VECTOR_REG_NB			2			//IFS/IEC reg that a vector can span (IC and IC_ERR are not in the same reg on MX5/6/7)
+// -------------------- //
+
+// -- Critical Section -- //
+#ifndef INT_CRIT_IPL
+#define INT_CRIT_IPL				6			//Priority ceiling of critEnter(), the levels above are never masked
+#endif
+#if (INT_CRIT_IPL < 1) || (INT_CRIT_IPL > 6)
+	#error "INT_CRIT_IPL must be between 1 and 6, IPL7 is never masked by a critical section"
+#endif
+#define INT_STATUS_IPL_MASK			0xFC00			//IPL field of the CP0 Status reg
+#define INT_STATUS_IPL_POS			10
+// ---------------------- //
+
+// -- Shadow Register Set -- //
+// Define INT_SHADOW_IPL (1 to 7) in the application to give the shadow register set to this priority level
+// The ISR of this level must be declared with intShadowISR(), on MX3/4/5/6/7 the config file set FSRSSEL to match
+#ifdef INT_SHADOW_IPL
+	#if (INT_SHADOW_IPL < 1) || (INT_SHADOW_IPL > 7)
+		#error "INT_SHADOW_IPL must be a priority level between 1 and 7"
+	#endif
+	#if (CPU_FAMILY == PIC32MX1xx || CPU_FAMILY == PIC32MX2xx) && (INT_SHADOW_IPL != 7)
+		#error "The shadow register set is fixed to priority level 7 on PIC32MX1xx/2xx"
+	#endif
+#endif
+#define INT_SRSCTL_HSS_MASK			0x3C000000		//Highest shadow set number in SRSCTL
+#define INT_SRSCTL_HSS_POS			26
+// ------------------------- //
+
+// -- Profiler -- //
+// Define INT_PROFILER in the application to profile every vector going through intDispatch()
+#define INT_PROFILER_AVG_SHIFT			4			//Weight of a new sample in the latency average (1/16)
+// -------------- //
 // ############################################## //
 
 
@@ -595,6 +636,54 @@ typedef enum
 	IRQ_UART_5 = 0xC9
 }tIntIRQ;
 #endif
+
+// -- IRQ Lookup Entry -- //
+typedef struct
+{
+	U32 mask;					//Bit of the IRQ in its IFS/IEC reg
+	U32 groupMask;					//Bits of the IRQ group starting on this IRQ (same as mask if none)
+	U8 regIndex;					//IFS/IEC reg number (0 for IFS0/IEC0)
+	U8 pos;						//Position of the IRQ bit in its IFS/IEC reg
+	U8 ipcOffset;					//Offset (in U32) of the IPC reg of the vector from IPC0
+	U8 ipcShift;					//Position of the vector field in its IPC reg
+}tIntIRQInfo;
+
+// -- Dispatch Table -- //
+typedef struct
+{
+	void (*handler)(tIntIRQ intIRQSource, void * contextPtr);	//Handler of the IRQ (NULL if none)
+	void * contextPtr;				//Context given to the handler
+}tIntHandler;
+
+typedef struct
+{
+	U32 mask[INT_VECTOR_REG_NB];			//IRQ with a handler in each IFS/IEC reg used by the vector
+	U8 regIndex[INT_VECTOR_REG_NB];			//IFS/IEC reg number of each mask
+	U16 :16;
+}tIntVectorCtl;
+
+// -- Profiler -- //
+typedef struct
+{
+	// -- Updated by the ISR -- //
+	U32 entryTick;					//Core timer at the last entry
+	U32 durationMax;				//Longest ISR (in core timer tick)
+	U32 durationSum;				//Total of the ISR duration, wrap around (in core timer tick)
+	U32 callNb;					//Number of ISR, wrap around
+	// -- Updated by intProfileGetStats() -- //
+	U32 durationMin;				//Shortest average of an intProfileGetStats() period (in core timer tick)
+	U32 durationAvg;				//Average ISR duration of the last period with a call (in core timer tick)
+	U32 latencyMax;					//Longest delay between the trigger and the ISR entry (in core timer tick)
+	U32 latencyAvg;					//Moving average of the entry latency (in core timer tick << INT_PROFILER_AVG_SHIFT)
+	U32 lastSum;					//durationSum at the previous intProfileGetStats()
+	U32 lastCallNb;					//callNb at the previous intProfileGetStats()
+	// -- Updated by intProfileMarkTrigger() -- //
+	U32 triggerTick;				//Core timer at the last trigger
+	U32 triggerCallNb;				//callNb at the last trigger
+	U8 triggerValid;				//The entry following triggerTick is not measured yet
+	U8 :8;
+	U16 :16;
+}tIntProfileStats;
 // ---------------- //
 // ############################################## //
 
@@ -783,7 +872,7 @@ typedef enum
 * @arg		tIntIRQ intIRQSource		Which interrupt to init
 * @return	nothing
 */
-#define intInit(intIRQSource)				_intSetReg((U32*)&IFS0,intIRQSource,DISABLE); _intSetReg((U32*)&IEC0,intIRQSource,0x7)
+#define intInit(intIRQSource)				_intSetReg((U32*)&IFS0,intIRQSource,DISABLE); _intSetReg((U32*)&IEC0,intIRQSource,0xFF)
 
 /**
 * \fn		void intSetState(intIRQSource, state)
@@ -869,6 +958,201 @@ U8 intGetSubPriority(tIntIRQ intIRQSource);
 * @return	nothing
 */
 void intSetExternalEdge(tIntIRQ intIRQSource, U8 edgeDirection);
+
+/**
+* \fn		intShadowISR(vectorNb, isrName)
+* @brief	Declare an ISR running on the shadow register set (IPLnSRS) at the INT_SHADOW_IPL level
+* @note		The prologue skip the save/restore of the general purpose registers
+*		Only available when INT_SHADOW_IPL is defined, the priority of the vector must be INT_SHADOW_IPL
+*		(ex: intShadowISR(INT_VEC_TIMER_1, realTimeISR) {rtISR(); intFastClearFlag(INT_TIMER_1);})
+* @arg		vectorNb			Vector number (INT_VEC_x)
+* @arg		isrName				Name of the ISR function
+* @return	nothing
+*/
+#define intShadowISR(vectorNb, isrName)			void __ISR(vectorNb, CONCAT(CONCAT(IPL,INT_SHADOW_IPL),SRS)) isrName(void)
+
+/**
+* \fn		U8 intShadowInit(void)
+* @brief	Check that the shadow register set is given to the INT_SHADOW_IPL level
+* @note		Only available when INT_SHADOW_IPL is defined
+*		Return STD_EC_NOTFOUND if the core has no shadow set
+*		Return STD_EC_INVALID if the FSRSSEL config bits do not give the shadow set to INT_SHADOW_IPL
+*		Nothing is written: MX3/4/5/6/7 map the set with FSRSSEL, MX1/2 always give it to IPL7 in multi-vector mode
+* @return	U8 errorCode			STD Error Code (STD_EC_SUCCESS if successful)
+*/
+U8 intShadowInit(void);
+
+/**
+* \fn		U32 critEnter(void)
+* @brief	Enter a critical section by raising the CPU priority to the INT_CRIT_IPL ceiling
+* @note		The priority is never lowered, so critical sections can be nested (also inside an ISR)
+*		The levels above INT_CRIT_IPL (at least IPL7) are never masked, they must not share data with a critical section
+*		Use it like intFastDisableGlobal(): U32 critState = critEnter(); ... critExit(critState);
+*		Inlined, it is a read of Status, a compare and a write of Status
+* @return	U32 critState			Previous CPU priority (to give to critExit())
+*/
+static inline U32 critEnter(void)
+{
+	U32 statusTemp = _CP0_GET_STATUS();
+
+	// -- Raise the priority, never lower it -- //
+	if ((statusTemp & INT_STATUS_IPL_MASK) < (INT_CRIT_IPL << INT_STATUS_IPL_POS))
+		_CP0_SET_STATUS((statusTemp & ~INT_STATUS_IPL_MASK) | (INT_CRIT_IPL << INT_STATUS_IPL_POS));
+	// ---------------------------------------- //
+
+	return (statusTemp & INT_STATUS_IPL_MASK);
+}
+
+/**
+* \fn		void critExit(U32 critState)
+* @brief	Leave a critical section by restoring the CPU priority saved by critEnter()
+* @note
+* @arg		U32 critState			Value returned by the matching critEnter()
+* @return	nothing
+*/
+static inline void critExit(U32 critState)
+{
+	_CP0_SET_STATUS((_CP0_GET_STATUS() & ~INT_STATUS_IPL_MASK) | critState);
+}
+// ############################################## //
+
+
+// ############# Dispatch Functions ############# //
+/**
+* \fn		void intDeclareDispatchISR(intSource, ipl)
+* @brief	Declare the ISR of a vector that call intDispatch()
+* @note		Use it at file scope in the application, once per vector used with intAttachHandler()
+*		(ex: intDeclareDispatchISR(UART_1, IPL5SOFT) then intFastSetPriority(INT_UART_1, 5))
+*		The priority of the vector must match the ipl
+* @arg		intSource			Name of the interrupt of the vector without INT_ (ex: UART_1)
+* @arg		ipl				Priority level of the ISR (ex: IPL5SOFT)
+* @return	nothing
+*/
+#define intDeclareDispatchISR(intSource, ipl)		void __ISR(CONCAT(INT_VEC_,intSource), ipl) CONCAT(intDispatchISR_,intSource)(void) {intDispatch(CONCAT(INT_VEC_,intSource));}
+
+/**
+* \fn		void intDeclareShadowDispatchISR(intSource)
+* @brief	Declare the ISR of a vector that call intDispatch() on the shadow register set
+* @note		Only available when INT_SHADOW_IPL is defined, the priority of the vector must be INT_SHADOW_IPL
+* @arg		intSource			Name of the interrupt of the vector without INT_ (ex: UART_1)
+* @return	nothing
+*/
+#define intDeclareShadowDispatchISR(intSource)		intShadowISR(CONCAT(INT_VEC_,intSource), CONCAT(intDispatchISR_,intSource)) {intDispatch(CONCAT(INT_VEC_,intSource));}
+
+/**
+* \fn		U8 intAttachHandler(tIntIRQ intIRQSource, void (*handler)(tIntIRQ, void*), void * contextPtr)
+* @brief	Attach a handler to an IRQ in the dispatch table
+* @note		The handler is called from intDispatch() with the IRQ and the context, only when its flag
+*		and its enable bit are both set, it must clear the flag itself
+*		An IRQ group attach the same handler to every IRQ of the group (ex: IRQ_UART_1)
+*		Use a NULL handler to detach
+*		Return STD_EC_NOTFOUND if the IRQ is not valid for this family
+* @arg		tIntIRQ intIRQSource				IRQ to attach
+* @arg		void (*handler)(tIntIRQ, void*)			Handler to call
+* @arg		void * contextPtr				Context given to the handler
+* @return	U8 errorCode					STD Error Code (STD_EC_SUCCESS if successful)
+*/
+U8 intAttachHandler(tIntIRQ intIRQSource, void (*handler)(tIntIRQ, void*), void * contextPtr);
+
+/**
+* \fn		void intDispatch(U8 vector)
+* @brief	Call the handler of every pending IRQ of a vector
+* @note		Place this in the ISR of the vector (or use intDeclareDispatchISR())
+*		The IFS and IEC reg of the vector are read once, then the pending IRQ are found with a bit scan
+* @arg		U8 vector			Vector number (INT_VEC_x)
+* @return	nothing
+*/
+void intDispatch(U8 vector);
+// ############################################## //
+
+
+// ############# Profiler Functions ############# //
+// Every profiler macro compile to nothing when INT_PROFILER is not defined
+#ifdef INT_PROFILER
+	#define intProfileEnter(vector)			_intProfileEnter(vector)
+	#define intProfileExit(vector)			_intProfileExit(vector)
+	#define intProfileMarkTrigger(vector)		_intProfileMarkTrigger(vector)
+#else
+	#define intProfileEnter(vector)
+	#define intProfileExit(vector)
+	#define intProfileMarkTrigger(vector)
+#endif
+
+#ifdef INT_PROFILER
+extern tIntProfileStats intProfileStats[INT_VECTOR_NB];
+
+/**
+* \fn		void intProfileEnter(vector)
+* @brief	Timestamp the entry of an ISR
+* @note		Already done by intDispatch(), use it first in a hand-written ISR
+*		Inlined, the enter/exit pair is under 20 instructions
+* @arg		U8 vector			Vector number (INT_VEC_x)
+* @return	nothing
+*/
+static inline void _intProfileEnter(U8 vector)
+{
+	intProfileStats[vector].entryTick = _CP0_GET_COUNT();
+}
+
+/**
+* \fn		void intProfileExit(vector)
+* @brief	Timestamp the exit of an ISR and add its duration to the stats of its vector
+* @note		Already done by intDispatch(), use it last in a hand-written ISR
+*		The duration include the time spent in the nested ISR
+*		Only the max, the total and the count are kept here, the rest is computed by
+*		intProfileGetStats() and intProfileGetLoad()
+* @arg		U8 vector			Vector number (INT_VEC_x)
+* @return	nothing
+*/
+static inline void _intProfileExit(U8 vector)
+{
+	tIntProfileStats * statsPtr = &intProfileStats[vector];
+	U32 durationTemp = _CP0_GET_COUNT() - statsPtr->entryTick;
+
+	if (durationTemp > statsPtr->durationMax)
+		statsPtr->durationMax = durationTemp;
+	statsPtr->durationSum += durationTemp;
+	statsPtr->callNb++;
+}
+
+/**
+* \fn		void intProfileMarkTrigger(vector)
+* @brief	Timestamp the event that will trigger a vector, to measure its entry latency
+* @note		Use it where the interrupt is raised (ex: before setting a software interrupt flag)
+*		The latency is taken from the first entry after the mark, by the next
+*		intProfileMarkTrigger() or intProfileGetStats()
+* @arg		U8 vector			Vector number (INT_VEC_x)
+* @return	nothing
+*/
+void _intProfileMarkTrigger(U8 vector);
+#endif
+
+/**
+* \fn		tIntProfileStats * intProfileGetStats(U8 vector)
+* @brief	Update the min, avg and latency of a vector and return its stats
+* @note		Only available when INT_PROFILER is defined, return a NULL pointer for an invalid vector
+*		The avg cover the ISR since the previous call, call it at least every 2^32 core timer tick
+* @arg		U8 vector			Vector number (INT_VEC_x)
+* @return	tIntProfileStats * statsPtr	Stats of the vector
+*/
+tIntProfileStats * intProfileGetStats(U8 vector);
+
+/**
+* \fn		U8 intProfileGetLoad(void)
+* @brief	Return the part of the CPU time spent in the profiled ISR since the previous call
+* @note		Only available when INT_PROFILER is defined, call it at least every 2^32 core timer tick
+*		A nested ISR is counted in its own vector and in the one it interrupted
+* @return	U8 loadPercent			Interrupt load (in %)
+*/
+U8 intProfileGetLoad(void);
+
+/**
+* \fn		void intProfileReset(void)
+* @brief	Clear the stats of every vector and restart the load period
+* @note		Only available when INT_PROFILER is defined
+* @return	nothing
+*/
+void intProfileReset(void);
 // ############################################## //
 
 
@@ -19,7 +19,7 @@
 //Config
 tOCConfig ocConfig[OC_MAX_PORT];
 U32 pwmPeriodTime[OC_MAX_PORT];
-F32 pwmCntPeriodTime[OC_MAX_PORT];
+U32 pwmCntFreq[OC_MAX_PORT];				//Count freq of the OC timer (in Hz)
 
 //Reg pointers
 tOCxCON * pOCxCON = NULL;				//Control reg pointer
@@ -145,20 +145,25 @@ U8 ocStart(U8 ocPort)
 * \fn		void pwmSetPeriod(U8 ocPort, U32 newPeriod)
 * @brief	Set the correct timer's period for the specified OC port
 * @note		Will not check if any other OC port is using the same timer
-*		Will update the pwmPeriodTime and pwmCntPeriodTime value
+*		Will update the pwmPeriodTime and pwmCntFreq value (only if the period can be reached)
+*		Integer only, the period is converted in PBCLK tick for timerSetPeriodTick()
 * @arg		U8 ocPort				Hardware OC ID
 * @arg		U32 newPeriod				New period (in s)
 * @return	nothing
 */
 void pwmSetPeriod(U8 ocPort, U32 newPeriod)
 {
-	// Set the new period value
-	timerSetOverflow((ocConfig[ocPort].timer)+1, newPeriod);
+	U8 timerPort = (ocConfig[ocPort].timer)+1;
+	U64 tickNb = ((((U64)newPeriod) * clockGetPBCLK()) + 500000) / 1000000;	//Period in PBCLK tick (rounded)
 
-	// -- Update the Time values -- //
-	pwmPeriodTime[ocPort] = newPeriod;
-	pwmCntPeriodTime[ocPort] = timerGetCntPeriod((ocConfig[ocPort].timer)+1);
-	// ---------------------------- //
+	// Set the new period value
+	if (timerSetPeriodTick(timerPort, tickNb, NULL) == STD_EC_SUCCESS)
+	{
+		// -- Update the Time values -- //
+		pwmPeriodTime[ocPort] = newPeriod;
+		pwmCntFreq[ocPort] = timerGetClock(timerPort);
+		// ---------------------------- //
+	}
 }
 
 /**
@@ -177,7 +182,7 @@ U32 pwmGetPeriod(U8 ocPort)
 * \fn		U8 pwmSetTon(U8 ocPort, U32 timeON)
 * @brief	Set the ON time for a specified OC port
 * @note		Will not update if the ON time is less than the period time (and will return STD_EC_TOOLARGE)
-*		ATTENTION! This function use floating point math for better precision
+*		Integer only, rounded to the nearest timer count
 * @arg		U8 ocPort				Hardware OC ID
 * @arg		U32 timeON				ON time desired (in s)
 * @return	U8 errorCode				STD Error Code (STD_EC_SUCCESS if successful)
@@ -193,7 +198,7 @@ U8 pwmSetTon(U8 ocPort, U32 timeON)
 	{
 		// -- Only change Ton if the period is large enough -- //
 		if (timeON <= pwmPeriodTime[ocPort])
-			*pOCxRS = (U32)(((F32)timeON) / pwmCntPeriodTime[ocPort]);
+			*pOCxRS = (U32)(((((U64)timeON) * pwmCntFreq[ocPort]) + 500000) / 1000000);
 		// --------------------------------------------------- //
 		else
 			errorCode = STD_EC_TOOLARGE;
@@ -206,7 +211,8 @@ U8 pwmSetTon(U8 ocPort, U32 timeON)
 * \fn		void pwmSetDuty(U8 ocPort, U32 numerator, U32 denominator)
 * @brief	Set the duty of the specified OC port
 * @note		Use the numerator and the denominator as a fraction representing the duty (ex: pwmSetDuty(OC_1,1,2) will set to 50%)
-*		This function use integer, for more precision use the OCxRS register directly
+*		Integer only (64bit), the duty is a fraction of PR+1 so 1/1 is always ON
+*		Nothing is changed if the denominator is 0 or smaller than the numerator
 * @arg		U8 ocPort				Hardware OC ID
 * @arg		U32 numerator				Numerator of the duty
 * @arg		U32 denominator				Denominator of the duty
@@ -214,19 +220,18 @@ U8 pwmSetTon(U8 ocPort, U32 timeON)
 */
 void pwmSetDuty(U8 ocPort, U32 numerator, U32 denominator)
 {
-	U32 tempPR = timerGetPR((ocConfig[ocPort].timer)+1);
+	U64 tempCnt = ((U64)timerGetPR((ocConfig[ocPort].timer)+1)) + 1;	//Number of count in a period
 
 	if (ocSelectPort(ocPort) == STD_EC_SUCCESS)
 	{
-		// Handle division by 0
-		if (denominator != 0)
+		// Handle division by 0 and a duty over 100%
+		if ((denominator != 0) && (numerator <= denominator))
 		{
-			//Handle error from integer inaccuracy
-			if (denominator <= tempPR)
-			{
-				// Compute and set the new value
-				*pOCxRS = (tempPR*numerator)/denominator;
-			}
+			// Compute and set the new value
+			tempCnt = (tempCnt * numerator) / denominator;
+			if (tempCnt > U32_MAX)				//Full 32bit period, as close as possible
+				tempCnt = U32_MAX;
+			*pOCxRS = (U32)tempCnt;
 		}
 	}
 }
@@ -161,7 +161,8 @@ U8 ocStart(U8 ocPort);
 * \fn		void pwmSetPeriod(U8 ocPort, U32 newPeriod)
 * @brief	Set the correct timer's period for the specified OC port
 * @note		Will not check if any other OC port is using the same timer
-*		Will update the pwmPeriodTime and pwmCntPeriodTime value
+*		Will update the pwmPeriodTime and pwmCntFreq value (only if the period can be reached)
+*		Integer only, the period is converted in PBCLK tick for timerSetPeriodTick()
 * @arg		U8 ocPort				Hardware OC ID
 * @arg		U32 newPeriod				New period (in s)
 * @return	nothing
@@ -181,7 +182,7 @@ U32 pwmGetPeriod(U8 ocPort);
 * \fn		U8 pwmSetTon(U8 ocPort, U32 timeON)
 * @brief	Set the ON time for a specified OC port
 * @note		Will not update if the ON time is less than the period time (and will return STD_EC_TOOLARGE)
-*		ATTENTION! This function use floating point math for better precision
+*		Integer only, rounded to the nearest timer count
 * @arg		U8 ocPort				Hardware OC ID
 * @arg		U32 timeON				ON time desired (in s)
 * @return	U8 errorCode				STD Error Code (STD_EC_SUCCESS if successful)
@@ -192,7 +193,8 @@ U8 pwmSetTon(U8 ocPort, U32 timeON);
 * \fn		void pwmSetDuty(U8 ocPort, U32 numerator, U32 denominator)
 * @brief	Set the duty of the specified OC port
 * @note		Use the numerator and the denominator as a fraction representing the duty (ex: pwmSetDuty(OC_1,1,2) will set to 50%)
-*		This function use integer, for more precision use the OCxRS register directly
+*		Integer only (64bit), the duty is a fraction of PR+1 so 1/1 is always ON
+*		Nothing is changed if the denominator is 0 or smaller than the numerator
 * @arg		U8 ocPort				Hardware OC ID
 * @arg		U32 numerator				Numerator of the duty
 * @arg		U32 denominator				Denominator of the duty
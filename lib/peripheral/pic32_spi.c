@@ -4,7 +4,6 @@
 
  @version	0.1
  @note
- @todo		function pointer for different data width transfer (in the spiMasterEngine)
 
  @date		February 15th 2012
  @author	Laurence DV
@@ -16,12 +15,27 @@
 
 
 // ################## Variables ################# //
-extern U32 heapAvailable;
+extern U32 globalDump;
 
 //Control tables
 tSPIConfig spiConfig[SPI_MAX_PORT];
 tSPIStatus spiStatus[SPI_MAX_PORT];
 
+//Bus parameters
+U32 spiPortBRG[SPI_MAX_PORT];				//BRG of the port (spiStart() or spiSetBaudRate()), used by slave without their own bus
+U32 spiPortCON[SPI_MAX_PORT];				//SPI_BUS_CON_MASK bits of the port config, used by slave without their own bus
+U32 spiAppliedBRG[SPI_MAX_PORT];			//BRG actually in the SPIxBRG reg
+U32 spiAppliedCON[SPI_MAX_PORT];			//SPI_BUS_CON_MASK bits actually in the SPIxCON reg
+tSPISlaveControl * spiLastSlave[SPI_MAX_PORT];		//Last slave the bus was set for
+tSPIBusStats spiBusStats[SPI_MAX_PORT];
+
+//FIFO kernels
+void (*spiFillKernel[SPI_MAX_PORT])(volatile U32 * bufPtr, tSPITransaction * transactionPtr, U32 transferNb);
+void (*spiDrainKernel[SPI_MAX_PORT])(volatile U32 * bufPtr, tSPITransaction * transactionPtr, U32 transferNb);
+
+//Slave engine
+tSPISlaveEngine spiSlaveEngine[SPI_MAX_PORT];
+
 //Reg pointers
 tSPIxCON * pSPIxCON = NULL;
 tSPIxCON2 * pSPIxCON2 = NULL;
@@ -30,9 +44,125 @@ U32 * pSPIxBRG = NULL;
 U32 * pSPIxBUF = NULL;
 
 //Transaction control
-tRBufCtl * spiTransactionList[SPI_MAX_TRANSACTION];
+tSPITransaction * spiPendingHead[SPI_MAX_PORT][SPI_PRIORITY_NB];	//First pending transaction of each priority
+tSPITransaction * spiPendingTail[SPI_MAX_PORT][SPI_PRIORITY_NB];	//Last pending transaction of each priority
+U32 spiPendingMask[SPI_MAX_PORT];					//Priority with pending transaction (1 bit per priority)
+tSPITransaction * spiDoneHead = NULL;					//First transaction waiting for its deferred callback
+tSPITransaction * spiDoneTail = NULL;					//Last transaction waiting for its deferred callback
 tSPITransaction * spiCurrentTransaction[SPI_MAX_PORT];
 tSPITransactionState spiFSMState[SPI_MAX_PORT];
+
+//Structure pools
+poolDeclareStorage(spiSlaveStorage, tSPISlaveControl, SPI_SLAVE_POOL_SIZE);
+poolDeclareStorage(spiTransactionStorage, tSPITransaction, SPI_TRANSACTION_POOL_SIZE);
+tPoolCtl spiSlavePool;
+tPoolCtl spiTransactionPool;
+U8 spiPoolReady = 0;
+// ############################################## //
+
+
+// ############### FIFO Kernels ############### //
+// Unrolled operation for a FIFO depth (fall through from the number of transfer to do)
+#define SPI_UNROLL_4(op)	case 4: op; case 3: op; case 2: op; case 1: op;
+#define SPI_UNROLL_8(op)	case 8: op; case 7: op; case 6: op; case 5: op; SPI_UNROLL_4(op)
+#define SPI_UNROLL_16(op)	case 16: op; case 15: op; case 14: op; case 13: op; case 12: op; case 11: op; case 10: op; case 9: op; SPI_UNROLL_8(op)
+
+/**
+* \fn		void spiFillxBIT(volatile U32 * bufPtr, tSPITransaction * transactionPtr, U32 transferNb)
+* @brief	Load transferNb data from the transaction TX pointer into the TX FIFO and advance the pointer
+* @note		Generated for 8, 16 and 32 bit width, unrolled to the FIFO depth of that width
+*			transferNb must not exceed the FIFO depth (16, 8 or 4)
+* @arg		volatile U32 * bufPtr				SPIxBUF reg of the port
+* @arg		tSPITransaction * transactionPtr		Transaction to load from
+* @arg		U32 transferNb					Number of data to load
+* @return	nothing
+*/
+#define SPI_FILL_KERNEL(width, type, unroll)								\
+void spiFill##width##BIT(volatile U32 * bufPtr, tSPITransaction * transactionPtr, U32 transferNb)	\
+{													\
+	type * dataPtr = (type *)(transactionPtr->pTX);							\
+													\
+	transactionPtr->pTX = dataPtr + transferNb;							\
+	switch (transferNb)										\
+	{												\
+		unroll(*bufPtr = *dataPtr++)								\
+	}												\
+}
+
+/**
+* \fn		void spiDrainxBIT(volatile U32 * bufPtr, tSPITransaction * transactionPtr, U32 transferNb)
+* @brief	Save transferNb data from the RX FIFO to the transaction RX pointer and advance the pointer
+* @note		Generated for 8, 16 and 32 bit width, unrolled to the FIFO depth of that width
+*			transferNb must not exceed the FIFO depth (16, 8 or 4)
+* @arg		volatile U32 * bufPtr				SPIxBUF reg of the port
+* @arg		tSPITransaction * transactionPtr		Transaction to save to
+* @arg		U32 transferNb					Number of data to save
+* @return	nothing
+*/
+#define SPI_DRAIN_KERNEL(width, type, unroll)								\
+void spiDrain##width##BIT(volatile U32 * bufPtr, tSPITransaction * transactionPtr, U32 transferNb)	\
+{													\
+	type * dataPtr = (type *)(transactionPtr->pRX);							\
+													\
+	transactionPtr->pRX = dataPtr + transferNb;							\
+	switch (transferNb)										\
+	{												\
+		unroll(*dataPtr++ = *bufPtr)								\
+	}												\
+}
+
+/**
+* \fn		void spiFillConst(volatile U32 * bufPtr, U32 value, U32 transferNb)
+* @brief	Load transferNb copy of a value into the TX FIFO
+* @note		Used for the filler of read part, unrolled to the deepest FIFO (16 level)
+* @arg		volatile U32 * bufPtr				SPIxBUF reg of the port
+* @arg		U32 value					Value to send
+* @arg		U32 transferNb					Number of data to load
+* @return	nothing
+*/
+void spiFillConst(volatile U32 * bufPtr, U32 value, U32 transferNb)
+{
+	switch (transferNb)
+	{
+		SPI_UNROLL_16(*bufPtr = value)
+	}
+}
+
+/**
+* \fn		void spiDrainDiscard(volatile U32 * bufPtr, U32 transferNb)
+* @brief	Read and discard transferNb data from the RX FIFO
+* @note		Used for the write part of a transaction, unrolled to the deepest FIFO (16 level)
+* @arg		volatile U32 * bufPtr				SPIxBUF reg of the port
+* @arg		U32 transferNb					Number of data to discard
+* @return	nothing
+*/
+void spiDrainDiscard(volatile U32 * bufPtr, U32 transferNb)
+{
+	switch (transferNb)
+	{
+		SPI_UNROLL_16(globalDump = *bufPtr)
+	}
+}
+
+SPI_FILL_KERNEL(8, U8, SPI_UNROLL_16)
+SPI_FILL_KERNEL(16, U16, SPI_UNROLL_8)
+SPI_FILL_KERNEL(32, U32, SPI_UNROLL_4)
+SPI_DRAIN_KERNEL(8, U8, SPI_UNROLL_16)
+SPI_DRAIN_KERNEL(16, U16, SPI_UNROLL_8)
+SPI_DRAIN_KERNEL(32, U32, SPI_UNROLL_4)
+
+//Kernels indexed by the SPIxCON MODE bits
+void (* const spiFillTable[4])(volatile U32 * bufPtr, tSPITransaction * transactionPtr, U32 transferNb) = {spiFill8BIT, spiFill16BIT, spiFill32BIT, spiFill32BIT};
+void (* const spiDrainTable[4])(volatile U32 * bufPtr, tSPITransaction * transactionPtr, U32 transferNb) = {spiDrain8BIT, spiDrain16BIT, spiDrain32BIT, spiDrain32BIT};
+
+// Kernel measurement, compile to nothing when SPI_KERNEL_STATS is not defined
+#ifdef SPI_KERNEL_STATS
+#define _spiKernelStatStart()		kernelTick = _CP0_GET_COUNT()
+#define _spiKernelStatStop(spiPort)	spiKernelStat(spiPort, kernelTick)
+#else
+#define _spiKernelStatStart()
+#define _spiKernelStatStop(spiPort)
+#endif
 // ############################################## //
 
 
@@ -66,6 +196,301 @@ U8 spiSelectPort(U8 spiPort)
 	}
 	return STD_EC_SUCCESS;
 }
+
+/**
+* \fn		void spiInitPool(void)
+* @brief	Link the slave and transaction pools on their static storage
+* @note		Called on the first allocation, will do nothing if the pools are already initialised
+* @arg		nothing
+* @return	nothing
+*/
+void spiInitPool(void)
+{
+	U32 intState;
+
+	// Disable Global Interrupt
+	intState = intFastDisableGlobal();
+
+	if (spiPoolReady == 0)
+	{
+		poolInit(&spiSlavePool, spiSlaveStorage, sizeof(tSPISlaveControl), SPI_SLAVE_POOL_SIZE);
+		poolInit(&spiTransactionPool, spiTransactionStorage, sizeof(tSPITransaction), SPI_TRANSACTION_POOL_SIZE);
+		spiPoolReady = 1;
+	}
+
+	// Restore Interrupt state
+	intFastRestoreGlobal(intState);
+}
+
+/**
+* \fn		U32 spiComputeBRG(U32 baudRate)
+* @brief	Compute the BRG value giving the nearest baudrate lower or equal to the desired one
+* @note		Fsck = PBCLK / (2 * (BRG+1)), use the actual PBCLK freq
+* @arg		U32 baudRate					Desired baudrate (in bps)
+* @return	U32 BRG						Value for the SPIxBRG reg
+*/
+U32 spiComputeBRG(U32 baudRate)
+{
+	U32 divider = baudRate<<1;
+	U32 BRG = (clockGetPBCLK() + divider - 1) / divider;	//Round up the divider
+
+	if (BRG)
+		BRG--;
+	return BRG;
+}
+
+/**
+* \fn		void spiWaitCoreTick(U32 tickNb)
+* @brief	Busy-wait a number of core timer tick
+* @note		Used for the SS setup and hold delays, a tick is 2 SYSCLK
+*			Run in the SPI ISR, the delays are limited by SPI_SS_DELAY_MAX_NS
+* @arg		U32 tickNb					Number of tick to wait
+* @return	nothing
+*/
+void spiWaitCoreTick(U32 tickNb)
+{
+	U32 startTick = _CP0_GET_COUNT();
+
+	while ((_CP0_GET_COUNT() - startTick) < tickNb);
+}
+
+/**
+* \fn		void spiApplyBus(U8 spiPort, U32 BRG, U32 CON)
+* @brief	Reprogram the selected SPI port with the bus parameters of a slave
+* @note		Register pointers must already point to the port
+*			Changed SPIxCON bits are toggled in a single INV write while the module is off
+* @arg		U8 spiPort					Hardware SPI ID
+* @arg		U32 BRG						SPIxBRG value to apply
+* @arg		U32 CON						SPIxCON bits to apply (only SPI_BUS_CON_MASK bits)
+* @return	nothing
+*/
+void spiApplyBus(U8 spiPort, U32 BRG, U32 CON)
+{
+	U32 startTick = _CP0_GET_COUNT();
+	U32 cycleNb;
+
+	// -- Reprogram the module -- //
+	((U32*)pSPIxCON)[REG_OFFSET_CLR_32] = BIT15;		//Stop the SPI
+	*pSPIxBRG = BRG;
+	((U32*)pSPIxCON)[REG_OFFSET_INV_32] = (spiAppliedCON[spiPort] ^ CON);
+	((U32*)pSPIxCON)[REG_OFFSET_SET_32] = BIT15;		//Start the SPI
+	// -------------------------- //
+
+	// -- Update the cache -- //
+	spiAppliedBRG[spiPort] = BRG;
+	spiAppliedCON[spiPort] = CON;
+	spiStatus[spiPort].FIFOlevel = 16>>((CON>>10) & 0x3);
+	// ---------------------- //
+
+	// -- Measure the cost -- //
+	cycleNb = (_CP0_GET_COUNT() - startTick)<<1;
+	spiBusStats[spiPort].reconfigNb++;
+	spiBusStats[spiPort].reconfigCycleLast = cycleNb;
+	if (cycleNb > spiBusStats[spiPort].reconfigCycleMax)
+		spiBusStats[spiPort].reconfigCycleMax = cycleNb;
+	// ---------------------- //
+}
+
+#ifdef SPI_KERNEL_STATS
+/**
+* \fn		void spiKernelStat(U8 spiPort, U32 startTick)
+* @brief	Save the duration of a FIFO kernel call in the bus statistics
+* @note		Only compiled when SPI_KERNEL_STATS is defined
+* @arg		U8 spiPort					Hardware SPI ID
+* @arg		U32 startTick					Core timer at the start of the kernel call
+* @return	nothing
+*/
+void spiKernelStat(U8 spiPort, U32 startTick)
+{
+	U32 cycleNb = (_CP0_GET_COUNT() - startTick)<<1;
+
+	spiBusStats[spiPort].kernelNb++;
+	spiBusStats[spiPort].kernelCycleTotal += cycleNb;
+	if (cycleNb > spiBusStats[spiPort].kernelCycleMax)
+		spiBusStats[spiPort].kernelCycleMax = cycleNb;
+}
+#endif
+
+/**
+* \fn		void spiSlaveDrain(U8 spiPort)
+* @brief	Save the content of the RX FIFO in the request buffer of the slave engine
+* @note		Register pointers must already point to the port
+*			Byte that do not fit in the request buffer are discarded and counted
+* @arg		U8 spiPort						Hardware SPI ID
+* @return	nothing
+*/
+void spiSlaveDrain(U8 spiPort)
+{
+	tSPISlaveEngine * enginePtr = &spiSlaveEngine[spiPort];
+	U16 rxNb = pSPIxSTAT->RXBUFELM;
+	U16 saveNb = rBufGetFreeSpace(enginePtr->requestBuf);
+
+	enginePtr->frameByteNb += rxNb;
+
+	// -- Save what fit in the buffer -- //
+	if (saveNb > rxNb)
+		saveNb = rxNb;
+	if (saveNb)
+		rBufPushU8(enginePtr->requestBuf, (U8*)pSPIxBUF, saveNb, RBUF_FIXED_PTR);
+	// --------------------------------- //
+
+	// -- Discard the rest -- //
+	rxNb -= saveNb;
+	enginePtr->stats.overflowNb += rxNb;
+	while (rxNb--)
+		globalDump = *pSPIxBUF;
+	// ---------------------- //
+}
+
+/**
+* \fn		void spiSlaveFill(U8 spiPort)
+* @brief	Load the TX FIFO from the response buffer of the slave engine
+* @note		Register pointers must already point to the port
+*			In a frame, once the response ran empty the free FIFO level are completed with the filler byte
+*			until the end of the frame, so a late response is never sent in the middle of the filler
+* @arg		U8 spiPort						Hardware SPI ID
+* @return	nothing
+*/
+void spiSlaveFill(U8 spiPort)
+{
+	tSPISlaveEngine * enginePtr = &spiSlaveEngine[spiPort];
+	U16 spaceNb = spiStatus[spiPort].FIFOlevel - pSPIxSTAT->TXBUFELM;
+	U16 dataNb = 0;
+
+	// -- Load the response -- //
+	if (enginePtr->padding == 0)
+	{
+		dataNb = rBufGetUsedSpace(enginePtr->responseBuf);
+		if (dataNb > spaceNb)
+			dataNb = spaceNb;
+		if (dataNb)
+			rBufPullU8(enginePtr->responseBuf, (U8*)pSPIxBUF, dataNb, RBUF_FIXED_PTR);
+	}
+	// ----------------------- //
+
+	// -- Pad the end of the frame with the filler -- //
+	spaceNb -= dataNb;
+	if ((enginePtr->inFrame) && (spaceNb))
+	{
+		if (enginePtr->padding == 0)
+		{
+			enginePtr->padding = 1;
+			enginePtr->stats.underrunNb++;
+		}
+		while (spaceNb--)
+			*pSPIxBUF = enginePtr->filler;
+	}
+	// ---------------------------------------------- //
+}
+
+/**
+* \fn		tSPITransaction * spiPopTransaction(U8 spiPort)
+* @brief	Unlink and return the highest priority pending transaction of a port
+* @note		Return a NULL pointer if no transaction is pending
+*			The highest priority is found with a single count leading zero on the pending mask
+* @arg		U8 spiPort						Hardware SPI ID
+* @return	tSPITransaction * tempSPITransactionPtr		Pointer to the transaction control structure
+*/
+tSPITransaction * spiPopTransaction(U8 spiPort)
+{
+	tSPITransaction * tempSPITransactionPtr = NULL;
+	U32 intState;
+	U8 priority;
+
+	// Disable Global Interrupt
+	intState = intFastDisableGlobal();
+
+	if (spiPendingMask[spiPort])
+	{
+		// -- Unlink the head of the highest priority list -- //
+		priority = 31 - __builtin_clz(spiPendingMask[spiPort]);
+		tempSPITransactionPtr = spiPendingHead[spiPort][priority];
+		spiPendingHead[spiPort][priority] = tempSPITransactionPtr->next;
+		if (spiPendingHead[spiPort][priority] == NULL)
+			spiPendingMask[spiPort] &= ~(1<<priority);		//This list is now empty
+		tempSPITransactionPtr->next = NULL;
+		// -------------------------------------------------- //
+	}
+
+	// Restore Interrupt state
+	intFastRestoreGlobal(intState);
+
+	return tempSPITransactionPtr;
+}
+
+/**
+* \fn		void spiDeferredCallback(void * transactionPtr)
+* @brief	Execute the completion callback of a deferred transaction and remove it if needed
+* @note		Called from deferISR() (SPI_CALLBACK_SOFT_INT) or from spiEngine()
+* @arg		void * transactionPtr			Pointer to the transaction control structure
+* @return	nothing
+*/
+void spiDeferredCallback(void * transactionPtr)
+{
+	tSPITransaction * tempSPITransactionPtr = transactionPtr;
+
+	// -- Execute the callback -- //
+	tempSPITransactionPtr->control.busy = SPI_TRANSACTION_IDLE;
+	tempSPITransactionPtr->callback(tempSPITransactionPtr, tempSPITransactionPtr->contextPtr);
+	// -------------------------- //
+
+	// Give back the structure (will fail if the callback restarted it)
+	if (tempSPITransactionPtr->control.remove)
+		spiRemoveTransaction(tempSPITransactionPtr);
+}
+
+/**
+* \fn		void spiCompleteTransaction(tSPITransaction * transactionPtr)
+* @brief	Finish a done (or aborted) transaction: execute or defer its callback and remove it if needed
+* @note		Called from the SPI ISR once the slave is deselected
+* @arg		tSPITransaction * tempSPITransactionPtr		Pointer to the transaction control structure
+* @return	nothing
+*/
+void spiCompleteTransaction(tSPITransaction * transactionPtr)
+{
+	U32 intState;
+
+	if (transactionPtr->callback != NULL)
+	{
+		// -- Post the callback to the deferred queue -- //
+		if (transactionPtr->control.deferCallback == SPI_CALLBACK_SOFT_INT)
+		{
+			if (deferPost(&spiDeferredCallback, transactionPtr) == STD_EC_SUCCESS)
+				return;						//Stay busy until the callback is done
+		}
+		// --------------------------------------------- //
+
+		// -- Defer the callback to spiEngine() (also when the deferred queue is full) -- //
+		if (transactionPtr->control.deferCallback != SPI_CALLBACK_IN_ISR)
+		{
+			// Disable Global Interrupt
+			intState = intFastDisableGlobal();
+
+			transactionPtr->next = NULL;
+			if (spiDoneHead == NULL)
+				spiDoneHead = transactionPtr;
+			else
+				spiDoneTail->next = transactionPtr;
+			spiDoneTail = transactionPtr;
+
+			// Restore Interrupt state
+			intFastRestoreGlobal(intState);
+			return;							//Stay busy until the callback is done
+		}
+		// ------------------------------------------------------------------------------ //
+
+		// -- Execute the callback now -- //
+		transactionPtr->control.busy = SPI_TRANSACTION_IDLE;
+		transactionPtr->callback(transactionPtr, transactionPtr->contextPtr);
+		// ------------------------------ //
+	}
+	else
+		transactionPtr->control.busy = SPI_TRANSACTION_IDLE;
+
+	// Give back the structure (will fail if the callback restarted it)
+	if (transactionPtr->control.remove)
+		spiRemoveTransaction(transactionPtr);
+}
 // ############################################## //
 
 
@@ -82,9 +507,14 @@ U8 spiSelectPort(U8 spiPort)
 */
 void spiMasterISR(U8 spiPort, U32 interruptFlags)
 {
-	U8 transferNb;
-	U8 wu0;
+	U32 transferNb;
+	U32 dataNb;
 	U8 loop = 1;
+	U32 busBRG, busCON;
+#ifdef SPI_KERNEL_STATS
+	U32 kernelTick;
+#endif
+	tSPITransaction * localTransactionPtr;
 	static tSPISlaveControl * localCurrentSlavePtr;
 
 	// -- Select the correct Port -- //
@@ -103,10 +533,15 @@ void spiMasterISR(U8 spiPort, U32 interruptFlags)
 				spiFSMState[spiPort] = SPISfetch;
 
 				//Deselect the Slave
+				if (localCurrentSlavePtr->bus.SSholdTick)
+					spiWaitCoreTick(localCurrentSlavePtr->bus.SSholdTick);
 				(localCurrentSlavePtr->SSpinPort)[REG_OFFSET_SET_32] = localCurrentSlavePtr->SSpinMask;
 
 				//Set the module status
 				spiStatus[spiPort].busy = SPI_TRANSACTION_IDLE;
+
+				//Notify the owner
+				spiCompleteTransaction(spiCurrentTransaction[spiPort]);
 			}
 			// ------------------------- //
 		}
@@ -118,11 +553,10 @@ void spiMasterISR(U8 spiPort, U32 interruptFlags)
 			case SPISfetch:
 			{
 				// -- Check for pending transaction -- //
-				if (rBufGetUsedSpace(spiTransactionList[spiPort]))
+				if (spiPendingMask[spiPort])
 				{
-					// Load a new transaction
-					if (rBufPullElement(spiTransactionList[spiPort], (void*)(&spiCurrentTransaction[spiPort]), 1, RBUF_FREERUN_PTR) == STD_EC_BUSY)
-						Nop(); // TODO : Delay the state (10ms)
+					// Load the highest priority transaction
+					spiCurrentTransaction[spiPort] = spiPopTransaction(spiPort);
 
 					//Save the slave localy
 					localCurrentSlavePtr = spiCurrentTransaction[spiPort]->pSlave;
@@ -163,8 +597,36 @@ void spiMasterISR(U8 spiPort, U32 interruptFlags)
 				spiCurrentTransaction[spiPort]->control.busy = SPI_TRANSACTION_BUSY;
 				// -------------------------------- //
 
+				// -- Set the bus for this slave -- //
+				if (localCurrentSlavePtr != spiLastSlave[spiPort])
+				{
+					spiLastSlave[spiPort] = localCurrentSlavePtr;
+
+					//Slave without its own bus follow the port
+					if (localCurrentSlavePtr->control.ownBus)
+					{
+						busBRG = localCurrentSlavePtr->bus.BRG;
+						busCON = localCurrentSlavePtr->bus.CON;
+					}
+					else
+					{
+						busBRG = spiPortBRG[spiPort];
+						busCON = spiPortCON[spiPort];
+					}
+
+					if ((busBRG != spiAppliedBRG[spiPort]) || (busCON != spiAppliedCON[spiPort]))
+						spiApplyBus(spiPort, busBRG, busCON);
+				}
+				// -------------------------------- //
+
 				// Select the Slave
 				(localCurrentSlavePtr->SSpinPort)[REG_OFFSET_CLR_32] = localCurrentSlavePtr->SSpinMask;
+				if (localCurrentSlavePtr->bus.SSsetupTick)
+					spiWaitCoreTick(localCurrentSlavePtr->bus.SSsetupTick);
+
+				// Select the FIFO kernels for the data width
+				spiFillKernel[spiPort] = spiFillTable[(spiAppliedCON[spiPort]>>10) & 0x3];
+				spiDrainKernel[spiPort] = spiDrainTable[(spiAppliedCON[spiPort]>>10) & 0x3];
 
 				// Move to transfer
 				spiFSMState[spiPort] = SPIStransfer;
@@ -174,99 +636,64 @@ void spiMasterISR(U8 spiPort, U32 interruptFlags)
 			// == In Transfer ================= //
 			case SPIStransfer:
 			{
+				localTransactionPtr = spiCurrentTransaction[spiPort];
+
 				// === TX State ====== //
-				if (spiCurrentTransaction[spiPort]->txNbRemaining > 0)
+				if (localTransactionPtr->txNbRemaining > 0)
 				{
 					// -- Count the remaining transfer -- //
 					transferNb = (spiStatus[spiPort].FIFOlevel - pSPIxSTAT->TXBUFELM);
-					if (transferNb > spiCurrentTransaction[spiPort]->txNbRemaining)
-						transferNb = spiCurrentTransaction[spiPort]->txNbRemaining;
+					if (transferNb > localTransactionPtr->txNbRemaining)
+						transferNb = localTransactionPtr->txNbRemaining;
 					// ---------------------------------- //
 
 					// -- Load new data to be transmitted -- //
-					switch ((spiStatus[spiPort]).FIFOlevel)
+					dataNb = localTransactionPtr->txDataNb;
+					if (dataNb > transferNb)
+						dataNb = transferNb;
+					if (dataNb)
 					{
-						// 8bit transfer width
-						case 16:
-						{
-							for (; wu0 < transferNb; wu0++)
-								*pSPIxBUF = ((U8*)(spiCurrentTransaction[spiPort]->pTX))[wu0];
-							break;
-						}
-						// 16bit transfer width
-						case 8:
-						{
-							for (; wu0 < transferNb; wu0++)
-								*pSPIxBUF = ((U16*)(spiCurrentTransaction[spiPort]->pTX))[wu0];
-							break;
-						}
-						// 32bit transfer width
-						case 4:
-						{
-							for (; wu0 < transferNb; wu0++)
-								*pSPIxBUF = ((U32*)(spiCurrentTransaction[spiPort]->pTX))[wu0];
-							break;
-						}
+						_spiKernelStatStart();
+						spiFillKernel[spiPort](pSPIxBUF, localTransactionPtr, dataNb);
+						_spiKernelStatStop(spiPort);
+						localTransactionPtr->txDataNb -= dataNb;
 					}
-
-					//Adjust the pointer
-					spiCurrentTransaction[spiPort]->pTX += (transferNb<<(pSPIxCON->MODE));
+					if (transferNb > dataNb)
+						spiFillConst(pSPIxBUF, localTransactionPtr->filler, transferNb - dataNb);
 					// ------------------------------------- //
 
 					// Adjust the tx number
-					spiCurrentTransaction[spiPort]->txNbRemaining -= transferNb;
+					localTransactionPtr->txNbRemaining -= transferNb;
 				}
 				// === RX State ====== //
-				if ((pSPIxSTAT->RXBUFELM) > 0)
+				transferNb = pSPIxSTAT->RXBUFELM;
+				if (transferNb > 0)
 				{
-					// -- Count the transfer to make ---- //
-					transferNb = pSPIxSTAT->RXBUFELM;
-					// ---------------------------------- //
-
 					// -- Save received data -- //
-					wu0 = 0;
-					switch (spiStatus[spiPort].FIFOlevel)
+					dataNb = localTransactionPtr->rxSkipNb;
+					if (dataNb > transferNb)
+						dataNb = transferNb;
+					if (dataNb)
 					{
-						// 8bit transfer width
-						case 16:
-						{
-							Nop();
-							for (; wu0 < transferNb; wu0++)
-								((U8*)(spiCurrentTransaction[spiPort]->pRX))[wu0] = *pSPIxBUF;
-							
-							break;
-						}
-						// 16bit transfer width
-						case 8:
-						{
-							Nop();
-							for (; wu0 < transferNb; wu0++)
-								((U16*)(spiCurrentTransaction[spiPort]->pRX))[wu0] = *pSPIxBUF;
-							break;
-						}
-						// 32bit transfer width
-						case 4:
-						{
-							Nop();
-							for (; wu0 < transferNb; wu0++)
-								((U32*)(spiCurrentTransaction[spiPort]->pRX))[wu0] = *pSPIxBUF;
-							break;
-						}
+						spiDrainDiscard(pSPIxBUF, dataNb);
+						localTransactionPtr->rxSkipNb -= dataNb;
+					}
+					if (transferNb > dataNb)
+					{
+						_spiKernelStatStart();
+						spiDrainKernel[spiPort](pSPIxBUF, localTransactionPtr, transferNb - dataNb);
+						_spiKernelStatStop(spiPort);
 					}
-
-					// Adjust the pointer
-					spiCurrentTransaction[spiPort]->pRX += (transferNb<<(pSPIxCON->MODE));
 					// ------------------------ //
 
 					// Adjust the rx number
-					spiCurrentTransaction[spiPort]->rxNbDone += transferNb;
+					localTransactionPtr->rxNbDone += transferNb;
 
 					// -- Check for completion -- //
-					if (spiCurrentTransaction[spiPort]->rxNbDone >= spiCurrentTransaction[spiPort]->transferNb)
+					if (localTransactionPtr->rxNbDone >= localTransactionPtr->transferNb)
 					{
 						// -- Set the transaction Status -- //
-						spiCurrentTransaction[spiPort]->control.busy = SPI_TRANSACTION_IDLE;
-						spiCurrentTransaction[spiPort]->control.done = SPI_TRANSACTION_DONE;
+						localTransactionPtr->control.done = SPI_TRANSACTION_DONE;
 						// -------------------------------- //
 					}
 					else
@@ -292,6 +719,111 @@ void spiMasterISR(U8 spiPort, U32 interruptFlags)
 	// -------------------------- //	
 }
 
+/**
+* \fn		void spiEngine(void)
+* @brief	Execute the deferred completion callback of finished transactions
+* @note		This function must be in the infinite loop of the main if any callback use SPI_CALLBACK_DEFERRED
+*			or SPI_CALLBACK_SOFT_INT (callbacks the defer queue had no room for are executed here)
+*			Transaction flagged for removal are given back to the pool after their callback
+* @arg		nothing
+* @return	nothing
+*/
+void spiEngine(void)
+{
+	tSPITransaction * tempSPITransactionPtr;
+	U32 intState;
+
+	while (spiDoneHead != NULL)
+	{
+		// -- Unlink the first done transaction -- //
+		intState = intFastDisableGlobal();
+		tempSPITransactionPtr = spiDoneHead;
+		spiDoneHead = tempSPITransactionPtr->next;
+		tempSPITransactionPtr->next = NULL;
+		intFastRestoreGlobal(intState);
+		// --------------------------------------- //
+
+		spiDeferredCallback(tempSPITransactionPtr);
+	}
+}
+
+/**
+* \fn		void spiSlaveISR(U8 spiPort, U32 interruptFlags)
+* @brief	SPI Slave Engine, drain the RX FIFO in the request buffer and refill the TX FIFO from the response buffer
+* @note		This function must be placed in the correct ISR of a port started with spiSlaveStart()
+*			Use SPI_RX_BUF_INT_BUF_HALF_FULL and SPI_TX_BUF_INT_BUF_HALF_EMPTY to have time to react at high clock rate
+* @arg		U8 spiPort						Hardware SPI ID
+* @arg		U32 interruptFlags				Interrupt flags for the corresponding SPI port (Aligned to 0)
+* @return	nothing
+*/
+void spiSlaveISR(U8 spiPort, U32 interruptFlags)
+{
+	// -- Select the correct Port -- //
+	spiSelectPort(spiPort);
+	// ----------------------------- //
+
+	// === RX State ====== //
+	if (pSPIxSTAT->RXBUFELM)
+		spiSlaveDrain(spiPort);
+	// === TX State ====== //
+	spiSlaveFill(spiPort);
+	// === ERROR State === //
+	if (interruptFlags & INT_MASK_SPI_ERR)
+	{
+		// Clear the overflow
+		((U32*)pSPIxSTAT)[REG_OFFSET_CLR_32] = SPI_MASK_OVERFLOW_ERROR;
+	}
+	// =================== //
+}
+
+/**
+* \fn		void spiSlaveSSISR(U8 spiPort)
+* @brief	Frame the slave messages on the edges of the SS pin
+* @note		This function must be placed in the Change Notification ISR of the SS pin
+*			On SS release, the remaining byte are saved, the frame end callback is called and the TX FIFO is reloaded
+*			Response byte still in the TX FIFO at the end of a frame are discarded
+*			Once the response ran empty in a frame, the rest of the frame is padded with the filler
+* @arg		U8 spiPort						Hardware SPI ID
+* @return	nothing
+*/
+void spiSlaveSSISR(U8 spiPort)
+{
+	tSPISlaveEngine * enginePtr = &spiSlaveEngine[spiPort];
+
+	// -- Select the correct Port -- //
+	spiSelectPort(spiPort);
+	// ----------------------------- //
+
+	// -- Frame start (SS low) -- //
+	if ((*(enginePtr->SSpinPort) & enginePtr->SSpinMask) == 0)
+	{
+		enginePtr->inFrame = 1;
+		enginePtr->padding = 0;
+		enginePtr->frameByteNb = 0;
+		spiSlaveFill(spiPort);
+	}
+	// -- Frame end (SS high) -- //
+	else if (enginePtr->inFrame)
+	{
+		enginePtr->inFrame = 0;
+		enginePtr->padding = 0;
+
+		// Save the last byte
+		spiSlaveDrain(spiPort);
+		enginePtr->stats.frameNb++;
+
+		// Notify the application
+		if (enginePtr->frameEndFct != NULL)
+			enginePtr->frameEndFct(spiPort, enginePtr->frameByteNb, enginePtr->contextPtr);
+
+		// -- Flush the TX FIFO and preload the next response -- //
+		((U32*)pSPIxCON)[REG_OFFSET_CLR_32] = BIT15;
+		((U32*)pSPIxCON)[REG_OFFSET_SET_32] = BIT15;
+		spiSlaveFill(spiPort);
+		// ----------------------------------------------------- //
+	}
+	// ------------------------- //
+}
 // =========================== //
 
 
@@ -333,8 +865,9 @@ tSPIConfig spiGetConfig(U8 spiPort)
 */
 U8 spiStart(U8 spiPort)
 {
-	U16 intState;
+	U32 intState;
 	U8 errorCode;
+	U8 wu0;
 
 	// -- Select the correct SPI -- //
 	errorCode = spiSelectPort(spiPort);
@@ -355,16 +888,23 @@ U8 spiStart(U8 spiPort)
 			*pSPIxCON2 = spiConfig[spiPort].registers.spiCon2;
 		#endif
 		spiStatus[spiPort].FIFOlevel = 16>>(pSPIxCON->MODE);
+		spiAppliedBRG[spiPort] = *pSPIxBRG;
+		spiAppliedCON[spiPort] = pSPIxCON->all & SPI_BUS_CON_MASK;
+		spiPortBRG[spiPort] = spiAppliedBRG[spiPort];
+		spiPortCON[spiPort] = spiAppliedCON[spiPort];
+		spiLastSlave[spiPort] = NULL;
 		// -------------------- //
 
-		// -- Init the transactions buffer -- //
-		spiTransactionList[spiPort] = rBufCreate(SPI_MAX_TRANSACTION,sizeof(tSPITransaction*));
-		if (spiTransactionList[spiPort] != NULL)
+		// -- Init the transactions lists -- //
+		for (wu0 = 0; wu0 < SPI_PRIORITY_NB; wu0++)
 		{
-			spiStatus[spiPort].multiTransactionOK = 1;
-			errorCode = STD_EC_MEMORY;
+			spiPendingHead[spiPort][wu0] = NULL;
+			spiPendingTail[spiPort][wu0] = NULL;
 		}
-		// ---------------------------------- //
+		spiPendingMask[spiPort] = 0;
+		spiFSMState[spiPort] = SPISfetch;
+		spiStatus[spiPort].multiTransactionOK = 1;
+		// --------------------------------- //
 
 		// -- Configure Interrupt -- //
 		switch (spiPort)
@@ -423,7 +963,10 @@ U8 spiSetBaudRate(U8 spiPort, U32 baudRate)
 		pSPIxCON->ON = 0;
 
 		// -- Compute the BDGEN value -- //
-		*pSPIxBRG = ((U32)( ((F32)clockGetPBCLK())/(F32)baudRate ) >> 2 ) -1 ;
+		spiPortBRG[spiPort] = spiComputeBRG(baudRate);
+		*pSPIxBRG = spiPortBRG[spiPort];
+		spiAppliedBRG[spiPort] = spiPortBRG[spiPort];
+		spiLastSlave[spiPort] = NULL;				//Force the slave bus check on the next transaction
 		// ----------------------------- //
 
 		//Restore the SPI State
@@ -458,7 +1001,10 @@ U32 spiGetBaudRate(U8 spiPort)
 /**
 * \fn		U8 spiAddSlave(U8 spiPort, U32 * SSpinPortPtr, U32 SSpinPortMask)
 * @brief	Save communication information for a slave, return a pointer to the allocated structure
-* @note		If allocation failed, will return a NULL pointer
+* @note		The structure is taken from the slave pool (SPI_SLAVE_POOL_SIZE)
+*			The slave follow the baudrate and mode of the port (even if they are changed later),
+*			use spiSetSlaveConfig() to give it its own
+*			If allocation failed, will return a NULL pointer
 * @arg		U8 spiPort						SPI port the Slave is connected to
 * @arg		U32 * SSpinPortPtr				Pointer to the correct port register (ex: &LATA)
 * @arg		U32 SSpinPortMask				Mask to apply to the port register (ex: BIT0)
@@ -469,17 +1015,20 @@ tSPISlaveControl * spiAddSlave(U8 spiPort, volatile U32 * SSpinPortPtr, U16 SSpi
 	tSPISlaveControl * tempSlavePtr;
 	
 	// -- Allocate Memory -- //
-	tempSlavePtr = (tSPISlaveControl*)malloc(sizeof(tSPISlaveControl));
+	if (spiPoolReady == 0)
+		spiInitPool();
+	tempSlavePtr = (tSPISlaveControl*)poolAlloc(&spiSlavePool);
 	if (tempSlavePtr != NULL)
 	// --------------------- //
 	{
-		//Count the allocated ram
-		heapAvailable -= sizeof(tSPISlaveControl);
-
 		// -- Save data -- //
 		tempSlavePtr->spiPort = spiPort;
 		tempSlavePtr->SSpinMask = SSpinPortMask;
 		tempSlavePtr->SSpinPort = SSpinPortPtr;
+		tempSlavePtr->bus.BRG = 0;
+		tempSlavePtr->bus.CON = 0;
+		tempSlavePtr->bus.SSsetupTick = 0;
+		tempSlavePtr->bus.SSholdTick = 0;
 		// --------------- //
 
 		// -- Reset SSpin to a known state -- //
@@ -489,6 +1038,7 @@ tSPISlaveControl * spiAddSlave(U8 spiPort, volatile U32 * SSpinPortPtr, U16 SSpi
 		// -- Init the slave -- //
 		tempSlavePtr->control.lock = SPI_SLAVE_UNLOCKED;
 		tempSlavePtr->control.busy = SPI_SLAVE_IDLE;
+		tempSlavePtr->control.ownBus = 0;			//Follow the port
 		// -------------------- //
 	}
 
@@ -499,6 +1049,7 @@ tSPISlaveControl * spiAddSlave(U8 spiPort, volatile U32 * SSpinPortPtr, U16 SSpi
 * \fn		void spiDelSlave(tSPISlaveControl * slavePtr)
 * @brief	Delete all communication information for a slave
 * @note		This function will not delete the slave if it is busy (will return STD_EC_BUSY)
+*			Return STD_EC_INVALID if the slave was not created by spiAddSlave()
 * @arg		tSPISlaveInfo * slavePtr		Pointer to the allocated memory
 * @return	U8 errorCode					STD Error Code (return STD_EC_SUCCESS if successful)
 */
@@ -515,22 +1066,117 @@ U8 spiDelSlave(tSPISlaveControl * slavePtr)
 		// -------------------------------- //
 
 		// -- Delete the information -- //
-		free(slavePtr);
-		heapAvailable += sizeof(tSPISlaveControl);		//Count the unallocated ram
+		if (spiLastSlave[slavePtr->spiPort] == slavePtr)
+			spiLastSlave[slavePtr->spiPort] = NULL;		//The block may be reused for another slave
+		return poolFree(&spiSlavePool, slavePtr);
 		// ---------------------------- //
-		return STD_EC_SUCCESS;
 	}
 	// -------------------------------------- //
 	return STD_EC_BUSY;
 }
+
+/**
+* \fn		U8 spiSetSlaveConfig(tSPISlaveControl * slavePtr, U32 baudRate, U32 option, U32 SSsetupNs, U32 SSholdNs)
+* @brief	Save the bus parameters to use for a slave, they are applied by the SPI engine when this slave is selected
+* @note		The bus is only reprogrammed when the selected slave changes and its parameters differ from the actual ones
+*			Option are the data width, clock and data phase Init Option (ex: SPI_DATA_WIDTH_8BIT|SPI_CLK_IDLE_LOW|SPI_TX_DATA_ACTIVE_TO_IDLE)
+*			Delays are rounded up to the core timer resolution (2 SYSCLK), use 0 to disable them
+*			Delays are busy-waited in the SPI ISR, so they are limited to SPI_SS_DELAY_MAX_NS
+*			Return STD_EC_BUSY if the slave is busy, STD_EC_INVALID for a null baudrate,
+*			STD_EC_TOOLARGE for a delay over SPI_SS_DELAY_MAX_NS
+* @arg		tSPISlaveControl * slavePtr			Slave to configure
+* @arg		U32 baudRate					Clock rate for this slave (in bps)
+* @arg		U32 option					SPIxCON option for this slave
+* @arg		U32 SSsetupNs					Delay between SS assertion and the first clock (in ns)
+* @arg		U32 SSholdNs					Delay between the last clock and SS release (in ns)
+* @return	U8 errorCode					STD Error Code (return STD_EC_SUCCESS if successful)
+*/
+U8 spiSetSlaveConfig(tSPISlaveControl * slavePtr, U32 baudRate, U32 option, U32 SSsetupNs, U32 SSholdNs)
+{
+	U32 coreTickFreq = clockGetSYSCLK()>>1;
+	U32 intState;
+
+	// -- Handle invalid parameters -- //
+	if (baudRate == 0)
+		return STD_EC_INVALID;
+	if ((SSsetupNs > SPI_SS_DELAY_MAX_NS) || (SSholdNs > SPI_SS_DELAY_MAX_NS))
+		return STD_EC_TOOLARGE;
+	if (slavePtr->control.busy == SPI_SLAVE_BUSY)
+		return STD_EC_BUSY;
+	// ------------------------------- //
+
+	// Disable Global Interrupt
+	intState = intFastDisableGlobal();
+
+	// -- Save the parameters -- //
+	slavePtr->bus.BRG = spiComputeBRG(baudRate);
+	slavePtr->bus.CON = option & SPI_BUS_CON_MASK;
+	slavePtr->bus.SSsetupTick = (U32)((((U64)SSsetupNs * coreTickFreq) + 999999999) / 1000000000);
+	slavePtr->bus.SSholdTick = (U32)((((U64)SSholdNs * coreTickFreq) + 999999999) / 1000000000);
+	slavePtr->control.ownBus = 1;
+	// ------------------------- //
+
+	// Force the check on the next transaction of this slave
+	if (spiLastSlave[slavePtr->spiPort] == slavePtr)
+		spiLastSlave[slavePtr->spiPort] = NULL;
+
+	// Restore Interrupt state
+	intFastRestoreGlobal(intState);
+
+	return STD_EC_SUCCESS;
+}
+
+/**
+* \fn		tSPIBusStats spiGetBusStats(U8 spiPort)
+* @brief	Return the bus reconfiguration and FIFO kernel statistics of a port
+* @note		Usefull to measure the cost of sharing a bus between slaves with different parameters
+*			The FIFO kernel statistics are only updated when SPI_KERNEL_STATS is defined
+* @arg		U8 spiPort					Hardware SPI ID
+* @return	tSPIBusStats busStats				Bus statistics
+*/
+tSPIBusStats spiGetBusStats(U8 spiPort)
+{
+	return spiBusStats[spiPort];
+}
+
+/**
+* \fn		tPoolCtl * spiGetSlavePool(void)
+* @brief	Return the pool control of the slave structures
+* @note		Use the pool functions to read the usage statistics (ex: poolGetPeakSpace(spiGetSlavePool()))
+* @arg		nothing
+* @return	tPoolCtl * poolCtlPtr						Slave pool control
+*/
+tPoolCtl * spiGetSlavePool(void)
+{
+	if (spiPoolReady == 0)
+		spiInitPool();
+	return &spiSlavePool;
+}
+
+/**
+* \fn		tPoolCtl * spiGetTransactionPool(void)
+* @brief	Return the pool control of the transaction structures
+* @note		Use the pool functions to read the usage statistics (ex: poolGetPeakSpace(spiGetTransactionPool()))
+* @arg		nothing
+* @return	tPoolCtl * poolCtlPtr						Transaction pool control
+*/
+tPoolCtl * spiGetTransactionPool(void)
+{
+	if (spiPoolReady == 0)
+		spiInitPool();
+	return &spiTransactionPool;
+}
 // =========================== //
 
 
 // === Transfer Functions ==== //
 /**
 * \fn		tSPITransaction * spiCreateTransaction(tSPISlaveControl * slavePtr, void * incomingPtr, void * outgoingPtr, U16 transferNb)
-* @brief	Create and init an SPI Transaction control structure in the heap
+* @brief	Create and init an SPI Transaction control structure in the transaction pool
 * @note		This function can be usefull for single shot communication or for dynamic slave
+*			The transaction is created with the SPI_PRIORITY_NORMAL priority
+*			The structure is taken from the transaction pool (SPI_TRANSACTION_POOL_SIZE), return NULL if it is empty
+*			A NULL incomingPtr discard all the received data, a NULL outgoingPtr send only SPI_FILLER
 * @arg		tSPISlaveControl * slavePtr					Slave to select for this transaction
 * @arg		void * incomingPtr							Pointer to store the incoming data
 * @arg		void * outgoingPtr							Pointer to load the outgoing data
@@ -538,27 +1184,70 @@ U8 spiDelSlave(tSPISlaveControl * slavePtr)
 * @return	tSPITransaction * tempSPITransactionPtr		Pointer to the transaction control structure
 */
 tSPITransaction * spiCreateTransaction(tSPISlaveControl * slavePtr, void * incomingPtr, void * outgoingPtr, U16 transferNb)
+{
+	tSPITransaction * tempSPITransactionPtr;
+
+	// -- Create the transaction -- //
+	tempSPITransactionPtr = spiCreateWriteRead(slavePtr, outgoingPtr, transferNb, incomingPtr, 0);
+	if (tempSPITransactionPtr != NULL)
+	// ---------------------------- //
+	{
+		// -- Full-duplex: save every reception -- //
+		tempSPITransactionPtr->rxSkipNb = 0;
+		if (incomingPtr == NULL)
+			tempSPITransactionPtr->rxSkipNb = transferNb;
+		// --------------------------------------- //
+	}
+	return tempSPITransactionPtr;
+}
+
+/**
+* \fn		tSPITransaction * spiCreateWriteRead(tSPISlaveControl * slavePtr, void * outgoingPtr, U16 txNb, void * incomingPtr, U16 rxNb)
+* @brief	Create and init a "write txNb then read rxNb" SPI Transaction in the transaction pool
+* @note		The transaction clock txNb+rxNb data in a single SS assertion
+*			The data received during the write part is discarded, SPI_FILLER is sent during the read part
+*			Buffers only need to be the size of their part (ex: 1 byte command, then read 32 byte)
+*			The transaction is created with the SPI_PRIORITY_NORMAL priority, return NULL if the pool is empty
+*			Return NULL if txNb+rxNb does not fit in 16bit
+* @arg		tSPISlaveControl * slavePtr					Slave to select for this transaction
+* @arg		void * outgoingPtr							Pointer to load the outgoing data (command, address...)
+* @arg		U16 txNb									Number of transfer to write
+* @arg		void * incomingPtr							Pointer to store the incoming data
+* @arg		U16 rxNb									Number of transfer to read
+* @return	tSPITransaction * tempSPITransactionPtr		Pointer to the transaction control structure
+*/
+tSPITransaction * spiCreateWriteRead(tSPISlaveControl * slavePtr, void * outgoingPtr, U16 txNb, void * incomingPtr, U16 rxNb)
 {
 	tSPITransaction * tempSPITransactionPtr = NULL;
 
-	// -- Only process if the slave is unlocked -- //
-	if (slavePtr->control.lock == SPI_SLAVE_UNLOCKED)
+	// -- Only process if the slave is unlocked and the size fit -- //
+	if ((slavePtr->control.lock == SPI_SLAVE_UNLOCKED) && ((((U32)txNb) + rxNb) <= U16_MAX))
 	{
 		// -- Allocate memory -- //
-		tempSPITransactionPtr = (tSPITransaction*)malloc(sizeof(tSPITransaction));
+		if (spiPoolReady == 0)
+			spiInitPool();
+		tempSPITransactionPtr = (tSPITransaction*)poolAlloc(&spiTransactionPool);
 		if (tempSPITransactionPtr != NULL)
 		// --------------------- //
 		{
-			//Count the allocated ram
-			heapAvailable -= sizeof(tSPITransaction);
-
 			// -- Save information -- //
+			tempSPITransactionPtr->next = NULL;
+			tempSPITransactionPtr->priority = SPI_PRIORITY_NORMAL;
 			tempSPITransactionPtr->pRX = incomingPtr;
 			tempSPITransactionPtr->pTX = outgoingPtr;
 			tempSPITransactionPtr->pSlave = slavePtr;
-			tempSPITransactionPtr->transferNb = transferNb;
-			tempSPITransactionPtr->txNbRemaining = transferNb;
+			tempSPITransactionPtr->callback = NULL;
+			tempSPITransactionPtr->contextPtr = NULL;
+			tempSPITransactionPtr->transferNb = txNb + rxNb;
+			tempSPITransactionPtr->txNbRemaining = txNb + rxNb;
 			tempSPITransactionPtr->rxNbDone = 0;
+			tempSPITransactionPtr->txDataNb = txNb;
+			tempSPITransactionPtr->rxSkipNb = txNb;
+			tempSPITransactionPtr->filler = SPI_FILLER;
+			if (outgoingPtr == NULL)
+				tempSPITransactionPtr->txDataNb = 0;			//Only send the filler
+			if (incomingPtr == NULL)
+				tempSPITransactionPtr->rxSkipNb = txNb + rxNb;		//Discard everything
 			tempSPITransactionPtr->control.all = 0;
 			tempSPITransactionPtr->control.removable = SPI_TRANSACTION_REMOVABLE;	//Flag this struct as removable
 			// ---------------------- //
@@ -570,48 +1259,130 @@ tSPITransaction * spiCreateTransaction(tSPISlaveControl * slavePtr, void * incom
 
 /**
 * \fn		U8 spiStartTransaction(tSPITransaction * transactionPtr)
-* @brief	Add a transaction to the pending list, and activate the SPI module
+* @brief	Add a transaction to the pending list of its priority, and activate the SPI module
 * @note		Return STD_EC_BUSY if the transaction was currently busy
-*			Return STD_EC_OVERFLOW if the transaction list is full
+*			Return STD_EC_INVALID if the priority of the transaction is invalid
+*			The pending lists are linked through the transaction themselves, there is no depth limit
+*			Transaction of the same priority are processed in a FIFO manner
 * @arg		tSPITransaction * tempSPITransactionPtr		Pointer to the transaction control structure
 * @return	U8 errorCode								STD Error Code (return STD_EC_SUCCESS if successful)
 */
 U8 spiStartTransaction(tSPITransaction * transactionPtr)
 {
 	U8 tempSPIPort = transactionPtr->pSlave->spiPort;
-	U8 errorCode;
-	U32 tempAddress = (U32*)transactionPtr;					// @todo Why don't use directly (&transactionPtr) ?
+	U8 priority = transactionPtr->priority;
+	U32 intState;
+
+	// -- Handle invalid priority -- //
+	if (priority >= SPI_PRIORITY_NB)
+		return STD_EC_INVALID;
+	// ----------------------------- //
+
+	// Disable Global Interrupt
+	intState = intFastDisableGlobal();
 
 	// -- Only process if the transaction is idle -- //
 	if (transactionPtr->control.busy == SPI_TRANSACTION_IDLE)
 	{
-		// -- Add it to the list -- //
-		errorCode = rBufPushElement(spiTransactionList[tempSPIPort],(void*)(&tempAddress),1,RBUF_FREERUN_PTR);
-		if (errorCode == STD_EC_SUCCESS)
+		// -- Add it at the end of its priority list -- //
+		transactionPtr->control.busy = SPI_TRANSACTION_BUSY;
+		transactionPtr->control.done = 0;
+		transactionPtr->control.abort = 0;
+		transactionPtr->control.error = 0;
+		transactionPtr->next = NULL;
+		if (spiPendingHead[tempSPIPort][priority] == NULL)
+			spiPendingHead[tempSPIPort][priority] = transactionPtr;
+		else
+			spiPendingTail[tempSPIPort][priority]->next = transactionPtr;
+		spiPendingTail[tempSPIPort][priority] = transactionPtr;
+		spiPendingMask[tempSPIPort] |= (1<<priority);
+		// -------------------------------------------- //
+
+		// -- Enable SPI module -- //
+		if (spiStatus[tempSPIPort].ready == SPI_MODULE_READY)
 		{
-			transactionPtr->control.busy = SPI_TRANSACTION_BUSY;
-		// ------------------------ //
-
-			// -- Enable SPI module -- //
-			if (spiStatus[tempSPIPort].ready == SPI_MODULE_READY)
+			switch (tempSPIPort)
 			{
-				switch (tempSPIPort)
-				{
-					case SPI_1: intFastEnable(INT_SPI_1);	break;
-					case SPI_2: intFastEnable(INT_SPI_2);	break;
-				#if CPU_FAMILY == PIC32MX5xxH || CPU_FAMILY == PIC32MX5xxL || CPU_FAMILY == PIC32MX6xx || CPU_FAMILY == PIC32MX7xx
-					case SPI_3: intFastEnable(INT_SPI_3);	break;
-				#endif
-				#if CPU_FAMILY == PIC32MX5xxL || CPU_FAMILY == PIC32MX6xx || CPU_FAMILY == PIC32MX7xx
-					case SPI_4: intFastEnable(INT_SPI_4);	break;
-				#endif
-				}
+				case SPI_1: intFastEnable(INT_SPI_1);	break;
+				case SPI_2: intFastEnable(INT_SPI_2);	break;
+			#if CPU_FAMILY == PIC32MX5xxH || CPU_FAMILY == PIC32MX5xxL || CPU_FAMILY == PIC32MX6xx || CPU_FAMILY == PIC32MX7xx
+				case SPI_3: intFastEnable(INT_SPI_3);	break;
+			#endif
+			#if CPU_FAMILY == PIC32MX5xxL || CPU_FAMILY == PIC32MX6xx || CPU_FAMILY == PIC32MX7xx
+				case SPI_4: intFastEnable(INT_SPI_4);	break;
+			#endif
 			}
-			// ----------------------- //
 		}
-		return errorCode;
+		// ----------------------- //
+
+		// Restore Interrupt state
+		intFastRestoreGlobal(intState);
+		return STD_EC_SUCCESS;
 	}
 	// --------------------------------------------- //
+
+	// Restore Interrupt state
+	intFastRestoreGlobal(intState);
+	return STD_EC_BUSY;
+}
+
+/**
+* \fn		U8 spiSetPriority(tSPITransaction * transactionPtr, U8 priority)
+* @brief	Set the priority of a transaction
+* @note		Higher value are processed first (SPI_PRIORITY_CRITICAL is the highest)
+*			Return STD_EC_BUSY if the transaction is pending or active (priority is not changed)
+*			Return STD_EC_INVALID if the priority is invalid
+* @arg		tSPITransaction * tempSPITransactionPtr		Pointer to the transaction control structure
+* @arg		U8 priority								Priority level (SPI_PRIORITY_x)
+* @return	U8 errorCode								STD Error Code (return STD_EC_SUCCESS if successful)
+*/
+U8 spiSetPriority(tSPITransaction * transactionPtr, U8 priority)
+{
+	// -- Handle invalid priority -- //
+	if (priority >= SPI_PRIORITY_NB)
+		return STD_EC_INVALID;
+	// ----------------------------- //
+
+	// -- Only change it when the transaction is not in a list -- //
+	if (transactionPtr->control.busy == SPI_TRANSACTION_IDLE)
+	{
+		transactionPtr->priority = priority;
+		return STD_EC_SUCCESS;
+	}
+	// ---------------------------------------------------------- //
+	return STD_EC_BUSY;
+}
+
+/**
+* \fn		U8 spiSetCallback(tSPITransaction * transactionPtr, void (*callback)(tSPITransaction*, void*), void * contextPtr, U8 option)
+* @brief	Attach a completion callback to a transaction
+* @note		The callback receive the transaction and the context pointer, it is called when the transaction is done or aborted
+*			With SPI_CALLBACK_IN_ISR the callback run in the SPI ISR, it can start the next transaction directly
+*			With SPI_CALLBACK_DEFERRED the callback run in spiEngine()
+*			With SPI_CALLBACK_SOFT_INT the callback run in deferISR() (deferInit() must be done), the SPI ISR
+*			only post it, if the defer queue is full it fall back to spiEngine()
+*			Use a NULL callback to remove it
+*			Return STD_EC_BUSY if the transaction is pending or active, STD_EC_INVALID for an unknown option
+* @arg		tSPITransaction * tempSPITransactionPtr		Pointer to the transaction control structure
+* @arg		void (*callback)(tSPITransaction*, void*)	Function to call at completion
+* @arg		void * contextPtr							Context given to the callback
+* @arg		U8 option									Execution context (SPI_CALLBACK_x)
+* @return	U8 errorCode								STD Error Code (return STD_EC_SUCCESS if successful)
+*/
+U8 spiSetCallback(tSPITransaction * transactionPtr, void (*callback)(tSPITransaction*, void*), void * contextPtr, U8 option)
+{
+	if (option > SPI_CALLBACK_SOFT_INT)
+		return STD_EC_INVALID;
+
+	// -- Only change it when the transaction is idle -- //
+	if (transactionPtr->control.busy == SPI_TRANSACTION_IDLE)
+	{
+		transactionPtr->callback = callback;
+		transactionPtr->contextPtr = contextPtr;
+		transactionPtr->control.deferCallback = option;
+		return STD_EC_SUCCESS;
+	}
+	// ------------------------------------------------- //
 	return STD_EC_BUSY;
 }
 
@@ -630,8 +1401,8 @@ void spiAbortTransaction(tSPITransaction * transactionPtr)
 
 /**
 * \fn		U8 spiRemoveTransaction(tSPITransaction * transactionPtr)
-* @brief	Remove a transaction control structure from the heap
-* @note		Return STD_EC_INVALID if the transaction was not in the heap
+* @brief	Remove a transaction control structure from the transaction pool
+* @note		Return STD_EC_INVALID if the transaction was not in the transaction pool
 *			Return STD_EC_BUSY if the transaction was currently busy
 * @arg		tSPITransaction * tempSPITransactionPtr		Pointer to the transaction control structure
 * @return	U8 errorCode								STD Error Code (return STD_EC_SUCCESS if successful)
@@ -643,11 +1414,9 @@ U8 spiRemoveTransaction(tSPITransaction * transactionPtr)
 	{
 		if (transactionPtr->control.removable == SPI_TRANSACTION_REMOVABLE)
 		{
-			// -- Desallocate the ram -- //
-			free(transactionPtr);
-			heapAvailable += sizeof(tSPITransaction);				//Count the desallocated ram
-			// ------------------------- //
-			return STD_EC_SUCCESS;
+			// -- Give back the structure to the pool -- //
+			return poolFree(&spiTransactionPool, transactionPtr);
+			// ----------------------------------------- //
 		}
 		return STD_EC_INVALID;
 	}
@@ -656,4 +1425,250 @@ U8 spiRemoveTransaction(tSPITransaction * transactionPtr)
 }
 
 // =========================== //
+
+
+// === Slave Functions ======= //
+/**
+* \fn		U8 spiSlaveStart(U8 spiPort, U16 requestSize, U16 responseSize, volatile U32 * SSpinPortPtr, U16 SSpinMask, U8 filler)
+* @brief	Create the slave buffers, start the SPI in slave mode and preload the TX FIFO
+* @note		The port must be configured with SPI_MODE_SLAVE|SPI_ENHANCED_BUF|SPI_DATA_WIDTH_8BIT|SPI_PIN_SS_ON
+*			The Change Notification of the SS pin must be configured in the main and call spiSlaveSSISR()
+*			Return STD_EC_INVALID if the port is not configured correctly, STD_EC_MEMORY if a buffer can't be created,
+*			STD_EC_BUSY if the slave engine is already started (use spiSlaveStop() first)
+*			Nothing is kept allocated if the start fail
+* @arg		U8 spiPort						Hardware SPI ID
+* @arg		U16 requestSize					Size of the request buffer (in byte)
+* @arg		U16 responseSize				Size of the response buffer (in byte)
+* @arg		volatile U32 * SSpinPortPtr		Pointer to the PORT reg of the SS pin (ex: &PORTB)
+* @arg		U16 SSpinMask					Mask to apply to the PORT reg (ex: BIT7)
+* @arg		U8 filler						Byte sent when the response buffer is empty
+* @return	U8 errorCode					STD Error Code (return STD_EC_SUCCESS if successful)
+*/
+U8 spiSlaveStart(U8 spiPort, U16 requestSize, U16 responseSize, volatile U32 * SSpinPortPtr, U16 SSpinMask, U8 filler)
+{
+	tSPISlaveEngine * enginePtr = &spiSlaveEngine[spiPort];
+	U32 intState;
+	U8 errorCode;
+
+	// -- Check the config -- //
+	if ((spiConfig[spiPort].mode != 0) || (spiConfig[spiPort].enhancedBuf == 0) || (spiConfig[spiPort].data.width != 0))
+		return STD_EC_INVALID;
+	if (enginePtr->requestBuf != NULL)
+		return STD_EC_BUSY;					//Already started
+	// ---------------------- //
+
+	// -- Init the engine -- //
+	enginePtr->SSpinPort = SSpinPortPtr;
+	enginePtr->SSpinMask = SSpinMask;
+	enginePtr->filler = filler;
+	enginePtr->inFrame = 0;
+	enginePtr->padding = 0;
+	enginePtr->frameByteNb = 0;
+	enginePtr->frameEndFct = NULL;
+	enginePtr->contextPtr = NULL;
+	enginePtr->stats.frameNb = 0;
+	enginePtr->stats.underrunNb = 0;
+	enginePtr->stats.overflowNb = 0;
+	// --------------------- //
+
+	// -- Create the buffers -- //
+	enginePtr->requestBuf = rBufCreate(requestSize, 1);
+	enginePtr->responseBuf = rBufCreate(responseSize, 1);
+	if ((enginePtr->requestBuf == NULL) || (enginePtr->responseBuf == NULL))
+		errorCode = STD_EC_MEMORY;
+	else
+		errorCode = spiStart(spiPort);
+	// ------------------------ //
+
+	// -- Start the module -- //
+	if (errorCode == STD_EC_SUCCESS)
+	{
+		// Disable Global Interrupt
+		intState = intFastDisableGlobal();
+
+		spiSelectPort(spiPort);
+		spiSlaveFill(spiPort);
+
+		switch (spiPort)
+		{
+			case SPI_1: intFastEnable(INT_SPI_1);	break;
+			case SPI_2: intFastEnable(INT_SPI_2);	break;
+		#if CPU_FAMILY == PIC32MX5xxH || CPU_FAMILY == PIC32MX5xxL || CPU_FAMILY == PIC32MX6xx || CPU_FAMILY == PIC32MX7xx
+			case SPI_3: intFastEnable(INT_SPI_3);	break;
+		#endif
+		#if CPU_FAMILY == PIC32MX5xxL || CPU_FAMILY == PIC32MX6xx || CPU_FAMILY == PIC32MX7xx
+			case SPI_4: intFastEnable(INT_SPI_4);	break;
+		#endif
+		}
+
+		// Restore Interrupt state
+		intFastRestoreGlobal(intState);
+	}
+	// -- Give back what was created -- //
+	else
+	{
+		if (enginePtr->requestBuf != NULL)
+			rBufDelete(enginePtr->requestBuf);
+		if (enginePtr->responseBuf != NULL)
+			rBufDelete(enginePtr->responseBuf);
+		enginePtr->requestBuf = NULL;
+		enginePtr->responseBuf = NULL;
+	}
+	// ---------------------- //
+
+	return errorCode;
+}
+
+/**
+* \fn		U8 spiSlaveStop(U8 spiPort)
+* @brief	Stop the SPI slave engine of a port and delete its buffers
+* @note		Byte still in the buffers are lost
+*			Return STD_EC_INVALID if the slave engine is not started
+* @arg		U8 spiPort						Hardware SPI ID
+* @return	U8 errorCode					STD Error Code (return STD_EC_SUCCESS if successful)
+*/
+U8 spiSlaveStop(U8 spiPort)
+{
+	tSPISlaveEngine * enginePtr = &spiSlaveEngine[spiPort];
+	U32 intState;
+
+	if (enginePtr->requestBuf == NULL)
+		return STD_EC_INVALID;
+
+	// Disable Global Interrupt
+	intState = intFastDisableGlobal();
+
+	// -- Stop the module -- //
+	switch (spiPort)
+	{
+		case SPI_1: intFastDisable(INT_SPI_1);	break;
+		case SPI_2: intFastDisable(INT_SPI_2);	break;
+	#if CPU_FAMILY == PIC32MX5xxH || CPU_FAMILY == PIC32MX5xxL || CPU_FAMILY == PIC32MX6xx || CPU_FAMILY == PIC32MX7xx
+		case SPI_3: intFastDisable(INT_SPI_3);	break;
+	#endif
+	#if CPU_FAMILY == PIC32MX5xxL || CPU_FAMILY == PIC32MX6xx || CPU_FAMILY == PIC32MX7xx
+		case SPI_4: intFastDisable(INT_SPI_4);	break;
+	#endif
+	}
+	spiSelectPort(spiPort);
+	pSPIxCON->ON = 0;
+	spiStatus[spiPort].all = 0;
+	enginePtr->inFrame = 0;
+	// --------------------- //
+
+	// -- Delete the buffers -- //
+	rBufDelete(enginePtr->requestBuf);
+	rBufDelete(enginePtr->responseBuf);
+	enginePtr->requestBuf = NULL;
+	enginePtr->responseBuf = NULL;
+	// ------------------------ //
+
+	// Restore Interrupt state
+	intFastRestoreGlobal(intState);
+
+	return STD_EC_SUCCESS;
+}
+
+/**
+* \fn		void spiSlaveSetFrameCallback(U8 spiPort, void (*frameEndFct)(U8, U16, void*), void * contextPtr)
+* @brief	Set the function called (in the SS ISR) at the end of each frame
+* @note		The callback receive the port, the number of byte received in the frame and the context pointer
+*			Use a NULL function to remove it
+* @arg		U8 spiPort						Hardware SPI ID
+* @arg		void (*frameEndFct)(U8, U16, void*)	Frame end callback
+* @arg		void * contextPtr				Context given to the callback
+* @return	nothing
+*/
+void spiSlaveSetFrameCallback(U8 spiPort, void (*frameEndFct)(U8, U16, void*), void * contextPtr)
+{
+	U32 intState;
+
+	// Disable Global Interrupt
+	intState = intFastDisableGlobal();
+
+	spiSlaveEngine[spiPort].frameEndFct = frameEndFct;
+	spiSlaveEngine[spiPort].contextPtr = contextPtr;
+
+	// Restore Interrupt state
+	intFastRestoreGlobal(intState);
+}
+
+/**
+* \fn		U8 spiSlaveWrite(U8 spiPort, U8 * dataPtr, U16 byteNb)
+* @brief	Queue byte to send to the master
+* @note		Return STD_EC_OVERFLOW if there is not enough space in the response buffer (nothing is queued)
+*			Outside of a frame, the TX FIFO is directly preloaded
+*			Byte queued in a frame that already ran empty are sent in the next frame
+*			Return STD_EC_INVALID if the slave engine is not started
+* @arg		U8 spiPort						Hardware SPI ID
+* @arg		U8 * dataPtr					Byte to send
+* @arg		U16 byteNb						Number of byte
+* @return	U8 errorCode					STD Error Code (return STD_EC_SUCCESS if successful)
+*/
+U8 spiSlaveWrite(U8 spiPort, U8 * dataPtr, U16 byteNb)
+{
+	U32 intState;
+	U8 errorCode;
+
+	if (spiSlaveEngine[spiPort].responseBuf == NULL)
+		return STD_EC_INVALID;
+
+	// Disable Global Interrupt
+	intState = intFastDisableGlobal();
+
+	errorCode = rBufPushU8(spiSlaveEngine[spiPort].responseBuf, dataPtr, byteNb, RBUF_FREERUN_PTR);
+
+	// -- Preload the FIFO between frames -- //
+	if ((errorCode == STD_EC_SUCCESS) && (spiSlaveEngine[spiPort].inFrame == 0))
+	{
+		spiSelectPort(spiPort);
+		spiSlaveFill(spiPort);
+	}
+	// ------------------------------------- //
+
+	// Restore Interrupt state
+	intFastRestoreGlobal(intState);
+
+	return errorCode;
+}
+
+/**
+* \fn		U16 spiSlaveRead(U8 spiPort, U8 * dataPtr, U16 maxNb)
+* @brief	Read the byte received from the master
+* @note
+* @arg		U8 spiPort						Hardware SPI ID
+* @arg		U8 * dataPtr					Destination of the byte
+* @arg		U16 maxNb						Maximum number of byte to read
+* @return	U16 byteNb						Number of byte read
+*/
+U16 spiSlaveRead(U8 spiPort, U8 * dataPtr, U16 maxNb)
+{
+	U16 byteNb;
+
+	if (spiSlaveEngine[spiPort].requestBuf == NULL)
+		return 0;
+
+	byteNb = rBufGetUsedSpace(spiSlaveEngine[spiPort].requestBuf);
+
+	if (byteNb > maxNb)
+		byteNb = maxNb;
+	if (byteNb)
+		rBufPullU8(spiSlaveEngine[spiPort].requestBuf, dataPtr, byteNb, RBUF_FREERUN_PTR);
+
+	return byteNb;
+}
+
+/**
+* \fn		tSPISlaveStats spiSlaveGetStats(U8 spiPort)
+* @brief	Return the statistics of the slave engine of a port
+* @note		A non-zero underrunNb mean the application did not queue the response fast enough
+*			(the end of those frames was padded with the filler)
+* @arg		U8 spiPort						Hardware SPI ID
+* @return	tSPISlaveStats slaveStats		Slave engine statistics
+*/
+tSPISlaveStats spiSlaveGetStats(U8 spiPort)
+{
+	return spiSlaveEngine[spiPort].stats;
+}
+// =========================== //
 // ############################################## //
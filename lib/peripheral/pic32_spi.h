@@ -19,6 +19,8 @@
 
 // Librairies
 #include <soft/pic32_ringBuffer.h>
+#include <soft/pic32_pool.h>
+#include <soft/pic32_defer.h>
 #include <peripheral/pic32_clock.h>
 #include <peripheral/pic32_interrupt.h>
 
@@ -34,7 +36,11 @@
 
 // ################## Defines ################### //
 // == Application dependant  == //
-#define SPI_MAX_TRANSACTION			10		//Maximum number of pending transaction
+#define SPI_FILLER				0xFF		//Data sent when a transaction has no more TX data
+#define SPI_SLAVE_POOL_SIZE			8		//Number of slave control structure available for spiAddSlave()
+#define SPI_TRANSACTION_POOL_SIZE		16		//Number of transaction structure available for spiCreateTransaction()
+#define SPI_SS_DELAY_MAX_NS			2000		//Maximum SS setup/hold delay (busy-wait in the SPI ISR)
+// Define SPI_KERNEL_STATS in the application to measure the FIFO kernels of spiMasterISR() (see spiGetBusStats())
 // ============================ //
 
 
@@ -155,6 +161,24 @@
 #define SPI_TRANSACTION_DONE			1
 // ============================ //
 
+// == Slave Bus Option == //
+#define SPI_BUS_CON_MASK			(BIT6|BIT8|BIT9|BIT10|BIT11)	//SPIxCON bits saved per slave (CKP, CKE, SMP, MODE)
+// ======================== //
+
+// == SPI Callback Option == //
+#define SPI_CALLBACK_IN_ISR			0		//Callback is executed in the SPI ISR at completion
+#define SPI_CALLBACK_DEFERRED			1		//Callback is executed by spiEngine() in the main loop
+#define SPI_CALLBACK_SOFT_INT			2		//Callback is executed by deferISR() in the low priority software interrupt
+// =========================== //
+
+// == SPI Transaction Priority == //
+#define SPI_PRIORITY_LOW			0
+#define SPI_PRIORITY_NORMAL			1
+#define SPI_PRIORITY_HIGH			2
+#define SPI_PRIORITY_CRITICAL			3
+#define SPI_PRIORITY_NB				4		//Number of priority level (max 32)
+// ============================== //
+
 // == SPI Module Statue == //
 #define SPI_MODULE_READY			1
 #define SPI_MODULE_NOT_READY			0
@@ -369,44 +393,67 @@ typedef union
 }tSPIStatus;
 
 // Slave informations format
-typedef union
+typedef struct
 {
-	U64 all;
-	struct
+	union
 	{
-		union
+		U8 all;
+		struct
 		{
-			U8 all;
-			struct
-			{
-				U8 busy:1;	//Slave is busy flag
-				U8 lock:1;	//Slave is locked flag
-				U8 :7;
-			};
-		}control;
-		U8 spiPort;			//SPI port to which the Slave is attached
-		U16 SSpinMask;			//Mask to apply to that Port reg
-		volatile U32 * SSpinPort;	//Address of the Port reg the SS pin is on
-	};
+			U8 busy:1;		//Slave is busy flag
+			U8 lock:1;		//Slave is locked flag
+			U8 ownBus:1;		//Slave use its own bus parameters (set by spiSetSlaveConfig())
+			U8 :5;
+		};
+	}control;
+	U8 spiPort;				//SPI port to which the Slave is attached
+	U16 SSpinMask;				//Mask to apply to that Port reg
+	volatile U32 * SSpinPort;		//Address of the Port reg the SS pin is on
+
+	struct
+	{
+		U32 BRG;			//SPIxBRG value for this slave (only if control.ownBus)
+		U32 CON;			//SPIxCON bits for this slave (only SPI_BUS_CON_MASK bits, only if control.ownBus)
+		U32 SSsetupTick;		//Delay between SS assertion and the first clock (in core timer tick)
+		U32 SSholdTick;			//Delay between the last clock and SS release (in core timer tick)
+	}bus;
 }tSPISlaveControl;
 
-// Transaction format
+// Bus reconfiguration statistics
 typedef struct
 {
+	U32 reconfigNb;				//Number of time the bus was reprogrammed for a slave
+	U32 reconfigCycleMax;			//Longest reprogramming (in SYSCLK cycle)
+	U32 reconfigCycleLast;			//Last reprogramming (in SYSCLK cycle)
+	U32 kernelNb;				//Number of FIFO kernel call (only with SPI_KERNEL_STATS)
+	U32 kernelCycleMax;			//Longest FIFO kernel call (in SYSCLK cycle)
+	U32 kernelCycleTotal;			//Total time spent in the FIFO kernels (in SYSCLK cycle)
+}tSPIBusStats;
+
+// Transaction format
+typedef struct sSPITransaction
+{
+	struct sSPITransaction * next;		//Next transaction in the pending list (managed by the driver)
+	U8 priority;				//Priority level of this transaction (SPI_PRIORITY_x)
 	void * pRX;				//Receiving data pointer
 	void * pTX;				//Transmitting data pointer
 	U16 transferNb;				//Total number of transfer
 	U16 rxNbDone;				//Number of reception done
-	U16 txNbRemaining;			//Number of transmission done
+	U16 txNbRemaining;			//Number of transmission remaining
+	U16 txDataNb;				//Number of transmission remaining to take from pTX (the rest is filler)
+	U16 rxSkipNb;				//Number of reception remaining to discard before saving to pRX
+	U32 filler;				//Data sent once the TX data is done
 	tSPISlaveControl * pSlave;		//Selected Slave control pointer
-	
+	void (*callback)(struct sSPITransaction * transactionPtr, void * contextPtr);	//Completion callback (NULL if unused)
+	void * contextPtr;			//Context given to the completion callback
+
 	union
 	{
 		U8 all;
 		struct
 		{
 			U8 remove:1;		//This transaction information must be removed after completion
-			U8 :2;
+			U8 deferCallback:2;	//Where the completion callback is executed (SPI_CALLBACK_x)
 			U8 removable:1;		//This structure can be remove
 			U8 done:1;		//This transaction is done
 			U8 abort:1;		//Abort this transaction
@@ -416,6 +463,31 @@ typedef struct
 	}control;
 }tSPITransaction;
 
+// Slave engine statistics
+typedef struct
+{
+	U32 frameNb;				//Number of frame received (SS release)
+	U32 underrunNb;				//Number of frame padded with the filler because the response buffer ran empty
+	U32 overflowNb;				//Number of received byte lost because the request buffer was full
+}tSPISlaveStats;
+
+// Slave engine control
+typedef struct
+{
+	tRBufCtl * requestBuf;			//Byte received from the master
+	tRBufCtl * responseBuf;			//Byte to send to the master
+	volatile U32 * SSpinPort;		//Address of the PORT reg the SS pin is on
+	U16 SSpinMask;				//Mask to apply to that PORT reg
+	U8 filler;				//Byte sent when the response buffer is empty
+	U8 inFrame;				//SS is asserted by the master
+	U8 padding;				//Response ran empty in this frame, only the filler is sent until its end
+	U8 :8;
+	U16 frameByteNb;			//Number of byte received in the current frame
+	void (*frameEndFct)(U8 spiPort, U16 frameByteNb, void * contextPtr);	//Frame end callback (NULL if unused)
+	void * contextPtr;			//Context given to the frame end callback
+	tSPISlaveStats stats;
+}tSPISlaveEngine;
+
 // Transaction FSM states
 typedef enum
 {
@@ -439,6 +511,40 @@ typedef enum
 * @return	nothing
 */
 void spiMasterISR(U8 spiPort, U32 interruptFlags);
+
+/**
+* \fn		void spiEngine(void)
+* @brief	Execute the deferred completion callback of finished transactions
+* @note		This function must be in the infinite loop of the main if any callback use SPI_CALLBACK_DEFERRED
+*			or SPI_CALLBACK_SOFT_INT (callbacks the defer queue had no room for are executed here)
+*			Transaction flagged for removal are given back to the pool after their callback
+* @arg		nothing
+* @return	nothing
+*/
+void spiEngine(void);
+
+/**
+* \fn		void spiSlaveISR(U8 spiPort, U32 interruptFlags)
+* @brief	SPI Slave Engine, drain the RX FIFO in the request buffer and refill the TX FIFO from the response buffer
+* @note		This function must be placed in the correct ISR of a port started with spiSlaveStart()
+*			Use SPI_RX_BUF_INT_BUF_HALF_FULL and SPI_TX_BUF_INT_BUF_HALF_EMPTY to have time to react at high clock rate
+* @arg		U8 spiPort						Hardware SPI ID
+* @arg		U32 interruptFlags				Interrupt flags for the corresponding SPI port (Aligned to 0)
+* @return	nothing
+*/
+void spiSlaveISR(U8 spiPort, U32 interruptFlags);
+
+/**
+* \fn		void spiSlaveSSISR(U8 spiPort)
+* @brief	Frame the slave messages on the edges of the SS pin
+* @note		This function must be placed in the Change Notification ISR of the SS pin
+*			On SS release, the remaining byte are saved, the frame end callback is called and the TX FIFO is reloaded
+*			Response byte still in the TX FIFO at the end of a frame are discarded
+*			Once the response ran empty in a frame, the rest of the frame is padded with the filler
+* @arg		U8 spiPort						Hardware SPI ID
+* @return	nothing
+*/
+void spiSlaveSSISR(U8 spiPort);
 // =========================== //
 
 
@@ -501,7 +607,10 @@ U32 spiGetBaudRate(U8 spiPort);
 /**
 * \fn		U8 spiAddSlave(U8 spiPort, U32 * SSpinPortPtr, U32 SSpinPortMask)
 * @brief	Save communication information for a slave, return a pointer to the allocated structure
-* @note		If allocation failed, will return a NULL pointer
+* @note		The structure is taken from the slave pool (SPI_SLAVE_POOL_SIZE)
+*			The slave follow the baudrate and mode of the port (even if they are changed later),
+*			use spiSetSlaveConfig() to give it its own
+*			If allocation failed, will return a NULL pointer
 * @arg		U8 spiPort						SPI port the Slave is connected to
 * @arg		U32 * SSpinPortPtr				Pointer to the correct port register (ex: &LATA)
 * @arg		U32 SSpinPortMask				Mask to apply to the port register (ex: BIT0)
@@ -513,18 +622,68 @@ tSPISlaveControl * spiAddSlave(U8 spiPort, volatile U32 * SSpinPortPtr, U16 SSpi
 * \fn		void spiDelSlave(tSPISlaveControl * slavePtr)
 * @brief	Delete all communication information for a slave
 * @note		This function will not delete the slave if it is busy (will return STD_EC_BUSY)
+*			Return STD_EC_INVALID if the slave was not created by spiAddSlave()
 * @arg		tSPISlaveInfo * slavePtr		Pointer to the allocated memory
 * @return	U8 errorCode					STD Error Code (return STD_EC_SUCCESS if successful)
 */
 U8 spiDelSlave(tSPISlaveControl * slavePtr);
+
+/**
+* \fn		U8 spiSetSlaveConfig(tSPISlaveControl * slavePtr, U32 baudRate, U32 option, U32 SSsetupNs, U32 SSholdNs)
+* @brief	Save the bus parameters to use for a slave, they are applied by the SPI engine when this slave is selected
+* @note		The bus is only reprogrammed when the selected slave changes and its parameters differ from the actual ones
+*			Option are the data width, clock and data phase Init Option (ex: SPI_DATA_WIDTH_8BIT|SPI_CLK_IDLE_LOW|SPI_TX_DATA_ACTIVE_TO_IDLE)
+*			Delays are rounded up to the core timer resolution (2 SYSCLK), use 0 to disable them
+*			Delays are busy-waited in the SPI ISR, so they are limited to SPI_SS_DELAY_MAX_NS
+*			Return STD_EC_BUSY if the slave is busy, STD_EC_INVALID for a null baudrate,
+*			STD_EC_TOOLARGE for a delay over SPI_SS_DELAY_MAX_NS
+* @arg		tSPISlaveControl * slavePtr			Slave to configure
+* @arg		U32 baudRate					Clock rate for this slave (in bps)
+* @arg		U32 option					SPIxCON option for this slave
+* @arg		U32 SSsetupNs					Delay between SS assertion and the first clock (in ns)
+* @arg		U32 SSholdNs					Delay between the last clock and SS release (in ns)
+* @return	U8 errorCode					STD Error Code (return STD_EC_SUCCESS if successful)
+*/
+U8 spiSetSlaveConfig(tSPISlaveControl * slavePtr, U32 baudRate, U32 option, U32 SSsetupNs, U32 SSholdNs);
+
+/**
+* \fn		tSPIBusStats spiGetBusStats(U8 spiPort)
+* @brief	Return the bus reconfiguration and FIFO kernel statistics of a port
+* @note		Usefull to measure the cost of sharing a bus between slaves with different parameters
+*			The FIFO kernel statistics are only updated when SPI_KERNEL_STATS is defined
+* @arg		U8 spiPort					Hardware SPI ID
+* @return	tSPIBusStats busStats				Bus statistics
+*/
+tSPIBusStats spiGetBusStats(U8 spiPort);
+
+/**
+* \fn		tPoolCtl * spiGetSlavePool(void)
+* @brief	Return the pool control of the slave structures
+* @note		Use the pool functions to read the usage statistics (ex: poolGetPeakSpace(spiGetSlavePool()))
+* @arg		nothing
+* @return	tPoolCtl * poolCtlPtr						Slave pool control
+*/
+tPoolCtl * spiGetSlavePool(void);
+
+/**
+* \fn		tPoolCtl * spiGetTransactionPool(void)
+* @brief	Return the pool control of the transaction structures
+* @note		Use the pool functions to read the usage statistics (ex: poolGetPeakSpace(spiGetTransactionPool()))
+* @arg		nothing
+* @return	tPoolCtl * poolCtlPtr						Transaction pool control
+*/
+tPoolCtl * spiGetTransactionPool(void);
 // ========================== //
 
 
 // === Transfer Function ==== //
 /**
 * \fn		tSPITransaction * spiCreateTransaction(tSPISlaveControl * slavePtr, void * incomingPtr, void * outgoingPtr, U16 transferNb)
-* @brief	Create and init an SPI Transaction control structure in the heap
+* @brief	Create and init an SPI Transaction control structure in the transaction pool
 * @note		This function can be usefull for single shot communication or for dynamic slave
+*			The transaction is created with the SPI_PRIORITY_NORMAL priority
+*			The structure is taken from the transaction pool (SPI_TRANSACTION_POOL_SIZE), return NULL if it is empty
+*			A NULL incomingPtr discard all the received data, a NULL outgoingPtr send only SPI_FILLER
 * @arg		tSPISlaveControl * slavePtr					Slave to select for this transaction
 * @arg		void * incomingPtr							Pointer to store the incoming data
 * @arg		void * outgoingPtr							Pointer to load the outgoing data
@@ -533,15 +692,65 @@ U8 spiDelSlave(tSPISlaveControl * slavePtr);
 */
 tSPITransaction * spiCreateTransaction(tSPISlaveControl * slavePtr, void * incomingPtr, void * outgoingPtr, U16 transferNb);
 
+/**
+* \fn		tSPITransaction * spiCreateWriteRead(tSPISlaveControl * slavePtr, void * outgoingPtr, U16 txNb, void * incomingPtr, U16 rxNb)
+* @brief	Create and init a "write txNb then read rxNb" SPI Transaction in the transaction pool
+* @note		The transaction clock txNb+rxNb data in a single SS assertion
+*			The data received during the write part is discarded, SPI_FILLER is sent during the read part
+*			Buffers only need to be the size of their part (ex: 1 byte command, then read 32 byte)
+*			The transaction is created with the SPI_PRIORITY_NORMAL priority, return NULL if the pool is empty
+*			Return NULL if txNb+rxNb does not fit in 16bit
+* @arg		tSPISlaveControl * slavePtr					Slave to select for this transaction
+* @arg		void * outgoingPtr							Pointer to load the outgoing data (command, address...)
+* @arg		U16 txNb									Number of transfer to write
+* @arg		void * incomingPtr							Pointer to store the incoming data
+* @arg		U16 rxNb									Number of transfer to read
+* @return	tSPITransaction * tempSPITransactionPtr		Pointer to the transaction control structure
+*/
+tSPITransaction * spiCreateWriteRead(tSPISlaveControl * slavePtr, void * outgoingPtr, U16 txNb, void * incomingPtr, U16 rxNb);
+
 /**
 * \fn		U8 spiStartTransaction(tSPITransaction * transactionPtr)
-* @brief	Add a transaction to the pending list, and activate the SPI module
+* @brief	Add a transaction to the pending list of its priority, and activate the SPI module
 * @note		Return STD_EC_BUSY if the transaction was currently busy
+*			Return STD_EC_INVALID if the priority of the transaction is invalid
+*			The pending lists are linked through the transaction themselves, there is no depth limit
+*			Transaction of the same priority are processed in a FIFO manner
 * @arg		tSPITransaction * tempSPITransactionPtr		Pointer to the transaction control structure
 * @return	U8 errorCode								STD Error Code (return STD_EC_SUCCESS if successful)
 */
 U8 spiStartTransaction(tSPITransaction * transactionPtr);
 
+/**
+* \fn		U8 spiSetPriority(tSPITransaction * transactionPtr, U8 priority)
+* @brief	Set the priority of a transaction
+* @note		Higher value are processed first (SPI_PRIORITY_CRITICAL is the highest)
+*			Return STD_EC_BUSY if the transaction is pending or active (priority is not changed)
+*			Return STD_EC_INVALID if the priority is invalid
+* @arg		tSPITransaction * tempSPITransactionPtr		Pointer to the transaction control structure
+* @arg		U8 priority								Priority level (SPI_PRIORITY_x)
+* @return	U8 errorCode								STD Error Code (return STD_EC_SUCCESS if successful)
+*/
+U8 spiSetPriority(tSPITransaction * transactionPtr, U8 priority);
+
+/**
+* \fn		U8 spiSetCallback(tSPITransaction * transactionPtr, void (*callback)(tSPITransaction*, void*), void * contextPtr, U8 option)
+* @brief	Attach a completion callback to a transaction
+* @note		The callback receive the transaction and the context pointer, it is called when the transaction is done or aborted
+*			With SPI_CALLBACK_IN_ISR the callback run in the SPI ISR, it can start the next transaction directly
+*			With SPI_CALLBACK_DEFERRED the callback run in spiEngine()
+*			With SPI_CALLBACK_SOFT_INT the callback run in deferISR() (deferInit() must be done), the SPI ISR
+*			only post it, if the defer queue is full it fall back to spiEngine()
+*			Use a NULL callback to remove it
+*			Return STD_EC_BUSY if the transaction is pending or active, STD_EC_INVALID for an unknown option
+* @arg		tSPITransaction * tempSPITransactionPtr		Pointer to the transaction control structure
+* @arg		void (*callback)(tSPITransaction*, void*)	Function to call at completion
+* @arg		void * contextPtr							Context given to the callback
+* @arg		U8 option									Execution context (SPI_CALLBACK_x)
+* @return	U8 errorCode								STD Error Code (return STD_EC_SUCCESS if successful)
+*/
+U8 spiSetCallback(tSPITransaction * transactionPtr, void (*callback)(tSPITransaction*, void*), void * contextPtr, U8 option);
+
 /**
 * \fn		void spiAbortTransaction(tSPITransaction * transactionPtr)
 * @brief	This function flag the transaction for abortion
@@ -553,14 +762,91 @@ void spiAbortTransaction(tSPITransaction * transactionPtr);
 
 /**
 * \fn		U8 spiRemoveTransaction(tSPITransaction * transactionPtr)
-* @brief	Remove a transaction control structure from the heap
-* @note		Return STD_EC_INVALID if the transaction was not in the heap
+* @brief	Remove a transaction control structure from the transaction pool
+* @note		Return STD_EC_INVALID if the transaction was not in the transaction pool
 *			Return STD_EC_BUSY if the transaction was currently busy
 * @arg		tSPITransaction * tempSPITransactionPtr		Pointer to the transaction control structure
 * @return	U8 errorCode								STD Error Code (return STD_EC_SUCCESS if successful)
 */
 U8 spiRemoveTransaction(tSPITransaction * transactionPtr);
 // ========================== //
+
+// === Slave Functions ====== //
+/**
+* \fn		U8 spiSlaveStart(U8 spiPort, U16 requestSize, U16 responseSize, volatile U32 * SSpinPortPtr, U16 SSpinMask, U8 filler)
+* @brief	Create the slave buffers, start the SPI in slave mode and preload the TX FIFO
+* @note		The port must be configured with SPI_MODE_SLAVE|SPI_ENHANCED_BUF|SPI_DATA_WIDTH_8BIT|SPI_PIN_SS_ON
+*			The Change Notification of the SS pin must be configured in the main and call spiSlaveSSISR()
+*			Return STD_EC_INVALID if the port is not configured correctly, STD_EC_MEMORY if a buffer can't be created,
+*			STD_EC_BUSY if the slave engine is already started (use spiSlaveStop() first)
+*			Nothing is kept allocated if the start fail
+* @arg		U8 spiPort						Hardware SPI ID
+* @arg		U16 requestSize					Size of the request buffer (in byte)
+* @arg		U16 responseSize				Size of the response buffer (in byte)
+* @arg		volatile U32 * SSpinPortPtr		Pointer to the PORT reg of the SS pin (ex: &PORTB)
+* @arg		U16 SSpinMask					Mask to apply to the PORT reg (ex: BIT7)
+* @arg		U8 filler						Byte sent when the response buffer is empty
+* @return	U8 errorCode					STD Error Code (return STD_EC_SUCCESS if successful)
+*/
+U8 spiSlaveStart(U8 spiPort, U16 requestSize, U16 responseSize, volatile U32 * SSpinPortPtr, U16 SSpinMask, U8 filler);
+
+/**
+* \fn		U8 spiSlaveStop(U8 spiPort)
+* @brief	Stop the SPI slave engine of a port and delete its buffers
+* @note		Byte still in the buffers are lost
+*			Return STD_EC_INVALID if the slave engine is not started
+* @arg		U8 spiPort						Hardware SPI ID
+* @return	U8 errorCode					STD Error Code (return STD_EC_SUCCESS if successful)
+*/
+U8 spiSlaveStop(U8 spiPort);
+
+/**
+* \fn		void spiSlaveSetFrameCallback(U8 spiPort, void (*frameEndFct)(U8, U16, void*), void * contextPtr)
+* @brief	Set the function called (in the SS ISR) at the end of each frame
+* @note		The callback receive the port, the number of byte received in the frame and the context pointer
+*			Use a NULL function to remove it
+* @arg		U8 spiPort						Hardware SPI ID
+* @arg		void (*frameEndFct)(U8, U16, void*)	Frame end callback
+* @arg		void * contextPtr				Context given to the callback
+* @return	nothing
+*/
+void spiSlaveSetFrameCallback(U8 spiPort, void (*frameEndFct)(U8, U16, void*), void * contextPtr);
+
+/**
+* \fn		U8 spiSlaveWrite(U8 spiPort, U8 * dataPtr, U16 byteNb)
+* @brief	Queue byte to send to the master
+* @note		Return STD_EC_OVERFLOW if there is not enough space in the response buffer (nothing is queued)
+*			Outside of a frame, the TX FIFO is directly preloaded
+*			Byte queued in a frame that already ran empty are sent in the next frame
+*			Return STD_EC_INVALID if the slave engine is not started
+* @arg		U8 spiPort						Hardware SPI ID
+* @arg		U8 * dataPtr					Byte to send
+* @arg		U16 byteNb						Number of byte
+* @return	U8 errorCode					STD Error Code (return STD_EC_SUCCESS if successful)
+*/
+U8 spiSlaveWrite(U8 spiPort, U8 * dataPtr, U16 byteNb);
+
+/**
+* \fn		U16 spiSlaveRead(U8 spiPort, U8 * dataPtr, U16 maxNb)
+* @brief	Read the byte received from the master
+* @note
+* @arg		U8 spiPort						Hardware SPI ID
+* @arg		U8 * dataPtr					Destination of the byte
+* @arg		U16 maxNb						Maximum number of byte to read
+* @return	U16 byteNb						Number of byte read
+*/
+U16 spiSlaveRead(U8 spiPort, U8 * dataPtr, U16 maxNb);
+
+/**
+* \fn		tSPISlaveStats spiSlaveGetStats(U8 spiPort)
+* @brief	Return the statistics of the slave engine of a port
+* @note		A non-zero underrunNb mean the application did not queue the response fast enough
+*			(the end of those frames was padded with the filler)
+* @arg		U8 spiPort						Hardware SPI ID
+* @return	tSPISlaveStats slaveStats		Slave engine statistics
+*/
+tSPISlaveStats spiSlaveGetStats(U8 spiPort);
+// ========================== //
 // ############################################## //
 
 
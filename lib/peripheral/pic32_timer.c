@@ -3,7 +3,7 @@
  @brief		Hardware Timer control functions for C32
 
  @version	0.2.3
- @note		timerSetOverflow and timerGetOverflow are really cpu intensive use wisely
+ @note		timerSetOverflow, timerSetPeriod and timerGetOverflow use integer math only (64bit)
 		The "fast" Macro can be used with explicit argument only, no variable (ex: timerFastClear(0), not timerFastClear(variable))
  		The Timer 1 has only 4 prescaler option refer to the Clock Settings defines to see which one (all other timers have all the option)
 
@@ -58,6 +58,59 @@ U8 timerSelectPort(U8 timerPort)
 	}
 	return STD_EC_SUCCESS;
 }
+
+/**
+* \fn		U8 _timerSolvePeriod(U8 timerPort, U64 wholeTick, U64 fracTick, U32 fracDen, U64 * achievedTickPtr)
+* @brief	Find the smallest prescaler and the PR value for a period of (wholeTick + fracTick/fracDen) PBCLK tick
+* @note		Integer only, the count is rounded to the nearest
+*		The timer must be selected with timerSelectPort()
+* @arg		U8 timerPort			Hardware Timer ID
+* @arg		U64 wholeTick			Integer part of the period (in PBCLK tick)
+* @arg		U64 fracTick			Fractional part of the period (in PBCLK tick x fracDen)
+* @arg		U32 fracDen			Denominator of the fractional part
+* @arg		U64 * achievedTickPtr		Achieved period (in PBCLK tick, can be NULL)
+* @return	U8 errorCode			STD Error Code (return STD_EC_SUCCESS if successful)
+*/
+U8 _timerSolvePeriod(U8 timerPort, U64 wholeTick, U64 fracTick, U32 fracDen, U64 * achievedTickPtr)
+{
+	U8 timerDivID;
+	U8 timerDivIDmax = TMR_CKPS_NB;
+	U16 * pDivTable = (U16*)tmrPrescalerValue;
+	U32 divider;
+	U64 cntNb;
+
+	//Timer 1 is a special case
+	if (timerPort == TIMER_1)
+	{
+		timerDivIDmax = TMR1_CKPS_NB;
+		pDivTable = (U16*)tmr1PrescalerValue;
+	}
+
+	// -- Find the maximum frequency possible -- //
+	for (timerDivID = 0; timerDivID < timerDivIDmax; timerDivID++)
+	{
+		divider = pDivTable[timerDivID];
+
+		//Count = round((wholeTick + fracTick/fracDen) / divider)
+		cntNb = (wholeTick / divider) + ((((wholeTick % divider) * fracDen) + fracTick + (((U64)fracDen * divider) >> 1)) / ((U64)fracDen * divider));
+
+		if (cntNb <= ((U64)tmrMax[pTxCON->T32] + 1))
+		{
+			if (cntNb == 0)
+				return STD_EC_TOOSMALL;			//Shorter than half a count
+
+			pTxCON->TCKPS = timerDivID;			//Set the prescaler
+			*pPRx = (U32)(cntNb - 1);			//The period is PR+1 count
+
+			if (achievedTickPtr != NULL)
+				*achievedTickPtr = cntNb * divider;
+			return STD_EC_SUCCESS;
+		}
+	}
+	// ----------------------------------------- //
+
+	return STD_EC_TOOLARGE;						//We were not able to find a prescaler to fit this overflow period
+}
 // ############################################## //
 
 // ############### Timer Functions ############## //
@@ -239,23 +292,21 @@ U32 timerGetClock(U8 timerPort)
 }
 
 /**
-* \fn		U8 timerSetOverflow(U8 timerPort, U32 ovfPeriod)
+* \fn		U8 timerSetPeriod(U8 timerPort, U64 period, U64 * achievedPtr)
 * @brief	Set the timer overflow interrupt at the desired period
-* @note		This function will round up to the possible freq depending on the actual globalCLK.
+* @note		Integer only, the smallest prescaler that can reach the period is used (best resolution)
+*		and the count is rounded to the nearest.
 *		Only work if using the PBCLK as the clock source.
 *		Use the timerInit with the correct parameters for external clock source.
 * @arg		U8 timerPort			Hardware Timer ID
-* @arg		U32 ovfPeriod			Total Period between overflow (in us)
+* @arg		U64 period			Total Period between overflow (in ns)
+* @arg		U64 * achievedPtr		Achieved period (in ns, rounded, can be NULL)
 * @return	U8 errorCode			STD Error Code
 */
-U8 timerSetOverflow(U8 timerPort, F32 ovfPeriod)
+U8 timerSetPeriod(U8 timerPort, U64 period, U64 * achievedPtr)
 {
-	U8 timerDivID;
-	U8 timerDivIDmax = TMR_CKPS_NB;
-	U16 * pDivTable = (U16*)tmrPrescalerValue;
-	F32 cntPeriod = 0;
 	U32 tempPBCLK = clockGetPBCLK();
-	U8 okFlag = 0;
+	U64 achievedTick;
 	U8 errorCode;
 
 	// -- Select the correct Timer -- //
@@ -263,39 +314,62 @@ U8 timerSetOverflow(U8 timerPort, F32 ovfPeriod)
 	if (errorCode == STD_EC_SUCCESS)
 	// ------------------------------ //
 	{
+		if ((period / 1000000000) > 0xFFFFFFFF)
+			return STD_EC_TOOLARGE;
 
-		//Timer 1 is a special case
-		if (timerPort == TIMER_1)
-		{
-			timerDivIDmax = TMR1_CKPS_NB;
-			pDivTable = (U16*)tmr1PrescalerValue;
-		}
+		// -- Period (in PBCLK tick) = period * PBCLK / 10^9 -- //
+		errorCode = _timerSolvePeriod(timerPort, (period / 1000000000) * tempPBCLK, (period % 1000000000) * tempPBCLK, 1000000000, &achievedTick);
+		// ----------------------------------------------------- //
 
-		// -- Set the needed freq -- //
-		//Find the maximum frequency possible
-		for (timerDivID = 0; timerDivID < timerDivIDmax ;timerDivID++)
-		{
-			cntPeriod = (1000000/((F32)(tempPBCLK/(pDivTable[timerDivID]))));
-
-			if (ovfPeriod <= (cntPeriod * (tmrMax[pTxCON->T32] +1)))
-			{
-				pTxCON->TCKPS = timerDivID;		//Set the prescaler
-				okFlag = 1;
-				break;
-			}
-		}
-		if (!okFlag)
-			return STD_EC_TOOLARGE;				//We were not able to find a prescaler to fit this overflow period
-		// ------------------------- //
-
-		// -- Set the Overflow Match value -- //
-		*pPRx = (U32)(ovfPeriod / cntPeriod);
-		// ---------------------------------- //
+		// -- Convert back the achieved period -- //
+		if ((errorCode == STD_EC_SUCCESS) && (achievedPtr != NULL))
+			*achievedPtr = ((achievedTick / tempPBCLK) * 1000000000) + ((((achievedTick % tempPBCLK) * 1000000000) + (tempPBCLK >> 1)) / tempPBCLK);
+		// -------------------------------------- //
 	}
 
 	return errorCode;
 }
 
+/**
+* \fn		U8 timerSetPeriodTick(U8 timerPort, U64 tickNb, U64 * achievedPtr)
+* @brief	Set the timer overflow interrupt at the desired number of PBCLK tick
+* @note		Integer only, the smallest prescaler that can reach the period is used (best resolution)
+*		and the count is rounded to the nearest.
+*		Only work if using the PBCLK as the clock source.
+* @arg		U8 timerPort			Hardware Timer ID
+* @arg		U64 tickNb			Total Period between overflow (in PBCLK tick)
+* @arg		U64 * achievedPtr		Achieved period (in PBCLK tick, can be NULL)
+* @return	U8 errorCode			STD Error Code
+*/
+U8 timerSetPeriodTick(U8 timerPort, U64 tickNb, U64 * achievedPtr)
+{
+	U8 errorCode;
+
+	// -- Select the correct Timer -- //
+	errorCode = timerSelectPort(timerPort);
+	if (errorCode == STD_EC_SUCCESS)
+	// ------------------------------ //
+		errorCode = _timerSolvePeriod(timerPort, tickNb, 0, 1, achievedPtr);
+
+	return errorCode;
+}
+
+/**
+* \fn		U8 timerSetOverflow(U8 timerPort, U32 ovfPeriod)
+* @brief	Set the timer overflow interrupt at the desired period
+* @note		This function will round to the closest possible period depending on the actual PBCLK.
+*		Only work if using the PBCLK as the clock source.
+*		Use the timerInit with the correct parameters for external clock source.
+*		Use timerSetPeriod() for a finer period or to get the achieved period
+* @arg		U8 timerPort			Hardware Timer ID
+* @arg		U32 ovfPeriod			Total Period between overflow (in us)
+* @return	U8 errorCode			STD Error Code
+*/
+U8 timerSetOverflow(U8 timerPort, U32 ovfPeriod)
+{
+	return timerSetPeriod(timerPort, ((U64)ovfPeriod) * 1000, NULL);
+}
+
 /**
 * \fn		U32 timerGetOverflow(U8 timerPort)
 * @brief	Return the overflow period of the specified timer
@@ -306,17 +380,17 @@ U8 timerSetOverflow(U8 timerPort, F32 ovfPeriod)
 */
 U32 timerGetOverflow(U8 timerPort)
 {
-	F32 cntPeriod = 0;
+	U32 tempClock;
 
 	// -- Select the correct Timer -- //
 	if (timerSelectPort(timerPort) == STD_EC_SUCCESS)
 	// ------------------------------ //
 	{
-		// get the time for 1 count
-		cntPeriod = timerGetCntPeriod(timerPort);
+		tempClock = timerGetClock(timerPort);
 
-		// Compute the overflow period
-		return ((U32)(*pPRx * cntPeriod));
+		// Compute the overflow period (PR+1 count)
+		if (tempClock != 0)
+			return (U32)(((((U64)*pPRx) + 1) * 1000000 + (tempClock >> 1)) / tempClock);
 	}
 	return 0;
 }
@@ -367,9 +441,9 @@ U8 timerSetPR(U8 timerPort, U32 PRvalue)
 	{
 		// -- Set the correct data size -- //
 		if (pTxCON->T32)
-			*pPR32x = (PRvalue & 0xFF00)>>16;		//Save the MSpart to the odd timer
+			*pPR32x = (PRvalue & 0xFFFF0000)>>16;		//Save the MSpart to the odd timer
 
-		*pPRx = PRvalue & 0xFF;					//Save the LSpart to the even number
+		*pPRx = PRvalue & 0xFFFF;				//Save the LSpart to the even number
 		// ------------------------------- //
 	}
 
@@ -3,7 +3,7 @@
  @brief		Timer functions for pic32
 
  @version	0.2.3
- @note		timerSetOverflow and timerGetOverflow are really cpu intensive use wisely
+ @note		timerSetOverflow, timerSetPeriod and timerGetOverflow use integer math only (64bit)
  		The "fast" Macro can be used with explicit argument only, no variable (ex: timerFastClear(0), not timerFastClear(variable))
 		The Timer 1 has only 4 prescaler option refer to the Clock Settings defines to see which one (all other timers have all the option)
 
@@ -182,17 +182,45 @@ U8 timerGetSize(U8 timerPort);
 */
 U32 timerGetClock(U8 timerPort);
 
+/**
+* \fn		U8 timerSetPeriod(U8 timerPort, U64 period, U64 * achievedPtr)
+* @brief	Set the timer overflow interrupt at the desired period
+* @note		Integer only, the smallest prescaler that can reach the period is used (best resolution)
+*		and the count is rounded to the nearest.
+*		Only work if using the PBCLK as the clock source.
+*		Use the timerInit with the correct parameters for external clock source.
+* @arg		U8 timerPort			Hardware Timer ID
+* @arg		U64 period			Total Period between overflow (in ns)
+* @arg		U64 * achievedPtr		Achieved period (in ns, rounded, can be NULL)
+* @return	U8 errorCode			STD Error Code
+*/
+U8 timerSetPeriod(U8 timerPort, U64 period, U64 * achievedPtr);
+
+/**
+* \fn		U8 timerSetPeriodTick(U8 timerPort, U64 tickNb, U64 * achievedPtr)
+* @brief	Set the timer overflow interrupt at the desired number of PBCLK tick
+* @note		Integer only, the smallest prescaler that can reach the period is used (best resolution)
+*		and the count is rounded to the nearest.
+*		Only work if using the PBCLK as the clock source.
+* @arg		U8 timerPort			Hardware Timer ID
+* @arg		U64 tickNb			Total Period between overflow (in PBCLK tick)
+* @arg		U64 * achievedPtr		Achieved period (in PBCLK tick, can be NULL)
+* @return	U8 errorCode			STD Error Code
+*/
+U8 timerSetPeriodTick(U8 timerPort, U64 tickNb, U64 * achievedPtr);
+
 /**
 * \fn		U8 timerSetOverflow(U8 timerPort, U32 ovfPeriod)
 * @brief	Set the timer overflow interrupt at the desired period
-* @note		This function will round up to the possible freq depending on the actual globalCLK.
+* @note		This function will round to the closest possible period depending on the actual PBCLK.
 *		Only work if using the PBCLK as the clock source.
 *		Use the timerInit with the correct parameters for external clock source.
+*		Use timerSetPeriod() for a finer period or to get the achieved period
 * @arg		U8 timerPort			Hardware Timer ID
 * @arg		U32 ovfPeriod			Total Period between overflow (in us)
 * @return	U8 errorCode			STD Error Code
 */
-U8 timerSetOverflow(U8 timerPort, F32 ovfPeriod);
+U8 timerSetOverflow(U8 timerPort, U32 ovfPeriod);
 
 /**
 * \fn		U32 timerGetOverflow(U8 timerPort)
@@ -0,0 +1,47 @@
+/*!
+ @file		pic18_crc.h
+ @brief		CRC lib for C18, computed by software
+
+ @version	0.1
+ @note		Use slice-by-4 tables in Rom (4 byte per step), give the same result as the pic32 lib
+ 		Check value of each type (CRC of the ASCII "123456789"):
+ 		CRC_TYPE_16_CCITT: 0x29B1 | CRC_TYPE_16_MODBUS: 0x4B37 | CRC_TYPE_32: 0xCBF43926
+
+ @date		October 19th 2026
+ @author	Laurence DV
+*/
+
+#ifndef _PIC18_CRC_H
+#define _PIC18_CRC_H
+// ################## Includes ################## //
+// Definition
+#include <definition/datatype_megaxone.h>
+#include <definition/stddef_megaxone.h>
+// ############################################## //
+
+
+// ################## Defines ################### //
+// ==== CRC Type ==== //
+#define CRC_TYPE_16_CCITT			0		//Poly 0x1021, init 0xFFFF, MSb first, no final xor (CCITT-FALSE)
+#define CRC_TYPE_16_MODBUS			1		//Poly 0x8005, init 0xFFFF, LSb first, no final xor
+#define CRC_TYPE_32				2		//Poly 0x04C11DB7, init 0xFFFFFFFF, LSb first, final xor 0xFFFFFFFF (Ethernet, zip)
+#define CRC_TYPE_NB				3
+// ================== //
+// ############################################## //
+
+
+// ################# Prototypes ################# //
+/**
+* \fn		U32 crcCompute(U8 type, U8 * dataPtr, U16 size)
+* @brief	Compute the CRC of a buffer in Ram
+* @note		The result is the final CRC (final xor applied)
+*			Return 0 for an invalid type
+* @arg		U8 type					CRC type (CRC_TYPE_x)
+* @arg		U8 * dataPtr				Buffer to compute
+* @arg		U16 size				Size of the buffer (in byte)
+* @return	U32 crc					Computed CRC
+*/
+U32 crcCompute(U8 type, U8 * dataPtr, U16 size);
+// ############################################## //
+
+#endif
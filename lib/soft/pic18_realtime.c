@@ -25,7 +25,7 @@ extern U32 globalCLK;
 extern U16 globalCLKps;
 
 // Timer control
-rom const U8 rtTimerPrescaler[TMR0_PRESCALER_NB] = {1,2,4,8,16,32,64,128,256};
+rom const U16 rtTimerPrescaler[TMR0_PRESCALER_NB] = {1,2,4,8,16,32,64,128,256};
 U16 rtTimerInitValue = 0;
 S8 tickOffset = -24;									//Offset of 1 sysTick (in s)
 
@@ -77,7 +77,8 @@ void realTimeISR(void)
 /**
 * \fn		U8 realTimeInit(U32 tickPeriod)
 * @brief	Initialised the Real-Time system to a specified tick period
-* @note		Intensive Computation, used only at init time.
+* @note		Integer computation only (32bit), used only at init time.
+*		The tick period is rounded to the closest timer count.
 *			Keep the value between 100 and 64 535 000 to be accurate and useful
 *			Use the Timer 0
 *			Use a dividable number by 1000 to assure precision of the software rtcc
@@ -88,9 +89,11 @@ U8 realTimeInit(U32 tickPeriod)
 {
 	U8 wu0;
 	U8 prescalerID;
-	F32 tickPeriodus = (tickPeriod+tickOffset);			//Desired tick period in s (offsetted for real-life exactness)
-	F32 timerCNTus;										//Count period of the timer in s
-	F32 timerOVFus;										//Overflow period of the timer in s
+	U32 tickPeriodus = (tickPeriod+tickOffset);			//Desired tick period in s (offsetted for real-life exactness)
+	U32 instCLK;										//Instruction clock (in Hz)
+	U32 halfCycleNb;									//Desired tick period (in half instruction cycle)
+	U32 cntNb = 0;										//Desired tick period (in timer count)
+	U32 msPart, usPart;
 
 	// -- Save the value of a sysTick in ms -- //
 	sysTickValue = tickPeriod/1000;						//Should not be more than 64 535
@@ -110,19 +113,30 @@ U8 realTimeInit(U32 tickPeriod)
 	// -------------------------- //
 
 	
+	// -- Convert the tick period in half instruction cycle -- //
+	// halfCycleNb = floor(tickPeriodus * instCLK / 500 000), split to stay in 32bit
+	// Working in half cycle give an exact rounding of the count for every prescaler
+	instCLK = globalCLK>>2;
+	halfCycleNb = (tickPeriodus / 1000000) * (instCLK<<1);		//Whole seconds
+	tickPeriodus %= 1000000;
+	halfCycleNb += tickPeriodus * (instCLK / 500000);		//Whole 500kHz of the remaining s
+	msPart = (tickPeriodus / 1000) * (instCLK % 500000);		//Remaining Hz (ms part x1000)
+	usPart = (tickPeriodus % 1000) * (instCLK % 500000);		//Remaining Hz (s part)
+	halfCycleNb += (msPart / 500) + ((((msPart % 500) * 1000) + usPart) / 500000);
+	// -------------------------------------------------------- //
+
+
 	// -- Search the correct Timer Prescaler -- //
 	for (prescalerID = 0; prescalerID < TMR0_PRESCALER_NB; prescalerID++)
 	{
-		timerCNTus = (1/((F32)((globalCLK>>2)/rtTimerPrescaler[prescalerID])))*1000000;	//Compute the Count period with a new prescaler value (in s)
-		timerOVFus = (timerCNTus*65536);				//Compute the overflow period (in s)
-		
-		if (timerOVFus > tickPeriodus)					//Check if the overflow period is greater than the desired tick period
+		cntNb = (halfCycleNb + rtTimerPrescaler[prescalerID]) / ((U32)rtTimerPrescaler[prescalerID]<<1);	//Tick period in count (rounded)
+
+		if (cntNb < 65536)						//Check if the overflow period is greater than the desired tick period
 			break;
-		Nop();
 	}
 
 	//Return error if overflow period is not enough
-	if (timerOVFus < tickPeriodus)
+	if (prescalerID >= TMR0_PRESCALER_NB)
 		return STD_EC_TOOLARGE;
 
 	if (prescalerID)
@@ -131,7 +145,7 @@ U8 realTimeInit(U32 tickPeriod)
 
 
 	// -- Compute the Timer Init value -- //
-	rtTimerInitValue = (U16)((timerOVFus - tickPeriodus)/timerCNTus)-1;
+	rtTimerInitValue = (U16)(65536 - cntNb)-1;
 	// ---------------------------------- //
 
 	// -- Reset the Up Time -- //
@@ -80,7 +80,8 @@ void realTimeISR(void);
 /**
 * \fn		U8 realTimeInit(U16 tickPeriod)
 * @brief	Initialised the Real-Time system to a specified tick period
-* @note		Intensive Computation, used only at init time.
+* @note		Integer computation only (32bit), used only at init time.
+*		The tick period is rounded to the closest timer count.
 * @arg		U16 tickPeriod		Period of a tick (in s)
 * @return	U8 errorCode		STD Error Code (return STD_EC_SUCCESS if successful)
 */
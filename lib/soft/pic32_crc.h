@@ -0,0 +1,157 @@
+/*!
+ @file		pic32_crc.h
+ @brief		CRC lib for pic32, computed by the DMA CRC engine or by software
+
+ @version	0.1
+ @note		The software CRC use slice-by-4 tables (4 byte per step), it give the same result as the DMA engine
+ 		The DMA engine compute in background, the CRC is given to a callback called from dmaISR()
+ 		Check value of each type (CRC of the ASCII "123456789"):
+ 		CRC_TYPE_16_CCITT: 0x29B1 | CRC_TYPE_16_MODBUS: 0x4B37 | CRC_TYPE_32: 0xCBF43926
+
+ @date		October 19th 2026
+ @author	Laurence DV
+*/
+
+#ifndef _PIC32_CRC_H
+#define _PIC32_CRC_H 1
+
+// ################## Includes ################## //
+// Hardware
+#include <hardware.h>
+
+// Librairies
+#include <peripheral/pic32_dma.h>
+
+// Definition
+#include <definition/stddef_megaxone.h>
+#include <definition/datatype_megaxone.h>
+// ############################################## //
+
+
+// ################## Defines ################### //
+// == Application dependant == //
+#ifndef CRC_DMA_THRESHOLD
+	#define CRC_DMA_THRESHOLD		64		//Buffer smaller than this (in byte) are computed by software
+#endif
+#ifndef CRC_DMA_PRIORITY
+	#define CRC_DMA_PRIORITY		DMA_PRIORITY_0	//Channel priority of the CRC transfer
+#endif
+// ============================ //
+
+// == Hardware dependant == //
+#if CPU_FAMILY == PIC32MX3xx || CPU_FAMILY == PIC32MX4xx
+	#define CRC_DMA_MAX_WIDTH		16		//Maximum polynomial length of the engine
+	#define CRC_DMA_REFLECT			0		//Engine can shift LSb first
+#else
+	#define CRC_DMA_MAX_WIDTH		32		//Maximum polynomial length of the engine
+	#define CRC_DMA_REFLECT			1		//Engine can shift LSb first
+#endif
+// ======================== //
+
+// ==== CRC Type ==== //
+#define CRC_TYPE_16_CCITT			0		//Poly 0x1021, init 0xFFFF, MSb first, no final xor (CCITT-FALSE)
+#define CRC_TYPE_16_MODBUS			1		//Poly 0x8005, init 0xFFFF, LSb first, no final xor
+#define CRC_TYPE_32				2		//Poly 0x04C11DB7, init 0xFFFFFFFF, LSb first, final xor 0xFFFFFFFF (Ethernet, zip)
+#define CRC_TYPE_NB				3
+// ================== //
+// ############################################## //
+
+
+// ################# Data Type ################## //
+//CRC type description
+typedef struct
+{
+	U32 polynomial;				//Polynomial (normal form, MSb first)
+	U32 init;				//Initial value
+	U32 xorOut;				//Value xored with the final result
+	U32 check;				//CRC of the ASCII "123456789" (reference vector)
+	const void * tablePtr;			//Slice-by-4 table (U16 or U32 [4][256])
+	U8 width;				//Polynomial length (in bit)
+	U8 reflected;				//1: LSb first | 0: MSb first
+}tCRCType;
+
+//CRC engine control
+typedef struct
+{
+	const U8 * sourcePtr;			//Source of the next chunk
+	U32 remainingSize;			//Byte left to compute
+	void (*callback)(U8 errorCode, U32 crc, void * contextPtr);	//Completion callback (NULL if unused)
+	void * contextPtr;			//Context given to the callback
+	U8 type;				//CRC type in progress
+	U8 channel;				//DMA channel used
+	U8 busy;				//1: Engine is computing
+}tCRCEngineCtl;
+// ############################################## //
+
+
+// ################# Prototypes ################# //
+// === Software Functions ==== //
+/**
+* \fn		U32 crcCompute(U8 type, const void * dataPtr, U32 size)
+* @brief	Compute the CRC of a buffer by software (blocking)
+* @note		Use slice-by-4 tables, the result is the final CRC (final xor applied)
+*			Return 0 for an invalid type
+* @arg		U8 type					CRC type (CRC_TYPE_x)
+* @arg		const void * dataPtr			Buffer to compute
+* @arg		U32 size				Size of the buffer (in byte)
+* @return	U32 crc					Computed CRC
+*/
+U32 crcCompute(U8 type, const void * dataPtr, U32 size);
+// =========================== //
+
+
+// === DMA Functions ========= //
+/**
+* \fn		U8 crcComputeAsync(U8 channel, U8 type, const void * dataPtr, U32 size, void (*callback)(U8, U32, void*), void * contextPtr)
+* @brief	Compute the CRC of a buffer with the DMA CRC engine, without blocking the CPU
+* @note		The channel must be allocated and its interrupt priority set, dmaISR() must be in its ISR
+*			A buffer bigger than DMA_MAX_SIZE is computed in chunks, the engine keep the CRC between them
+*			Below CRC_DMA_THRESHOLD byte, or if the engine cannot do this type, the CRC is computed by
+*			software and the callback is called before returning
+*			Callback receive STD_EC_SUCCESS (or STD_EC_FAIL on a DMA address error), the CRC and the context
+*			Return STD_EC_BUSY if the engine is already computing (there is only 1 engine)
+* @arg		U8 channel				DMA channel number
+* @arg		U8 type					CRC type (CRC_TYPE_x)
+* @arg		const void * dataPtr			Buffer to compute (RAM or Flash)
+* @arg		U32 size				Size of the buffer (in byte)
+* @arg		void (*callback)(U8, U32, void*)	Completion callback
+* @arg		void * contextPtr			Context given to the callback
+* @return	U8 errorCode				STD Error Code (return STD_EC_SUCCESS if successful)
+*/
+U8 crcComputeAsync(U8 channel, U8 type, const void * dataPtr, U32 size, void (*callback)(U8, U32, void*), void * contextPtr);
+
+/**
+* \fn		U8 crcIsBusy(void)
+* @brief	Return the state of the DMA CRC engine
+* @note
+* @arg		nothing
+* @return	U8 busy					1: Engine is computing | 0: Engine is free
+*/
+U8 crcIsBusy(void);
+
+/**
+* \fn		U8 crcSelfTest(U8 channel)
+* @brief	Check the software tables and the DMA CRC engine configuration against the reference vector
+* @note		Compute the CRC of the ASCII "123456789" for each type, by software and with the engine (blocking),
+*			and compare them with the check value of the type. Types the engine cannot do are only checked by software
+*			The channel callback is removed, it is set again by the next crcComputeAsync()
+*			Return STD_EC_FAIL on the first mismatch, STD_EC_BUSY if the engine is computing
+* @arg		U8 channel				DMA channel number (allocated)
+* @return	U8 errorCode				STD Error Code (return STD_EC_SUCCESS if successful)
+*/
+U8 crcSelfTest(U8 channel);
+// =========================== //
+// ############################################## //
+
+
+// ############### Internal Define ############## //
+// DCRCCON bits
+#define CRC_MASK_CRCCH				(BIT0|BIT1|BIT2)
+#define CRC_MASK_CRCTYP				BIT5
+#define CRC_MASK_CRCAPP				BIT6
+#define CRC_MASK_CRCEN				BIT7
+#define CRC_POS_PLEN				8
+#define CRC_MASK_BITO				BIT24
+// ############################################## //
+
+#endif
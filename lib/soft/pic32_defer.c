@@ -0,0 +1,222 @@
+/*!
+ @file		pic32_defer.c
+ @brief		Deferred interrupt work queue (bottom halves) for pic32
+
+ @version	0.1
+ @note		An ISR post a (function, argument) item with deferPost() and return immediately,
+ 		the item is executed later by deferISR() in a low priority core software interrupt.
+ 		deferPost() is lock-free (no global interrupt disable) and can be called from any interrupt level,
+ 		the queue is drained by a single consumer (deferISR)
+ 		The queue size must be a power of 2
+
+ @date		October 19th 2026
+ @author	Laurence DV
+*/
+
+// ################## Includes ################## //
+#include "pic32_defer.h"
+// ############################################## //
+
+
+// ################## Variables ################# //
+tDeferItem deferQueue[DEFER_QUEUE_SIZE];				//Item storage
+volatile U32 deferHead = 0;						//Next slot to reserve (free running)
+volatile U32 deferTail = 0;						//Next slot to execute (free running)
+volatile U32 deferPendingNb = 0;					//Reserved and not executed item
+tDeferStats deferStats;							//Statistics of the queue
+// ############################################## //
+
+
+// ############## Defer Functions ############### //
+// ==== Control Functions ==== //
+/**
+* \fn		U8 deferInit(void)
+* @brief	Initialise the deferred work queue and its core software interrupt
+* @note		The interrupt priority is set to DEFER_INT_PRIORITY
+*		WARNING: Pending items are discarded
+* @arg		nothing
+* @return	U8 errorCode			STD Error Code (return STD_EC_SUCCESS if successful)
+*/
+U8 deferInit(void)
+{
+	U16 wu0;
+	U32 intState;
+
+	// Disable Global Interrupt
+	intState = intFastDisableGlobal();
+
+	// -- Empty the queue -- //
+	for (wu0 = 0; wu0 < DEFER_QUEUE_SIZE; wu0++)
+	{
+		deferQueue[wu0].function = NULL;
+		deferQueue[wu0].argPtr = NULL;
+		deferQueue[wu0].ready = 0;
+	}
+	deferHead = 0;
+	deferTail = 0;
+	deferPendingNb = 0;
+
+	deferStats.peakNb = 0;
+	deferStats.failNb = 0;
+	deferStats.doneNb = 0;
+	// --------------------- //
+
+	// -- Init the software interrupt -- //
+	_CP0_BIC_CAUSE(DEFER_CAUSE_MASK);				//No request pending
+	intFastClearFlag(DEFER_INT_ID);
+	intFastSetPriority(DEFER_INT_ID, DEFER_INT_PRIORITY);
+	intFastSetSubPriority(DEFER_INT_ID, 0);
+	intFastEnable(DEFER_INT_ID);
+	// --------------------------------- //
+
+	// Restore Interrupt state
+	intFastRestoreGlobal(intState);
+
+	return STD_EC_SUCCESS;
+}
+
+/**
+* \fn		U8 deferPost(void (*function)(void*), void * argPtr)
+* @brief	Queue a function to be executed later in the deferred interrupt
+* @note		Lock-free, can be called from any ISR (or from the main)
+*		Return STD_EC_INVALID if function is NULL and STD_EC_OVERFLOW if the queue is full (counted in stats.failNb)
+*		Items posted from the same interrupt level are executed in order
+* @arg		void (*function)(void*)		Function to execute
+* @arg		void * argPtr			Argument given to the function
+* @return	U8 errorCode			STD Error Code (return STD_EC_SUCCESS if successful)
+*/
+U8 deferPost(void (*function)(void*), void * argPtr)
+{
+	U32 pendingNb;
+	tDeferItem * itemPtr;
+
+	if (function == NULL)
+		return STD_EC_INVALID;
+
+	// -- Reserve a place in the queue -- //
+	do
+	{
+		pendingNb = deferPendingNb;
+		if (pendingNb >= DEFER_QUEUE_SIZE)
+		{
+			deferStats.failNb++;				//Queue is full
+			return STD_EC_OVERFLOW;
+		}
+	}while (!__sync_bool_compare_and_swap(&deferPendingNb, pendingNb, pendingNb+1));
+
+	if ((pendingNb+1) > deferStats.peakNb)
+		deferStats.peakNb = pendingNb+1;
+	// ---------------------------------- //
+
+	// -- Fill the reserved slot -- //
+	itemPtr = &deferQueue[__sync_fetch_and_add(&deferHead, 1) & DEFER_QUEUE_MASK];
+	itemPtr->function = function;
+	itemPtr->argPtr = argPtr;
+	__sync_synchronize();
+	itemPtr->ready = 1;						//Publish the item
+	// ---------------------------- //
+
+	// Request the software interrupt
+	_CP0_BIS_CAUSE(DEFER_CAUSE_MASK);
+
+	return STD_EC_SUCCESS;
+}
+
+/**
+* \fn		U16 deferGetPending(void)
+* @brief	Return the number of item waiting in the queue
+* @note
+* @arg		nothing
+* @return	U16 pendingNb			Posted item not yet executed
+*/
+U16 deferGetPending(void)
+{
+	return deferPendingNb;
+}
+
+/**
+* \fn		tDeferStats * deferGetStats(void)
+* @brief	Return the statistics of the queue
+* @note		Usefull to size DEFER_QUEUE_SIZE of an application
+* @arg		nothing
+* @return	tDeferStats * statsPtr		Statistics of the queue
+*/
+tDeferStats * deferGetStats(void)
+{
+	return &deferStats;
+}
+
+/**
+* \fn		void deferResetStats(void)
+* @brief	Reset the statistics of the queue
+* @note		The peak is reset to the actual pending number
+* @arg		nothing
+* @return	nothing
+*/
+void deferResetStats(void)
+{
+	deferStats.peakNb = deferPendingNb;
+	deferStats.failNb = 0;
+	deferStats.doneNb = 0;
+}
+// =========================== //
+
+
+// === Interrupt Handler ===== //
+/**
+* \fn		void deferISR(void)
+* @brief	Interrupt Service Routine of the deferred work queue, execute every pending item
+* @note		Place it in the DEFER_INT_VECTOR vector at DEFER_INT_PRIORITY
+* @arg		nothing
+* @return	nothing
+*/
+/*	Vector Example (the IPL must match DEFER_INT_PRIORITY)
+ void __ISR(DEFER_INT_VECTOR, IPL1SOFT)deferVectorISR(void)
+{
+	deferISR();
+}*/
+/*	Posting Example (heavy part of an ADC interrupt moved out of the ISR)
+ void adcWork(void * argPtr)
+{
+	adcEngine((U8)(U32)argPtr);
+}
+
+ void __ISR(_ADC_VECTOR, IPL5SOFT)adcVectorISR(void)
+{
+	adcISR(ADC_1);
+	deferPost(adcWork, (void*)ADC_1);
+	intFastClearFlag(INT_ADC_1);
+}*/
+
+void deferISR(void)
+{
+	tDeferItem * itemPtr;
+	void (*function)(void*);
+	void * argPtr;
+
+	// -- Acknowledge the request -- //
+	_CP0_BIC_CAUSE(DEFER_CAUSE_MASK);				//Must be cleared before the flag
+	intFastClearFlag(DEFER_INT_ID);
+	// ----------------------------- //
+
+	// -- Execute every published item -- //
+	itemPtr = &deferQueue[deferTail & DEFER_QUEUE_MASK];
+	while (itemPtr->ready)						//Stop on a slot still being written, its producer will request again
+	{
+		function = itemPtr->function;
+		argPtr = itemPtr->argPtr;
+		itemPtr->ready = 0;
+
+		// Free the slot
+		deferTail++;
+		__sync_fetch_and_sub(&deferPendingNb, 1);
+
+		function(argPtr);
+		deferStats.doneNb++;
+
+		itemPtr = &deferQueue[deferTail & DEFER_QUEUE_MASK];
+	}
+	// ---------------------------------- //
+}
+// =========================== //
+// ############################################## //
@@ -0,0 +1,155 @@
+/*!
+ @file		pic32_defer.h
+ @brief		Deferred interrupt work queue (bottom halves) for pic32
+
+ @version	0.1
+ @note		An ISR post a (function, argument) item with deferPost() and return immediately,
+ 		the item is executed later by deferISR() in a low priority core software interrupt.
+ 		deferPost() is lock-free (no global interrupt disable) and can be called from any interrupt level,
+ 		the queue is drained by a single consumer (deferISR)
+ 		The queue size must be a power of 2
+
+ @date		October 19th 2026
+ @author	Laurence DV
+*/
+
+#ifndef _PIC32_DEFER_H
+#define _PIC32_DEFER_H 1
+// ################## Includes ################## //
+// Lib
+#include <peripheral/pic32_interrupt.h>
+
+// Definition
+#include <definition/stddef_megaxone.h>
+#include <definition/datatype_megaxone.h>
+// ############################################## //
+
+
+// ################## Defines ################### //
+// Number of item in the queue (must be a power of 2)
+#ifndef DEFER_QUEUE_SIZE
+	#define DEFER_QUEUE_SIZE			16
+#endif
+#define DEFER_QUEUE_MASK			(DEFER_QUEUE_SIZE-1)
+
+#if (DEFER_QUEUE_SIZE & DEFER_QUEUE_MASK) || (DEFER_QUEUE_SIZE > 256)
+	#error "DEFER_QUEUE_SIZE must be a power of 2 (at most 256)"
+#endif
+
+// Core software interrupt used to drain the queue (0 or 1)
+#ifndef DEFER_SOFT_INT_ID
+	#define DEFER_SOFT_INT_ID			0
+#endif
+
+#if DEFER_SOFT_INT_ID == 0
+	#define DEFER_INT_ID				INT_CORE_SOFT_0
+	#define DEFER_IRQ_ID				IRQ_CORE_SOFT_0
+	#define DEFER_INT_VECTOR			INT_VEC_CORE_SOFT_0
+	#define DEFER_CAUSE_MASK			BIT8		//Cause.IP0
+#elif DEFER_SOFT_INT_ID == 1
+	#define DEFER_INT_ID				INT_CORE_SOFT_1
+	#define DEFER_IRQ_ID				IRQ_CORE_SOFT_1
+	#define DEFER_INT_VECTOR			INT_VEC_CORE_SOFT_1
+	#define DEFER_CAUSE_MASK			BIT9		//Cause.IP1
+#else
+	#error "DEFER_SOFT_INT_ID must be 0 or 1"
+#endif
+
+// Priority of the draining interrupt (keep it under every posting interrupt)
+#ifndef DEFER_INT_PRIORITY
+	#define DEFER_INT_PRIORITY			1
+#endif
+
+#if (DEFER_INT_PRIORITY < 1) || (DEFER_INT_PRIORITY > 7)
+	#error "DEFER_INT_PRIORITY must be between 1 and 7"
+#endif
+// ############################################## //
+
+
+// ################# Data Type ################## //
+// Deferred item //
+typedef struct
+{
+	void (*function)(void*);		//Function to execute
+	void * argPtr;				//Argument given to the function
+	volatile U8 ready;			//Item is completely written by the producer
+}tDeferItem;
+// ------------- //
+
+// Queue statistics //
+typedef struct
+{
+	U16 peakNb;				//Maximum number of pending item at the same time
+	U16 failNb;				//Number of refused post (queue full)
+	U32 doneNb;				//Number of executed item
+}tDeferStats;
+// ---------------- //
+// ############################################## //
+
+
+// ################# Prototypes ################# //
+// ==== Control Functions ==== //
+/**
+* \fn		U8 deferInit(void)
+* @brief	Initialise the deferred work queue and its core software interrupt
+* @note		The interrupt priority is set to DEFER_INT_PRIORITY
+*		WARNING: Pending items are discarded
+* @arg		nothing
+* @return	U8 errorCode			STD Error Code (return STD_EC_SUCCESS if successful)
+*/
+U8 deferInit(void);
+
+/**
+* \fn		U8 deferPost(void (*function)(void*), void * argPtr)
+* @brief	Queue a function to be executed later in the deferred interrupt
+* @note		Lock-free, can be called from any ISR (or from the main)
+*		Return STD_EC_INVALID if function is NULL and STD_EC_OVERFLOW if the queue is full (counted in stats.failNb)
+*		Items posted from the same interrupt level are executed in order
+* @arg		void (*function)(void*)		Function to execute
+* @arg		void * argPtr			Argument given to the function
+* @return	U8 errorCode			STD Error Code (return STD_EC_SUCCESS if successful)
+*/
+U8 deferPost(void (*function)(void*), void * argPtr);
+
+/**
+* \fn		U16 deferGetPending(void)
+* @brief	Return the number of item waiting in the queue
+* @note
+* @arg		nothing
+* @return	U16 pendingNb			Posted item not yet executed
+*/
+U16 deferGetPending(void);
+
+/**
+* \fn		tDeferStats * deferGetStats(void)
+* @brief	Return the statistics of the queue
+* @note		Usefull to size DEFER_QUEUE_SIZE of an application
+* @arg		nothing
+* @return	tDeferStats * statsPtr		Statistics of the queue
+*/
+tDeferStats * deferGetStats(void);
+
+/**
+* \fn		void deferResetStats(void)
+* @brief	Reset the statistics of the queue
+* @note		The peak is reset to the actual pending number
+* @arg		nothing
+* @return	nothing
+*/
+void deferResetStats(void);
+// =========================== //
+
+
+// === Interrupt Handler ===== //
+/**
+* \fn		void deferISR(void)
+* @brief	Interrupt Service Routine of the deferred work queue, execute every pending item
+* @note		Place it in the DEFER_INT_VECTOR vector at DEFER_INT_PRIORITY
+* @arg		nothing
+* @return	nothing
+*/
+void deferISR(void);
+// =========================== //
+// ############################################## //
+
+#endif
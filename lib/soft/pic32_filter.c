@@ -0,0 +1,300 @@
+/*!
+ @file		pic32_filter.c
+ @brief		Fixed-point sample filter lib for pic32
+
+ @version	0.1
+ @note		All the filters use integer only and never divide (power of 2 windows use shifts)
+ 		A filter is a small control struct, declared by the user and initialised with filterInitx()
+ 		Samples are unsigned, FILTER_SAMPLE_BIT wide (ADC result, 16 bit max), block processing add 2 samples per 32 bit operation
+
+ @date		October 19th 2026
+ @author	Laurence DV
+*/
+
+// ################## Includes ################## //
+#include "pic32_filter.h"
+// ############################################## //
+
+
+// ############# Filter Functions ############### //
+// ==== Control Functions ==== //
+/**
+* \fn		U8 filterInitBoxcar(tFilter * filterPtr, U8 shift)
+* @brief	Initialise a boxcar filter, average 2^shift samples and give 1 output
+* @note		Return STD_EC_INVALID if shift is bigger than FILTER_SHIFT_MAX
+* @arg		tFilter * filterPtr			Filter to initialise
+* @arg		U8 shift				Log2 of the number of sample averaged
+* @return	U8 errorCode				STD Error Code (return STD_EC_SUCCESS if successful)
+*/
+U8 filterInitBoxcar(tFilter * filterPtr, U8 shift)
+{
+	if (shift > FILTER_SHIFT_MAX)
+		return STD_EC_INVALID;
+
+	filterPtr->type = FILTER_TYPE_BOXCAR;
+	filterPtr->shift = shift;
+	filterPtr->countMax = 1 << shift;
+	filterPtr->windowPtr = NULL;
+	filterReset(filterPtr);
+
+	return STD_EC_SUCCESS;
+}
+
+/**
+* \fn		U8 filterInitMovingAverage(tFilter * filterPtr, U16 * windowPtr, U8 shift)
+* @brief	Initialise a moving average filter over a circular window of 2^shift samples
+* @note		The window must have 2^shift elements, it is cleared here (the output start from 0)
+*			Return STD_EC_INVALID if shift is bigger than FILTER_SHIFT_MAX or windowPtr is NULL
+* @arg		tFilter * filterPtr			Filter to initialise
+* @arg		U16 * windowPtr				Window storage
+* @arg		U8 shift				Log2 of the window size
+* @return	U8 errorCode				STD Error Code (return STD_EC_SUCCESS if successful)
+*/
+U8 filterInitMovingAverage(tFilter * filterPtr, U16 * windowPtr, U8 shift)
+{
+	if ((shift > FILTER_SHIFT_MAX) || (windowPtr == NULL))
+		return STD_EC_INVALID;
+
+	filterPtr->type = FILTER_TYPE_MOVING_AVERAGE;
+	filterPtr->shift = shift;
+	filterPtr->countMax = 1 << shift;
+	filterPtr->windowPtr = windowPtr;
+	filterReset(filterPtr);
+
+	return STD_EC_SUCCESS;
+}
+
+/**
+* \fn		U8 filterInitIIR(tFilter * filterPtr, S16 alpha)
+* @brief	Initialise a single-pole low-pass filter: y += alpha * (x - y)
+* @note		alpha is in Q15 (use FILTER_Q15()), a smaller alpha filter more
+*			Return STD_EC_INVALID if alpha is not positive
+* @arg		tFilter * filterPtr			Filter to initialise
+* @arg		S16 alpha				Filter coefficient (Q15)
+* @return	U8 errorCode				STD Error Code (return STD_EC_SUCCESS if successful)
+*/
+U8 filterInitIIR(tFilter * filterPtr, S16 alpha)
+{
+	if (alpha <= 0)
+		return STD_EC_INVALID;
+
+	filterPtr->type = FILTER_TYPE_IIR;
+	filterPtr->shift = FILTER_IIR_FRAC;
+	filterPtr->countMax = 1;
+	filterPtr->alpha = alpha;
+	filterPtr->windowPtr = NULL;
+	filterReset(filterPtr);
+
+	return STD_EC_SUCCESS;
+}
+
+/**
+* \fn		U8 filterInitDecimate(tFilter * filterPtr, U8 extraBit)
+* @brief	Initialise an oversample-and-decimate filter, sum 4^extraBit samples and shift by extraBit
+* @note		The output have extraBit more bits than the input (ex: 10 bit ADC + 2 = 12 bit, 1 output per 16 input)
+*			Return STD_EC_INVALID if extraBit is bigger than FILTER_EXTRA_BIT_MAX (16 - FILTER_SAMPLE_BIT, 6 at most)
+* @arg		tFilter * filterPtr			Filter to initialise
+* @arg		U8 extraBit				Number of bit to gain
+* @return	U8 errorCode				STD Error Code (return STD_EC_SUCCESS if successful)
+*/
+U8 filterInitDecimate(tFilter * filterPtr, U8 extraBit)
+{
+	if (extraBit > FILTER_EXTRA_BIT_MAX)
+		return STD_EC_INVALID;
+
+	filterPtr->type = FILTER_TYPE_DECIMATE;
+	filterPtr->shift = extraBit;
+	filterPtr->countMax = 1 << (extraBit << 1);		//4^n
+	filterPtr->windowPtr = NULL;
+	filterReset(filterPtr);
+
+	return STD_EC_SUCCESS;
+}
+
+/**
+* \fn		void filterReset(tFilter * filterPtr)
+* @brief	Clear the state of a filter, keep its configuration
+* @note
+* @arg		tFilter * filterPtr			Filter to reset
+* @return	nothing
+*/
+void filterReset(tFilter * filterPtr)
+{
+	U16 wu0;
+
+	filterPtr->count = 0;
+	filterPtr->accumulator = 0;
+
+	if (filterPtr->type == FILTER_TYPE_MOVING_AVERAGE)
+	{
+		for (wu0 = 0; wu0 < filterPtr->countMax; wu0++)
+			filterPtr->windowPtr[wu0] = 0;
+	}
+}
+// =========================== //
+
+
+// === Process Functions ===== //
+/**
+* \fn		U8 filterProcess(tFilter * filterPtr, U16 sample, U16 * outputPtr)
+* @brief	Give 1 sample to a filter
+* @note		The output is written only when the filter produce one
+* @arg		tFilter * filterPtr			Filter to use
+* @arg		U16 sample				New sample
+* @arg		U16 * outputPtr				Where to write the output
+* @return	U8 ready				1: An output was written | 0: No output yet
+*/
+U8 filterProcess(tFilter * filterPtr, U16 sample, U16 * outputPtr)
+{
+	S32 delta;
+
+	switch (filterPtr->type)
+	{
+		// -- Accumulate and dump -- //
+		case FILTER_TYPE_BOXCAR:
+		case FILTER_TYPE_DECIMATE:
+		{
+			filterPtr->accumulator += sample;
+			if (++filterPtr->count < filterPtr->countMax)
+				return 0;
+
+			*outputPtr = filterPtr->accumulator >> filterPtr->shift;
+			filterPtr->accumulator = 0;
+			filterPtr->count = 0;
+			return 1;
+		}
+		// ------------------------- //
+
+		// -- Circular window -- //
+		case FILTER_TYPE_MOVING_AVERAGE:
+		{
+			filterPtr->accumulator += (S32)sample - filterPtr->windowPtr[filterPtr->count];
+			filterPtr->windowPtr[filterPtr->count] = sample;
+			filterPtr->count = (filterPtr->count + 1) & (filterPtr->countMax - 1);
+
+			*outputPtr = filterPtr->accumulator >> filterPtr->shift;
+			return 1;
+		}
+		// --------------------- //
+
+		// -- Single-pole (state keep FILTER_IIR_FRAC extra bits) -- //
+		case FILTER_TYPE_IIR:
+		{
+			delta = ((S32)sample << FILTER_IIR_FRAC) - filterPtr->accumulator;
+			filterPtr->accumulator += (S32)(((S64)delta * filterPtr->alpha) >> 15);
+
+			*outputPtr = (filterPtr->accumulator + (1 << (FILTER_IIR_FRAC-1))) >> FILTER_IIR_FRAC;
+			return 1;
+		}
+		// --------------------------------------------------------- //
+
+		default:	return 0;
+	}
+}
+
+/**
+* \fn		U16 filterProcessBlock(tFilter * filterPtr, const U16 * samplePtr, U16 sampleNb, U16 * outputPtr)
+* @brief	Give a block of samples to a filter
+* @note		Boxcar and decimate sum the block 2 samples per 32 bit add (samples must fit in FILTER_SAMPLE_BIT)
+*			outputPtr must have space for all the outputs (sampleNb for moving average and IIR)
+* @arg		tFilter * filterPtr			Filter to use
+* @arg		const U16 * samplePtr			Samples
+* @arg		U16 sampleNb				Number of samples
+* @arg		U16 * outputPtr				Where to write the outputs
+* @return	U16 outputNb				Number of outputs written
+*/
+U16 filterProcessBlock(tFilter * filterPtr, const U16 * samplePtr, U16 sampleNb, U16 * outputPtr)
+{
+	U16 outputNb = 0;
+	U16 chunkNb;
+
+	// -- Accumulate and dump: sum the samples in packed lanes -- //
+	if ((filterPtr->type == FILTER_TYPE_BOXCAR) || (filterPtr->type == FILTER_TYPE_DECIMATE))
+	{
+		while (sampleNb)
+		{
+			chunkNb = filterPtr->countMax - filterPtr->count;
+			if (chunkNb > sampleNb)
+				chunkNb = sampleNb;
+
+			filterPtr->accumulator += filterSumBlock(samplePtr, chunkNb);
+			filterPtr->count += chunkNb;
+			samplePtr += chunkNb;
+			sampleNb -= chunkNb;
+
+			if (filterPtr->count == filterPtr->countMax)
+			{
+				outputPtr[outputNb++] = filterPtr->accumulator >> filterPtr->shift;
+				filterPtr->accumulator = 0;
+				filterPtr->count = 0;
+			}
+		}
+	}
+	// ---------------------------------------------------------- //
+	// -- Sample per sample -- //
+	else
+	{
+		while (sampleNb--)
+			outputNb += filterProcess(filterPtr, *samplePtr++, &outputPtr[outputNb]);
+	}
+	// ----------------------- //
+
+	return outputNb;
+}
+
+/**
+* \fn		U32 filterSumBlock(const U16 * samplePtr, U16 sampleNb)
+* @brief	Sum a block of samples, 2 samples per 32 bit add
+* @note		Samples must fit in FILTER_SAMPLE_BIT, the 16 bit lanes are unpacked every FILTER_PACKED_MAX pairs
+*			With 16 bit samples a lane cannot hold 2 samples, they are added one by one
+* @arg		const U16 * samplePtr			Samples
+* @arg		U16 sampleNb				Number of samples
+* @return	U32 sum					Sum of the samples
+*/
+U32 filterSumBlock(const U16 * samplePtr, U16 sampleNb)
+{
+	U32 sum = 0;
+#if FILTER_SAMPLE_BIT < 16
+	U32 packedSum;
+	const U32 * pairPtr;
+	U16 pairNb;
+	U16 wu0;
+
+	// -- Align on 32 bit -- //
+	if (((U32)samplePtr & 0x2) && sampleNb)
+	{
+		sum += *samplePtr++;
+		sampleNb--;
+	}
+	// --------------------- //
+
+	// -- 2 samples per add, each lane hold at most FILTER_PACKED_MAX samples -- //
+	pairPtr = (const U32 *)samplePtr;
+	pairNb = sampleNb >> 1;
+	while (pairNb)
+	{
+		wu0 = (pairNb > FILTER_PACKED_MAX) ? FILTER_PACKED_MAX : pairNb;
+		pairNb -= wu0;
+
+		packedSum = 0;
+		while (wu0--)
+			packedSum += *pairPtr++;
+
+		sum += (packedSum & 0xFFFF) + (packedSum >> 16);
+	}
+	// ------------------------------------------------------------------------ //
+
+	// Last odd sample
+	if (sampleNb & 0x1)
+		sum += *((const U16 *)pairPtr);
+#else
+	// -- 16 bit samples: a lane hold a single sample -- //
+	while (sampleNb--)
+		sum += *samplePtr++;
+	// ------------------------------------------------- //
+#endif
+
+	return sum;
+}
+// =========================== //
+// ############################################## //
@@ -0,0 +1,170 @@
+/*!
+ @file		pic32_filter.h
+ @brief		Fixed-point sample filter lib for pic32
+
+ @version	0.1
+ @note		All the filters use integer only and never divide (power of 2 windows use shifts)
+ 		A filter is a small control struct, declared by the user and initialised with filterInitx()
+ 		Samples are unsigned, FILTER_SAMPLE_BIT wide (ADC result, 16 bit max), block processing add 2 samples per 32 bit operation
+
+ @date		October 19th 2026
+ @author	Laurence DV
+*/
+
+#ifndef _PIC32_FILTER_H
+#define _PIC32_FILTER_H 1
+
+// ################## Includes ################## //
+// Definition
+#include <definition/stddef_megaxone.h>
+#include <definition/datatype_megaxone.h>
+// ############################################## //
+
+
+// ################## Defines ################### //
+// == Filter Type == //
+#define FILTER_TYPE_BOXCAR			0		//Average of 2^n samples, 1 output per 2^n input
+#define FILTER_TYPE_MOVING_AVERAGE		1		//Average of the last 2^n samples, 1 output per input
+#define FILTER_TYPE_IIR				2		//Single-pole low-pass, 1 output per input
+#define FILTER_TYPE_DECIMATE			3		//Oversample 4^n samples to gain n bits, 1 output per 4^n input
+// ================= //
+
+// == Application dependant == //
+#ifndef FILTER_SAMPLE_BIT
+	#define FILTER_SAMPLE_BIT		12		//Widest sample given to the filters (in bit, 16 max)
+#endif
+// ============================ //
+
+// == Limits == //
+#define FILTER_SHIFT_MAX			12		//Maximum boxcar/moving average window (2^n)
+#if (16 - FILTER_SAMPLE_BIT) < 6
+	#define FILTER_EXTRA_BIT_MAX		(16 - FILTER_SAMPLE_BIT)	//Maximum bit gained by decimation (the output must fit in 16 bit)
+#else
+	#define FILTER_EXTRA_BIT_MAX		6		//Maximum bit gained by decimation (4^6 samples per output)
+#endif
+#define FILTER_IIR_FRAC				8		//Extra fractional bits kept in the IIR state
+#define FILTER_PACKED_MAX			(1 << (16 - FILTER_SAMPLE_BIT))	//Maximum sample pair added in packed lanes before unpacking
+// ============ //
+
+/**
+* \fn		FILTER_Q15(value)
+* @brief	Convert a constant between 0 and 1 to Q15 (ex: FILTER_Q15(0.1) for an IIR)
+* @note		Compile-time only, don't use it with a variable
+* @arg		value				Floating point constant
+* @return	S16 Q15 value
+*/
+#define FILTER_Q15(value)			((S16)((value) * 32767.0 + 0.5))
+// ############################################## //
+
+
+// ################# Data Type ################## //
+//Filter control
+typedef struct
+{
+	U8 type;				//Filter type (FILTER_TYPE_x)
+	U8 shift;				//Output shift (log2 of the window or extra bits)
+	U16 count;				//Samples accumulated (boxcar/decimate) or window index (moving average)
+	U16 countMax;				//Samples per output (boxcar/decimate) or window size (moving average)
+	S16 alpha;				//IIR coefficient (Q15)
+	S32 accumulator;			//Running sum or IIR state
+	U16 * windowPtr;			//Moving average window (2^shift samples)
+}tFilter;
+// ############################################## //
+
+
+// ################# Prototypes ################# //
+// ==== Control Functions ==== //
+/**
+* \fn		U8 filterInitBoxcar(tFilter * filterPtr, U8 shift)
+* @brief	Initialise a boxcar filter, average 2^shift samples and give 1 output
+* @note		Return STD_EC_INVALID if shift is bigger than FILTER_SHIFT_MAX
+* @arg		tFilter * filterPtr			Filter to initialise
+* @arg		U8 shift				Log2 of the number of sample averaged
+* @return	U8 errorCode				STD Error Code (return STD_EC_SUCCESS if successful)
+*/
+U8 filterInitBoxcar(tFilter * filterPtr, U8 shift);
+
+/**
+* \fn		U8 filterInitMovingAverage(tFilter * filterPtr, U16 * windowPtr, U8 shift)
+* @brief	Initialise a moving average filter over a circular window of 2^shift samples
+* @note		The window must have 2^shift elements, it is cleared here (the output start from 0)
+*			Return STD_EC_INVALID if shift is bigger than FILTER_SHIFT_MAX or windowPtr is NULL
+* @arg		tFilter * filterPtr			Filter to initialise
+* @arg		U16 * windowPtr				Window storage
+* @arg		U8 shift				Log2 of the window size
+* @return	U8 errorCode				STD Error Code (return STD_EC_SUCCESS if successful)
+*/
+U8 filterInitMovingAverage(tFilter * filterPtr, U16 * windowPtr, U8 shift);
+
+/**
+* \fn		U8 filterInitIIR(tFilter * filterPtr, S16 alpha)
+* @brief	Initialise a single-pole low-pass filter: y += alpha * (x - y)
+* @note		alpha is in Q15 (use FILTER_Q15()), a smaller alpha filter more
+*			Return STD_EC_INVALID if alpha is not positive
+* @arg		tFilter * filterPtr			Filter to initialise
+* @arg		S16 alpha				Filter coefficient (Q15)
+* @return	U8 errorCode				STD Error Code (return STD_EC_SUCCESS if successful)
+*/
+U8 filterInitIIR(tFilter * filterPtr, S16 alpha);
+
+/**
+* \fn		U8 filterInitDecimate(tFilter * filterPtr, U8 extraBit)
+* @brief	Initialise an oversample-and-decimate filter, sum 4^extraBit samples and shift by extraBit
+* @note		The output have extraBit more bits than the input (ex: 10 bit ADC + 2 = 12 bit, 1 output per 16 input)
+*			Return STD_EC_INVALID if extraBit is bigger than FILTER_EXTRA_BIT_MAX (16 - FILTER_SAMPLE_BIT, 6 at most)
+* @arg		tFilter * filterPtr			Filter to initialise
+* @arg		U8 extraBit				Number of bit to gain
+* @return	U8 errorCode				STD Error Code (return STD_EC_SUCCESS if successful)
+*/
+U8 filterInitDecimate(tFilter * filterPtr, U8 extraBit);
+
+/**
+* \fn		void filterReset(tFilter * filterPtr)
+* @brief	Clear the state of a filter, keep its configuration
+* @note
+* @arg		tFilter * filterPtr			Filter to reset
+* @return	nothing
+*/
+void filterReset(tFilter * filterPtr);
+// =========================== //
+
+
+// === Process Functions ===== //
+/**
+* \fn		U8 filterProcess(tFilter * filterPtr, U16 sample, U16 * outputPtr)
+* @brief	Give 1 sample to a filter
+* @note		The output is written only when the filter produce one
+* @arg		tFilter * filterPtr			Filter to use
+* @arg		U16 sample				New sample
+* @arg		U16 * outputPtr				Where to write the output
+* @return	U8 ready				1: An output was written | 0: No output yet
+*/
+U8 filterProcess(tFilter * filterPtr, U16 sample, U16 * outputPtr);
+
+/**
+* \fn		U16 filterProcessBlock(tFilter * filterPtr, const U16 * samplePtr, U16 sampleNb, U16 * outputPtr)
+* @brief	Give a block of samples to a filter
+* @note		Boxcar and decimate sum the block 2 samples per 32 bit add (samples must fit in FILTER_SAMPLE_BIT)
+*			outputPtr must have space for all the outputs (sampleNb for moving average and IIR)
+* @arg		tFilter * filterPtr			Filter to use
+* @arg		const U16 * samplePtr			Samples
+* @arg		U16 sampleNb				Number of samples
+* @arg		U16 * outputPtr				Where to write the outputs
+* @return	U16 outputNb				Number of outputs written
+*/
+U16 filterProcessBlock(tFilter * filterPtr, const U16 * samplePtr, U16 sampleNb, U16 * outputPtr);
+
+/**
+* \fn		U32 filterSumBlock(const U16 * samplePtr, U16 sampleNb)
+* @brief	Sum a block of samples, 2 samples per 32 bit add
+* @note		Samples must fit in FILTER_SAMPLE_BIT, the 16 bit lanes are unpacked every FILTER_PACKED_MAX pairs
+*			With 16 bit samples a lane cannot hold 2 samples, they are added one by one
+* @arg		const U16 * samplePtr			Samples
+* @arg		U16 sampleNb				Number of samples
+* @return	U32 sum					Sum of the samples
+*/
+U32 filterSumBlock(const U16 * samplePtr, U16 sampleNb);
+// =========================== //
+// ############################################## //
+
+#endif
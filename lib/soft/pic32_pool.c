@@ -0,0 +1,218 @@
+/*!
+ @file		pic32_pool.c
+ @brief		Fixed-block memory pool lib
+
+ @version	0.1
+ @note		All Function are Non-Blocking and can be called from an ISR
+ 		The storage is declared at compile-time, no heap is used
+ 		Free blocks are linked together by a pointer saved inside the block itself (intrusive free list),
+ 		so alloc and free are O(1)
+ 		A free block also hold a marker (2nd word) so a double free is refused
+
+ @date		October 19th 2026
+ @author	Laurence DV
+*/
+
+// ################## Includes ################## //
+#include "pic32_pool.h"
+// ############################################## //
+
+
+// ################## Defines ################### //
+#define _poolMarkerPtr(blockPtr)	((U32*)(((void**)(blockPtr))+1))	//Free marker is the word after the link
+// ############################################## //
+
+
+// ############### Pool Functions ############### //
+// ==== Control Functions ==== //
+/**
+* \fn		U8 poolInit(tPoolCtl * poolCtlPtr, void * storagePtr, U16 blockSize, U16 blockNb)
+* @brief	Initialise a pool on a statically declared storage and link all the blocks in the free list
+* @note		Use poolDeclareStorage() to declare the storage with the correct size
+*		blockSize is rounded up to a multiple of 4 byte (8 byte minimum)
+*		Return STD_EC_INVALID if a NULL pointer or a null size is given
+*		WARNING: Will not check if blocks are still in use
+* @arg		tPoolCtl * poolCtlPtr		Pool to initialise
+* @arg		void * storagePtr		Storage for the blocks (must be 4 byte aligned)
+* @arg		U16 blockSize			Size of an object (in byte)
+* @arg		U16 blockNb			Number of object in the storage
+* @return	U8 errorCode			STD Error Code (return STD_EC_SUCCESS if successful)
+*/
+U8 poolInit(tPoolCtl * poolCtlPtr, void * storagePtr, U16 blockSize, U16 blockNb)
+{
+	U16 wu0;
+	U32 intState;
+	U8 * blockPtr = (U8*)storagePtr;
+
+	// -- Handle invalid parameters -- //
+	if ((poolCtlPtr == NULL) || (storagePtr == NULL) || (blockSize == 0) || (blockNb == 0))
+		return STD_EC_INVALID;
+	// ------------------------------- //
+
+	blockSize = POOL_BLOCK_SIZE(blockSize);
+
+	// Disable Global Interrupt
+	intState = intFastDisableGlobal();
+
+	// -- Link every block in the free list -- //
+	for (wu0 = 0; wu0 < (blockNb-1); wu0++)
+	{
+		*((void**)blockPtr) = blockPtr + blockSize;	//Point to the next block
+		*_poolMarkerPtr(blockPtr) = POOL_FREE_MARKER(poolCtlPtr);	//Mark as free
+		blockPtr += blockSize;
+	}
+	*((void**)blockPtr) = NULL;				//Last block end the list
+	*_poolMarkerPtr(blockPtr) = POOL_FREE_MARKER(poolCtlPtr);
+	// --------------------------------------- //
+
+	// -- Init the control -- //
+	poolCtlPtr->control.blockSize = blockSize;
+	poolCtlPtr->control.blockNb = blockNb;
+	poolCtlPtr->control.freePtr = storagePtr;
+	poolCtlPtr->control.startPtr = storagePtr;
+	poolCtlPtr->control.endPtr = ((U8*)storagePtr) + ((U32)blockNb*blockSize);
+
+	poolCtlPtr->stats.usedNb = 0;
+	poolCtlPtr->stats.peakNb = 0;
+	poolCtlPtr->stats.failNb = 0;
+	// ---------------------- //
+
+	// Restore Interrupt state
+	intFastRestoreGlobal(intState);
+
+	return STD_EC_SUCCESS;
+}
+
+/**
+* \fn		void * poolAlloc(tPoolCtl * poolCtlPtr)
+* @brief	Take a block from the pool
+* @note		Return a NULL pointer if the pool is empty (counted in stats.failNb)
+*		Can be called from an ISR
+* @arg		tPoolCtl * poolCtlPtr		Pool to select
+* @return	void * blockPtr			Pointer to the allocated block
+*/
+void * poolAlloc(tPoolCtl * poolCtlPtr)
+{
+	void * blockPtr;
+	U32 intState;
+
+	// Disable Global Interrupt
+	intState = intFastDisableGlobal();
+
+	// -- Unlink the first free block -- //
+	blockPtr = poolCtlPtr->control.freePtr;
+	if (blockPtr != NULL)
+	{
+		poolCtlPtr->control.freePtr = *((void**)blockPtr);
+		*_poolMarkerPtr(blockPtr) = 0;				//Clear the free marker
+
+		//Count the allocated block
+		poolCtlPtr->stats.usedNb++;
+		if (poolCtlPtr->stats.usedNb > poolCtlPtr->stats.peakNb)
+			poolCtlPtr->stats.peakNb = poolCtlPtr->stats.usedNb;
+	}
+	else
+		poolCtlPtr->stats.failNb++;			//Pool is empty
+	// --------------------------------- //
+
+	// Restore Interrupt state
+	intFastRestoreGlobal(intState);
+
+	return blockPtr;
+}
+
+/**
+* \fn		U8 poolFree(tPoolCtl * poolCtlPtr, void * blockPtr)
+* @brief	Give back a block to the pool
+* @note		Return STD_EC_INVALID if the block does not belong to this pool (outside of the storage
+*		or not aligned on a block) or if it is already free
+*		Can be called from an ISR
+* @arg		tPoolCtl * poolCtlPtr		Pool to select
+* @arg		void * blockPtr			Block to free
+* @return	U8 errorCode			STD Error Code (return STD_EC_SUCCESS if successful)
+*/
+U8 poolFree(tPoolCtl * poolCtlPtr, void * blockPtr)
+{
+	U32 intState;
+
+	// -- Check that the block is from this pool -- //
+	if (((U8*)blockPtr < (U8*)poolCtlPtr->control.startPtr) || ((U8*)blockPtr >= (U8*)poolCtlPtr->control.endPtr))
+		return STD_EC_INVALID;
+	if ((((U8*)blockPtr - (U8*)poolCtlPtr->control.startPtr) % poolCtlPtr->control.blockSize) != 0)
+		return STD_EC_INVALID;					//Not aligned on a block
+	// -------------------------------------------- //
+
+	// Disable Global Interrupt
+	intState = intFastDisableGlobal();
+
+	// -- Refuse a double free -- //
+	if ((*_poolMarkerPtr(blockPtr) == POOL_FREE_MARKER(poolCtlPtr)) || (poolCtlPtr->stats.usedNb == 0))
+	{
+		intFastRestoreGlobal(intState);
+		return STD_EC_INVALID;
+	}
+	// -------------------------- //
+
+	// -- Link the block on top of the free list -- //
+	*((void**)blockPtr) = poolCtlPtr->control.freePtr;
+	*_poolMarkerPtr(blockPtr) = POOL_FREE_MARKER(poolCtlPtr);	//Mark as free
+	poolCtlPtr->control.freePtr = blockPtr;
+	poolCtlPtr->stats.usedNb--;				//Count the freed block
+	// -------------------------------------------- //
+
+	// Restore Interrupt state
+	intFastRestoreGlobal(intState);
+
+	return STD_EC_SUCCESS;
+}
+
+/**
+* \fn		U16 poolGetFreeSpace(tPoolCtl * poolCtlPtr)
+* @brief	Return the number of free blocks in the pool
+* @note
+* @arg		tPoolCtl * poolCtlPtr		Pool to select
+* @return	U16 freeNb			Free blocks in the pool
+*/
+U16 poolGetFreeSpace(tPoolCtl * poolCtlPtr)
+{
+	return (poolCtlPtr->control.blockNb - poolCtlPtr->stats.usedNb);
+}
+
+/**
+* \fn		U16 poolGetUsedSpace(tPoolCtl * poolCtlPtr)
+* @brief	Return the number of allocated blocks in the pool
+* @note		The used space can also be determine directly in the control reg (stats.usedNb)
+* @arg		tPoolCtl * poolCtlPtr		Pool to select
+* @return	U16 usedNb			Allocated blocks in the pool
+*/
+U16 poolGetUsedSpace(tPoolCtl * poolCtlPtr)
+{
+	return poolCtlPtr->stats.usedNb;
+}
+
+/**
+* \fn		U16 poolGetPeakSpace(tPoolCtl * poolCtlPtr)
+* @brief	Return the maximum number of blocks allocated at the same time since the last stats reset
+* @note		Usefull to size the pool of an application
+* @arg		tPoolCtl * poolCtlPtr		Pool to select
+* @return	U16 peakNb			High watermark of the pool
+*/
+U16 poolGetPeakSpace(tPoolCtl * poolCtlPtr)
+{
+	return poolCtlPtr->stats.peakNb;
+}
+
+/**
+* \fn		void poolResetStats(tPoolCtl * poolCtlPtr)
+* @brief	Reset the peak and fail statistics of a pool
+* @note		The peak is reset to the actual used space
+* @arg		tPoolCtl * poolCtlPtr		Pool to select
+* @return	nothing
+*/
+void poolResetStats(tPoolCtl * poolCtlPtr)
+{
+	poolCtlPtr->stats.peakNb = poolCtlPtr->stats.usedNb;
+	poolCtlPtr->stats.failNb = 0;
+}
+// =========================== //
+// ############################################## //
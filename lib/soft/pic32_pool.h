@@ -0,0 +1,163 @@
+/*!
+ @file		pic32_pool.h
+ @brief		Fixed-block memory pool lib
+
+ @version	0.1
+ @note		All Function are Non-Blocking and can be called from an ISR
+ 		The storage is declared at compile-time, no heap is used
+ 		Free blocks are linked together by a pointer saved inside the block itself (intrusive free list),
+ 		so alloc and free are O(1)
+ 		A free block also hold a marker (2nd word) so a double free is refused
+
+ @date		October 19th 2026
+ @author	Laurence DV
+*/
+
+#ifndef _PIC32_POOL_H
+#define _PIC32_POOL_H 1
+// ################## Includes ################## //
+// Lib
+#include <peripheral/pic32_interrupt.h>
+
+// Definition
+#include <definition/stddef_megaxone.h>
+#include <definition/datatype_megaxone.h>
+// ############################################## //
+
+
+// ################## Defines ################### //
+/**
+* \fn		POOL_BLOCK_SIZE(size)
+* @brief	Round up a size (in byte) to the real size of a block in a pool
+* @note		A block is always a multiple of 4 byte and at least 8 byte to be able to contain
+*		the free list link and the free marker
+* @arg		size				Size of the object to store (in byte)
+* @return	Real size of a block (in byte)
+*/
+#define POOL_BLOCK_SIZE(size)			(((size) <= 8) ? 8 : ((((size)+3)>>2)<<2))
+
+/**
+* \fn		POOL_FREE_MARKER(poolCtlPtr)
+* @brief	Marker saved in the 2nd word of a free block
+* @note		Keyed with the pool address so a block from another pool never match
+* @arg		poolCtlPtr			Pool owning the block
+* @return	Marker value
+*/
+#define POOL_FREE_MARKER(poolCtlPtr)		(0xF5EEB10CUL ^ ((U32)(poolCtlPtr)))
+
+/**
+* \fn		poolDeclareStorage(name, type, blockNb)
+* @brief	Statically declare the storage of a pool for a specific type
+* @note		Use it at file scope, then give "name" to poolInit() as the storagePtr
+* @arg		name				Name of the storage array
+* @arg		type				Type of the object stored in the pool
+* @arg		blockNb				Number of object in the pool
+* @return	nothing
+*/
+#define poolDeclareStorage(name, type, blockNb)	U32 name[((blockNb)*POOL_BLOCK_SIZE(sizeof(type)))>>2]
+// ############################################## //
+
+
+// ################# Data Type ################## //
+// Control Part //
+typedef struct
+{
+	struct
+	{
+		U16 usedNb;			//Number of block actually allocated
+		U16 peakNb;			//Maximum number of block allocated at the same time
+		U16 failNb;			//Number of refused allocation (pool empty)
+		U16 :16;
+	}stats;
+
+	struct
+	{
+		U16 blockSize;			//Size of a block (in byte)
+		U16 blockNb;			//Total number of blocks in the pool
+		void * freePtr;			//First free block (head of the free list)
+		void * startPtr;		//First block of the storage
+		void * endPtr;			//End of the storage
+	}control;
+}tPoolCtl;
+// ----------- //
+// ############################################## //
+
+
+// ################# Prototypes ################# //
+// ==== Control Functions ==== //
+/**
+* \fn		U8 poolInit(tPoolCtl * poolCtlPtr, void * storagePtr, U16 blockSize, U16 blockNb)
+* @brief	Initialise a pool on a statically declared storage and link all the blocks in the free list
+* @note		Use poolDeclareStorage() to declare the storage with the correct size
+*		blockSize is rounded up to a multiple of 4 byte (8 byte minimum)
+*		Return STD_EC_INVALID if a NULL pointer or a null size is given
+*		WARNING: Will not check if blocks are still in use
+* @arg		tPoolCtl * poolCtlPtr		Pool to initialise
+* @arg		void * storagePtr		Storage for the blocks (must be 4 byte aligned)
+* @arg		U16 blockSize			Size of an object (in byte)
+* @arg		U16 blockNb			Number of object in the storage
+* @return	U8 errorCode			STD Error Code (return STD_EC_SUCCESS if successful)
+*/
+U8 poolInit(tPoolCtl * poolCtlPtr, void * storagePtr, U16 blockSize, U16 blockNb);
+
+/**
+* \fn		void * poolAlloc(tPoolCtl * poolCtlPtr)
+* @brief	Take a block from the pool
+* @note		Return a NULL pointer if the pool is empty (counted in stats.failNb)
+*		Can be called from an ISR
+* @arg		tPoolCtl * poolCtlPtr		Pool to select
+* @return	void * blockPtr			Pointer to the allocated block
+*/
+void * poolAlloc(tPoolCtl * poolCtlPtr);
+
+/**
+* \fn		U8 poolFree(tPoolCtl * poolCtlPtr, void * blockPtr)
+* @brief	Give back a block to the pool
+* @note		Return STD_EC_INVALID if the block does not belong to this pool (outside of the storage
+*		or not aligned on a block) or if it is already free
+*		Can be called from an ISR
+* @arg		tPoolCtl * poolCtlPtr		Pool to select
+* @arg		void * blockPtr			Block to free
+* @return	U8 errorCode			STD Error Code (return STD_EC_SUCCESS if successful)
+*/
+U8 poolFree(tPoolCtl * poolCtlPtr, void * blockPtr);
+
+/**
+* \fn		U16 poolGetFreeSpace(tPoolCtl * poolCtlPtr)
+* @brief	Return the number of free blocks in the pool
+* @note
+* @arg		tPoolCtl * poolCtlPtr		Pool to select
+* @return	U16 freeNb			Free blocks in the pool
+*/
+U16 poolGetFreeSpace(tPoolCtl * poolCtlPtr);
+
+/**
+* \fn		U16 poolGetUsedSpace(tPoolCtl * poolCtlPtr)
+* @brief	Return the number of allocated blocks in the pool
+* @note		The used space can also be determine directly in the control reg (stats.usedNb)
+* @arg		tPoolCtl * poolCtlPtr		Pool to select
+* @return	U16 usedNb			Allocated blocks in the pool
+*/
+U16 poolGetUsedSpace(tPoolCtl * poolCtlPtr);
+
+/**
+* \fn		U16 poolGetPeakSpace(tPoolCtl * poolCtlPtr)
+* @brief	Return the maximum number of blocks allocated at the same time since the last stats reset
+* @note		Usefull to size the pool of an application
+* @arg		tPoolCtl * poolCtlPtr		Pool to select
+* @return	U16 peakNb			High watermark of the pool
+*/
+U16 poolGetPeakSpace(tPoolCtl * poolCtlPtr);
+
+/**
+* \fn		void poolResetStats(tPoolCtl * poolCtlPtr)
+* @brief	Reset the peak and fail statistics of a pool
+* @note		The peak is reset to the actual used space
+* @arg		tPoolCtl * poolCtlPtr		Pool to select
+* @return	nothing
+*/
+void poolResetStats(tPoolCtl * poolCtlPtr);
+// =========================== //
+// ############################################## //
+
+#endif
@@ -6,6 +6,7 @@
  @note		The sysTick Rate is also the upTime Update Rate, keep it below a second to use the realTime system
 		accurately.
 		The software Counters will count AT LEAST the number of systick specified, but can count a bit more (not much)
+		With RT_TICKLESS the sysTick come from the core timer and no interrupt happen when no timer is running
  @date		March 2th 2012
  @author	Laurence DV
 */
@@ -16,7 +17,11 @@
 
 
 // ################## Defines ################### //
-
+#if RT_TICKLESS == ENABLE
+	#define rtTickWake()			_rtTickWake()
+#else
+	#define rtTickWake()
+#endif
 // ############################################## //
 
 
@@ -50,18 +55,29 @@ U16 rtccRemaininguS = 0;						//Remaining 
 #endif
 // ================= //
 
+// == Timing Wheel == //
+tWheelCtl rtWheel;							//Timing wheel advanced every sysTick
+// ==================== //
+
+// == Tickless mode == //
+#if RT_TICKLESS == ENABLE
+tCoreTimerEvent rtTickEvent;						//Core timer event of the sysTick
+U64 rtTickPeriod = 0;							//Period of a sysTick (in core timer tick)
+U8 rtTickIdle = 1;							//The sysTick is stopped
+#endif
+// =================== //
+
 // == Software Counter == //
 #if USE_RT_SOFT_COUNTER == ENABLE
-U32 softCnt[RT_SOFT_COUNTER_NB];					//Actual value of the software counter
-U32 softCntReloadVal[RT_SOFT_COUNTER_NB];				//Value to reload after the underrun of the counter
-U32 * softCntTargetPtr[RT_SOFT_COUNTER_NB];				//Target to modify at the underrun
-U32 softCntTargetVal[RT_SOFT_COUNTER_NB];				//Value to input in the target
-tSoftCounterControl softCntControl[RT_SOFT_COUNTER_NB];			//Control register of the software counter
-U8 softCntEnabled = 0;							//Number of counter enabled
-U16 softCntEnable = 0;							//Bitwise soft counter enable control
-U16 softCntRun = 0;							//Bitwise soft counter running control
+tSoftCounter softCnt[RT_SOFT_COUNTER_NB];				//Software counters
+tSoftCounter * softCntUnderRunPtr = NULL;				//Counters waiting for softCntEngine()
 #endif
 // ====================== //
+
+// == Software Timer == //
+tSoftTimer * softTmrQueueHeadPtr = NULL;				//Oldest timer waiting for softTimerEngine()
+tSoftTimer * softTmrQueueTailPtr = NULL;				//Newest timer waiting for softTimerEngine()
+// ==================== //
 // ############################################## //
 
 
@@ -74,36 +90,72 @@ U16 softCntRun = 0;							//Bitwise soft counter running control
 * @arg		nothing
 * @return	nothing
 */
-/*	Vector Example
- void __ISR(RT_TIMER_INT_VECTOR, IPL7SOFT)realTimeISR(void)
+/*	Vector Example (the IPL follow RT_TIMER_INT_PRIORITY)
+ rtDeclareISR()
+*/
+/*	Vector Example on the shadow register set, MX3/4/5/6/7 only (INT_SHADOW_IPL and FSRSSEL set to RT_TIMER_INT_PRIORITY)
+	On MX1/2 the shadow set is fixed to IPL7, above the INT_CRIT_IPL ceiling that protect the soft counters,
+	so realTimeISR() cannot use it there
+ intShadowISR(RT_TIMER_VECTOR, realTimeISR)
 {
 	rtISR();
 
-	intFastClearFlag(RT_TIMER_INT_VECTOR);
+	intFastClearFlag(RT_TIMER_INT_ID);
 }*/
 
 void rtISR(void)
 {
 	sysTick++;
 
-	// -- Soft Counter -- //
-	#if USE_RT_SOFT_COUNTER == ENABLE
-	U8 wu0 = 0;
+	// Advance the timers (O(1) whatever the number of running counters)
+	wheelTick(&rtWheel);
+}
+
+#if RT_TICKLESS == ENABLE
+/**
+* \fn		void _rtTickEvent(tCoreTimerEvent * eventPtr, void * contextPtr)
+* @brief	Core timer event of the sysTick in tickless mode
+* @note		Called from coreTimerISR(), stop the sysTick when no timer is running
+* @arg		tCoreTimerEvent * eventPtr	sysTick event
+* @arg		void * contextPtr		Not used
+* @return	nothing
+*/
+void _rtTickEvent(tCoreTimerEvent * eventPtr, void * contextPtr)
+{
+	rtISR();
+
+	if (rtWheel.pendingNb)
+		coreTimerStartEvent(eventPtr, eventPtr->deadline + rtTickPeriod);	//Next sysTick (drift-free)
+	else
+		rtTickIdle = 1;
+}
+
+/**
+* \fn		void _rtTickWake(void)
+* @brief	Restart a stopped sysTick in tickless mode
+* @note		Must be called in a critical section before adding a node in rtWheel
+*		The sysTick passed while stopped are added to sysTick without processing
+* @arg		nothing
+* @return	nothing
+*/
+void _rtTickWake(void)
+{
+	U64 elapsedNb;
 
-	while (softCntRun >> wu0)					//While there is still some enabled counter
+	if (rtTickIdle)
 	{
-		if (softCntRun & (BIT0 << wu0))				//Check fot this specific counter
-		{
-			if (softCnt[wu0])
-				softCnt[wu0]--;				//Counter is still decrementing
-			else
-				softCntControl[wu0].underRun = 1;	//Counter as reach bottom, flag it
-		}
-		wu0++;
+		// -- Catch up the sysTick passed while stopped -- //
+		elapsedNb = (coreTimerGetCount64() - rtTickEvent.deadline) / rtTickPeriod;
+		sysTick += (U32)elapsedNb;
+		wheelSkip(&rtWheel, (U32)elapsedNb);
+		rtTickEvent.deadline += elapsedNb * rtTickPeriod;
+		// ----------------------------------------------- //
+
+		rtTickIdle = 0;
+		coreTimerStartEvent(&rtTickEvent, rtTickEvent.deadline + rtTickPeriod);
 	}
-	#endif
-	// ------------------ //
 }
+#endif
 // =========================== //
 
 
@@ -120,15 +172,26 @@ void rtISR(void)
 */
 U8 realTimeInit(U32 tickPeriod)
 {
+	#if RT_TICKLESS == ENABLE
+	// -- Init the core timer sysTick -- //
+	coreTimerInit();
+	rtTickPeriod = coreTimerUsToTick(tickPeriod);
+	coreTimerEventInit(&rtTickEvent, _rtTickEvent, NULL);
+	rtTickEvent.deadline = coreTimerGetCount64();
+	rtTickIdle = 1;							//Started with the first timer
+	// --------------------------------- //
+	#else
 	// -- Init and set the Timer 1 -- //
 	timerInit(RT_TIMER_ID,TMR_CS_PBCLK|TMR_FRZ_STOP);		//Timer 1 is based off PBCLK (and freezed in debug mode)
 	timerSetOverflow(RT_TIMER_ID,tickPeriod);			//Set the overflow time to the desired sysTick period
-	intFastSetPriority(RT_TIMER_INT_ID,7);				//Set the Timer 1 interrupt to max priority
+	intFastSetPriority(RT_TIMER_INT_ID,RT_TIMER_INT_PRIORITY);	//Set the Timer 1 interrupt priority (at most the critical section ceiling)
 	intFastSetSubPriority(RT_TIMER_INT_ID,3);
 	intFastEnable(RT_TIMER_INT_ID);					//Enable Timer 1 interrupt
 	// ------------------------------ //
+	#endif
 
 	sysTickValue = tickPeriod;					//Save the tick period in s
+	wheelInit(&rtWheel);
 
 	// -- Init the soft rtcc if needed -- //
 	#if RTCC_SYSTEM == RTCC_SOFTWARE
@@ -141,11 +204,36 @@ U8 realTimeInit(U32 tickPeriod)
 	// ----------------------- //
 	
 	//Start the timer
+	#if RT_TICKLESS != ENABLE
 	timerStart(RT_TIMER_ID);
+	#endif
 
 	return STD_EC_SUCCESS;
 }
 
+/**
+* \fn		U32 rtGetSysTick(void)
+* @brief	Return the number of sysTick passed since the init
+* @note		In tickless mode the sysTick passed while it is stopped are added, without restarting it
+* @arg		nothing
+* @return	U32 tickNb			Number of sysTick
+*/
+U32 rtGetSysTick(void)
+{
+	U32 tickNb;
+	U32 critState = critEnter();
+
+	tickNb = sysTick;
+	#if RT_TICKLESS == ENABLE
+	if (rtTickIdle)
+		tickNb += (U32)((coreTimerGetCount64() - rtTickEvent.deadline) / rtTickPeriod);
+	#endif
+
+	critExit(critState);
+
+	return tickNb;
+}
+
 /**
 * \fn		void rtTimeClear(tRealTime * timeToClear)
 * @brief	Reset to 0 every part of a tRealTime variable
@@ -226,50 +314,78 @@ void rtTimeEngine(void)
 
 
 // ====== Software Counter ====== //
+/**
+* \fn		void _softCntUnderRun(tWheelNode * nodePtr, void * contextPtr)
+* @brief	Timing wheel handler of a software counter, flag it for softCntEngine()
+* @note		Called from rtISR()
+* @arg		tWheelNode * nodePtr		Node of the counter
+* @arg		void * contextPtr		Software counter
+* @return	nothing
+*/
+void _softCntUnderRun(tWheelNode * nodePtr, void * contextPtr)
+{
+	tSoftCounter * workCnt = contextPtr;
+
+	// -- Queue it for the engine -- //
+	if (!workCnt->control.underRun)
+	{
+		workCnt->control.underRun = 1;
+		workCnt->nextUnderRunPtr = softCntUnderRunPtr;
+		softCntUnderRunPtr = workCnt;
+	}
+	// ----------------------------- //
+}
+
 /**
 * \fn		U8 softCntInit(U32 cntPeriod, U32 * targetPtr, U32 targetValue, U8 option)
 * @brief	Initialise a software counter
-* @note
+* @note		The counter underRun on the sysTick after reaching 0, so after cntPeriod + 1 sysTick
 * @arg		U32 cntPeriod		Number of sysTick of 1 count
 * @arg		U32 * targetPtr		Target to be modified at underRun
 * @arg		U32 targetValue		Value to bitwise OR the target after a underRun
 * @arg		U8 option			Options of the counter (Use the "Init Option" defines)
-* @return	U8 softCntID		ID of the initialised counter
+* @return	U8 softCntID		ID of the initialised counter (STD_EC_OVERFLOW if none is available)
 */
 U8 softCntInit(U32 cntPeriod, U32 * targetPtr, U32 targetValue, U8 option)
 {
 	U8 softCntID;
+	tSoftCounter * workCnt;
+	U32 critState = critEnter();
+
+	// -- Find an available counter -- //
+	for (softCntID = 0; softCntID < RT_SOFT_COUNTER_NB; softCntID++)
+	{
+		if (!softCnt[softCntID].control.enable && !softCnt[softCntID].control.underRun)	//Not still waiting in the engine
+			break;
+	}
+	// ------------------------------- //
 
-	// -- Check if a counter is available -- //
-	if (softCntEnabled < RT_SOFT_COUNTER_NB)
-	// ------------------------------------- //
+	if (softCntID < RT_SOFT_COUNTER_NB)
 	{
-		// -- Set the ID -- //
-		softCntID = softCntEnabled;
-		softCntEnabled++;
-		// ---------------- //
+		workCnt = &softCnt[softCntID];
+		workCnt->control.all = 0;
+		wheelNodeInit(&workCnt->node, _softCntUnderRun, workCnt);
 
 		// -- Set the target -- //
-		softCntControl[softCntID].targetEn = (option & SOFT_CNT_TARGET_EN) >> 1;//Set the target action option
-		softCntTargetVal[softCntID] = targetValue;				//Save the value
+		workCnt->control.targetEn = (option & SOFT_CNT_TARGET_EN) >> 1;	//Set the target action option
+		workCnt->targetVal = targetValue;					//Save the value
 		if (targetPtr == NULL)							//Handle NULL pointer
 			targetPtr = &globalDump;
-		softCntTargetPtr[softCntID] = targetPtr;				//Save the target
+		workCnt->targetPtr = targetPtr;						//Save the target
 		// -------------------- //
 
-		// -- Init the counter -- //
-		softCntStop(softCntID);							//Ensure that the counter is stopped
-		softCntEnable |= (BIT0 << softCntID);					//Enable the counter
-		softCntControl[softCntID].reload = option & SOFT_CNT_RELOAD_EN;		//Set the auto reload option
-		softCnt[softCntID] = cntPeriod;						//Initial Loading
-		softCntReloadVal[softCntID] = cntPeriod;				//Save the period
-		softCntControl[softCntID].underRun = 0;					//Ensure the underRun flag is cleared
-		// ---------------------- //
-
+		// -- Init the counter (stopped) -- //
+		workCnt->control.reload = option & SOFT_CNT_RELOAD_EN;			//Set the auto reload option
+		workCnt->remaining = cntPeriod;						//Initial Loading
+		workCnt->reloadVal = cntPeriod;						//Save the period
+		workCnt->control.enable = 1;						//Enable the counter
+		// -------------------------------- //
 	}
 	else
 		softCntID = STD_EC_OVERFLOW;
 
+	critExit(critState);
+
 	return softCntID;
 }
 
@@ -282,18 +398,22 @@ U8 softCntInit(U32 cntPeriod, U32 * targetPtr, U32 targetValue, U8 option)
 */
 void softCntRelease(U8 softCntID)
 {
+	U32 critState;
+
+	if (softCntID >= RT_SOFT_COUNTER_NB)
+		return;
+
+	critState = critEnter();
+
 	// -- Only process if the counter was enabled -- //
-	if ((softCntEnable) & (BIT0 << softCntID))
+	if (softCnt[softCntID].control.enable)
 	{
 		softCntStop(softCntID);						//Stop the counter
-		softCntEnable &= ~(BIT0 << softCntID);				//Disable the counter
-
-		// -- Release the soft counter -- //
-		while (!((softCntEnable) & (BIT0 << (softCntEnabled - 1))))	//Scan the bitwise Enable control starting by the last enabled softCnt
-			softCntEnabled--;					//Subtract 1 to the Software Counter Enabled counter
-		// ------------------------------ //
+		softCnt[softCntID].control.enable = 0;				//Disable the counter
 	}
 	// --------------------------------------------- //
+
+	critExit(critState);
 }
 
 /**
@@ -301,66 +421,117 @@ void softCntRelease(U8 softCntID)
 * @brief	UnderRun reaction function for software counter
 * @note		This function must be in the infinite loop of the main to ensure that the software counter will react correctly
 *		The target will only be modify with a "|" (ex: target = 0x10 , value = 0x01 , result = 0x11)
+*		Only the counters that have underRun are processed
 * @arg		nothing
 * @return	nothing
 */
 void softCntEngine(void)
 {
-	U8 softCntIDtemp = 0;
-
-	while ((softCntEnable) & (U16_MAX << softCntIDtemp))
+	tSoftCounter * workCnt;
+	tSoftCounter * nextCnt;
+	U32 critState;
+
+	// -- Take the underRun list -- //
+	critState = critEnter();
+	workCnt = softCntUnderRunPtr;
+	softCntUnderRunPtr = NULL;
+	critExit(critState);
+	// ---------------------------- //
+
+	while (workCnt != NULL)
 	{
-		// -- UnderRun condition -- //
-		if (softCntControl[softCntIDtemp].underRun)
+		critState = critEnter();					//rtISR() write the same control reg
+		nextCnt = workCnt->nextUnderRunPtr;
+
+		if (workCnt->control.enable)
 		{
 			// -- Auto reload -- //
-			if (softCntControl[softCntIDtemp].reload)
-				softCnt[softCntIDtemp] = softCntReloadVal[softCntIDtemp];//Reload the value
+			if (workCnt->control.reload)
+			{
+				workCnt->remaining = workCnt->reloadVal;	//Reload the value
+				if (workCnt->control.run)
+				{
+					rtTickWake();
+					wheelAdd(&rtWheel, &workCnt->node, workCnt->reloadVal + 1);	//UnderRun one sysTick after 0
+				}
+			}
 			else
-				softCntStop(softCntIDtemp);				//Stop the counter
+			{
+				workCnt->remaining = 0;
+				workCnt->control.run = 0;			//Stop the counter
+			}
 			// ----------------- //
 
 			// -- Target Action -- //
-			if (softCntControl[softCntIDtemp].targetEn)
+			if (workCnt->control.targetEn)
 			{
-				U32 targetTemp = *softCntTargetPtr[softCntIDtemp];	//Load the previous data in the target
-				targetTemp &= ~(softCntTargetVal[softCntIDtemp]);	//Clear the overlapping bit
-				targetTemp |= softCntTargetVal[softCntIDtemp];		//OR with the value
-				*softCntTargetPtr[softCntIDtemp] = targetTemp;		//Save the new value
+				U32 targetTemp = *workCnt->targetPtr;		//Load the previous data in the target
+				targetTemp &= ~(workCnt->targetVal);		//Clear the overlapping bit
+				targetTemp |= workCnt->targetVal;		//OR with the value
+				*workCnt->targetPtr = targetTemp;		//Save the new value
 			}
 			// ------------------- //
-
-			softCntControl[softCntIDtemp].underRun = 0;			//Clear the underRun flag
 		}
-		// ------------------------ //
 
-		softCntIDtemp++;							//Check the next counter
+		workCnt->control.underRun = 0;					//Clear the underRun flag
+		critExit(critState);
+
+		workCnt = nextCnt;						//Check the next counter
 	}
 }
 
 /**
 * \fn		void softCntStart(U8 softCntID)
 * @brief	Start a Software Counter
-* @note
+* @note		Continue from the value it had when stopped
 * @arg		U8 softCntID		ID of the Software Counter
 * @return	nothing
 */
 void softCntStart(U8 softCntID)
 {
-	//softCnt[softCntID] = softCntReloadVal[softCntID];			//Reload the counter
-	softCntRun |= (BIT0 << softCntID);					//Start the counter
+	U32 critState;
+
+	if (softCntID >= RT_SOFT_COUNTER_NB)
+		return;
+
+	critState = critEnter();
+
+	if (softCnt[softCntID].control.enable && !softCnt[softCntID].control.run)
+	{
+		softCnt[softCntID].control.run = 1;				//Start the counter
+		rtTickWake();
+		wheelAdd(&rtWheel, &softCnt[softCntID].node, softCnt[softCntID].remaining + 1);	//UnderRun one sysTick after 0
+	}
+
+	critExit(critState);
 }
 
 /**
 * \fn		void softCntStop(U8 softCntID)
 * @brief	Stop a Software Counter
-* @note
+* @note		The remaining value is kept for the next softCntStart()
 * @arg		U8 softCntID		ID of the Software Counter
 * @return	nothing
 */
 void softCntStop(U8 softCntID)
 {
-	softCntRun &= ~(BIT0 << softCntID);
+	U32 critState;
+
+	if (softCntID >= RT_SOFT_COUNTER_NB)
+		return;
+
+	critState = critEnter();
+
+	if (softCnt[softCntID].control.run)
+	{
+		softCnt[softCntID].remaining = wheelGetRemaining(&rtWheel, &softCnt[softCntID].node);
+		if (softCnt[softCntID].remaining)
+			softCnt[softCntID].remaining--;			//Back to the counter value
+		wheelCancel(&rtWheel, &softCnt[softCntID].node);
+		softCnt[softCntID].control.run = 0;
+	}
+
+	critExit(critState);
 }
 
 /**
@@ -373,7 +544,8 @@ void softCntStop(U8 softCntID)
 */
 void softCntUpdatePeriod(U8 softCntID, U32 newPeriod)
 {
-	softCntReloadVal[softCntID] = newPeriod;
+	if (softCntID < RT_SOFT_COUNTER_NB)
+		softCnt[softCntID].reloadVal = newPeriod;
 }
 
 /**
@@ -385,7 +557,194 @@ void softCntUpdatePeriod(U8 softCntID, U32 newPeriod)
 */
 void softCntReload(U8 softCntID)
 {
-	softCnt[softCntID] = softCntReloadVal[softCntID];
+	U32 critState;
+
+	if (softCntID >= RT_SOFT_COUNTER_NB)
+		return;
+
+	critState = critEnter();
+
+	softCnt[softCntID].remaining = softCnt[softCntID].reloadVal;
+	if (softCnt[softCntID].control.run)
+	{
+		rtTickWake();
+		wheelAdd(&rtWheel, &softCnt[softCntID].node, softCnt[softCntID].reloadVal + 1);	//Restart the pending counter
+	}
+
+	critExit(critState);
+}
+// ============================== //
+
+
+// ====== Software Timer ======== //
+/**
+* \fn		void _softTimerExpire(tWheelNode * nodePtr, void * contextPtr)
+* @brief	Timing wheel handler of a software timer
+* @note		Called from rtISR(), a periodic timer is rescheduled from its deadline before the callback
+* @arg		tWheelNode * nodePtr		Node of the timer
+* @arg		void * contextPtr		Software timer
+* @return	nothing
+*/
+void _softTimerExpire(tWheelNode * nodePtr, void * contextPtr)
+{
+	tSoftTimer * workTmr = contextPtr;
+	U32 critState;
+
+	// -- Next deadline -- //
+	if (workTmr->control.periodic)
+		wheelAddAt(&rtWheel, nodePtr, nodePtr->expireTick + workTmr->period);
+	else
+		workTmr->control.run = 0;
+	// ------------------- //
+
+	// -- Call in tick context -- //
+	if (!workTmr->control.callMain)
+	{
+		workTmr->callback(workTmr->contextPtr);
+		return;
+	}
+	// -------------------------- //
+
+	// -- Queue it for the engine -- //
+	critState = critEnter();
+	if (workTmr->control.queued)
+	{
+		if (workTmr->control.queuedGen == workTmr->control.generation)
+			workTmr->missedNb++;				//Previous call not done yet
+		else
+			workTmr->control.queuedGen = workTmr->control.generation;	//Stale call, take its place
+	}
+	else
+	{
+		workTmr->control.queued = 1;
+		workTmr->control.queuedGen = workTmr->control.generation;
+		workTmr->nextPtr = NULL;
+		if (softTmrQueueTailPtr == NULL)
+			softTmrQueueHeadPtr = workTmr;
+		else
+			softTmrQueueTailPtr->nextPtr = workTmr;
+		softTmrQueueTailPtr = workTmr;
+	}
+	critExit(critState);
+	// ----------------------------- //
+}
+
+/**
+* \fn		U8 softTimerInit(tSoftTimer * timerPtr, void (*callback)(void*), void * contextPtr, U8 option)
+* @brief	Initialise a callback software timer
+* @note		The timer is statically declared by the user, there is no limit on the number of timer
+*		With SOFT_TMR_CALL_TICK the callback is called in rtISR() (keep it short)
+*		With SOFT_TMR_CALL_MAIN the callback is called by softTimerEngine()
+*		Return STD_EC_INVALID if a NULL pointer is given
+*		WARNING: Will not check if the timer is running
+* @arg		tSoftTimer * timerPtr		Timer to initialise
+* @arg		void (*callback)(void*)		Function to call at each expiration
+* @arg		void * contextPtr		Context given to the callback
+* @arg		U8 option			Options of the timer (Use the "Timer option" defines)
+* @return	U8 errorCode			STD Error Code (return STD_EC_SUCCESS if successful)
+*/
+U8 softTimerInit(tSoftTimer * timerPtr, void (*callback)(void*), void * contextPtr, U8 option)
+{
+	if ((timerPtr == NULL) || (callback == NULL))
+		return STD_EC_INVALID;
+
+	wheelNodeInit(&timerPtr->node, _softTimerExpire, timerPtr);
+	timerPtr->period = 0;
+	timerPtr->callback = callback;
+	timerPtr->contextPtr = contextPtr;
+	timerPtr->missedNb = 0;
+	timerPtr->nextPtr = NULL;
+
+	timerPtr->control.all = 0;
+	timerPtr->control.periodic = option & SOFT_TMR_PERIODIC;
+	timerPtr->control.callMain = (option & SOFT_TMR_CALL_MAIN) >> 1;
+
+	return STD_EC_SUCCESS;
+}
+
+/**
+* \fn		U8 softTimerStart(tSoftTimer * timerPtr, U32 delay, U32 period)
+* @brief	Start a software timer
+* @note		The first expiration is after delay sysTick, then every period sysTick for a periodic timer
+*		The next deadline is always the previous deadline + period, the callback latency does not accumulate
+*		A running timer is restarted, a call of the previous run still waiting for softTimerEngine() is dropped
+*		Return STD_EC_INVALID if a periodic timer is started with a null period
+* @arg		tSoftTimer * timerPtr		Timer to start
+* @arg		U32 delay			Delay before the first expiration (in sysTick)
+* @arg		U32 period			Period of the next expirations (in sysTick, ignored in one-shot)
+* @return	U8 errorCode			STD Error Code (return STD_EC_SUCCESS if successful)
+*/
+U8 softTimerStart(tSoftTimer * timerPtr, U32 delay, U32 period)
+{
+	U8 errorCode;
+	U32 critState;
+
+	if (timerPtr->control.periodic && ((period == 0) || (period > WHEEL_DELAY_MAX)))
+		return STD_EC_INVALID;
+
+	critState = critEnter();
+
+	timerPtr->period = period;
+	timerPtr->control.generation++;				//Drop a queued call of the previous run
+	rtTickWake();
+	errorCode = wheelAdd(&rtWheel, &timerPtr->node, delay);
+	if (errorCode == STD_EC_SUCCESS)
+		timerPtr->control.run = 1;
+
+	critExit(critState);
+
+	return errorCode;
+}
+
+/**
+* \fn		void softTimerStop(tSoftTimer * timerPtr)
+* @brief	Stop a software timer
+* @note		A call already waiting for softTimerEngine() is dropped
+* @arg		tSoftTimer * timerPtr		Timer to stop
+* @return	nothing
+*/
+void softTimerStop(tSoftTimer * timerPtr)
+{
+	U32 critState = critEnter();
+
+	wheelCancel(&rtWheel, &timerPtr->node);
+	timerPtr->control.run = 0;
+	timerPtr->control.generation++;				//Drop a queued call
+
+	critExit(critState);
+}
+
+/**
+* \fn		void softTimerEngine(void)
+* @brief	Call the callback of the expired SOFT_TMR_CALL_MAIN timers
+* @note		This function must be in the infinite loop of the main
+*		The callbacks are called in the order of expiration
+* @arg		nothing
+* @return	nothing
+*/
+void softTimerEngine(void)
+{
+	tSoftTimer * workTmr;
+	U8 current;
+	U32 critState;
+
+	while (softTmrQueueHeadPtr != NULL)
+	{
+		// -- Take the oldest expired timer -- //
+		critState = critEnter();
+		workTmr = softTmrQueueHeadPtr;
+		softTmrQueueHeadPtr = workTmr->nextPtr;
+		if (softTmrQueueHeadPtr == NULL)
+			softTmrQueueTailPtr = NULL;
+
+		current = (workTmr->control.queuedGen == workTmr->control.generation);
+		workTmr->control.queued = 0;
+		critExit(critState);
+		// ----------------------------------- //
+
+		if (current)
+			workTmr->callback(workTmr->contextPtr);
+	}
 }
 // ============================== //
 
@@ -400,9 +759,10 @@ void softCntReload(U8 softCntID)
 */
 void upTimeUpdate(void)
 {
-	U32 uStemp = upTimeRemaininguS + ((sysTick - upTimeLast) * sysTickValue);	//Exact time between update (in s)
+	U32 tickNb = rtGetSysTick();
+	U32 uStemp = upTimeRemaininguS + ((tickNb - upTimeLast) * sysTickValue);	//Exact time between update (in s)
 
-	upTimeLast = sysTick;								//Save the time of the last update
+	upTimeLast = tickNb;								//Save the time of the last update
 
 	// -- Compute the millis between update ------ //
 	while (uStemp > 999)
@@ -21,6 +21,8 @@
 // Lib
 #include <peripheral/pic32_timer.h>
 #include <peripheral/pic32_interrupt.h>
+#include <peripheral/pic32_coreTimer.h>
+#include <soft/pic32_timingWheel.h>
 
 // Definition
 #include <definition/stddef_megaxone.h>
@@ -36,11 +38,27 @@
 #define RT_TIMER_ID			TIMER_1
 #define RT_TIMER_INT_ID			INT_TIMER_1
 #define RT_TIMER_VECTOR			INT_VEC_TIMER_1
+#ifndef RT_TIMER_INT_PRIORITY
+#define RT_TIMER_INT_PRIORITY		INT_CRIT_IPL		//Must not be above INT_CRIT_IPL, the soft counters are protected with critEnter()
+#endif								//Was 7 before, declare the ISR with rtDeclareISR() so its IPL follow
+
+#if RT_TIMER_INT_PRIORITY > INT_CRIT_IPL
+	#error "RT_TIMER_INT_PRIORITY must not be above INT_CRIT_IPL (the old IPL7 realTimeISR must use rtDeclareISR())"
+#endif
+// =================== //
+
+// == Tickless mode == //
+// ENABLE: the sysTick is a core timer event (place coreTimerISR() in the core timer vector, Timer 1 is not used)
+//	   and it stop when no software counter or timer is running (sysTick is caught up when one is started)
+//	   The sysTick variable do not move while stopped, use rtGetSysTick() to read the exact count
+#ifndef RT_TICKLESS
+#define RT_TICKLESS			DISABLE
+#endif
 // =================== //
 
 // == Software Counter == //
 #define USE_RT_SOFT_COUNTER		ENABLE			//Enable the software counter functions by setting to "ENABLE"
-#define RT_SOFT_COUNTER_NB		10			//Number of software counter to create (max 16)
+#define RT_SOFT_COUNTER_NB		10			//Number of software counter to create (max 255)
 
 // Init options
 #define SOFT_CNT_RELOAD_EN		0x1			//Enable the auto reload of the counter (timer mode)
@@ -49,6 +67,14 @@
 #define SOFT_CNT_TARGET_DIS		0x0			//Disable the target action at underRun
 // ====================== //
 
+// == Software Timer == //
+// Timer option
+#define SOFT_TMR_ONESHOT		0x0			//Expire only once
+#define SOFT_TMR_PERIODIC		0x1			//Expire every period (drift-free)
+#define SOFT_TMR_CALL_TICK		0x0			//Call the callback in rtISR()
+#define SOFT_TMR_CALL_MAIN		0x2			//Call the callback in softTimerEngine()
+// ==================== //
+
 // == Compile Time option == //
 #define RTCC_UPDATE_RATE		1000			//Update rate of the software RTCC and upTime (in sysTick) (toggle between the 2)
 #define RTCC_SYSTEM			RTCC_SOFTWARE		//Which RTCC system to use
@@ -98,9 +124,51 @@ typedef union
 		U32 underRun:1;				//The counter as underRun
 		U32 targetEn:1;				//The counter will modify the softCntTargetPtr with the softCntTargetVal
 		U32 reload:1;				//The counter will auto reload it-self at underRun (timer mode)
-		U32 :29;
+		U32 enable:1;				//The counter is allocated
+		U32 run:1;				//The counter is running (pending in the timing wheel)
+		U32 :27;
 	};
 }tSoftCounterControl;
+
+// Software Counter
+typedef struct sSoftCounter
+{
+	tWheelNode node;				//Node in the realTime timing wheel
+	U32 reloadVal;					//Value to reload after the underrun of the counter
+	U32 remaining;					//Counter value when stopped (underRun after remaining + 1 sysTick)
+	U32 * targetPtr;				//Target to modify at the underrun
+	U32 targetVal;					//Value to input in the target
+	tSoftCounterControl control;			//Control register of the software counter
+	struct sSoftCounter * nextUnderRunPtr;		//Next counter waiting for softCntEngine()
+}tSoftCounter;
+
+// Control Register of a Software Timer
+typedef union
+{
+	U32 all;
+	struct
+	{
+		U32 periodic:1;				//The timer is rescheduled at each expiration
+		U32 callMain:1;				//The callback is called by softTimerEngine()
+		U32 run:1;				//The timer is running (pending in the timing wheel)
+		U32 queued:1;				//The timer wait for softTimerEngine()
+		U32 generation:8;			//Incremented at each start and stop
+		U32 queuedGen:8;			//Generation of the queued call, dropped if it differ
+		U32 :12;
+	};
+}tSoftTimerControl;
+
+// Software Timer
+typedef struct sSoftTimer
+{
+	tWheelNode node;				//Node in the realTime timing wheel
+	U32 period;					//Period of the timer (in sysTick)
+	void (*callback)(void*);			//Function to call at the expiration
+	void * contextPtr;				//Context given to the callback
+	U32 missedNb;					//Expiration lost because the previous call was still waiting
+	tSoftTimerControl control;			//Control register of the software timer
+	struct sSoftTimer * nextPtr;			//Next timer waiting for softTimerEngine()
+}tSoftTimer;
 // ############################################## //
 
 
@@ -114,6 +182,16 @@ typedef union
 * @return	nothing
 */
 void rtISR(void);
+
+/**
+* \fn		rtDeclareISR()
+* @brief	Declare realTimeISR() on the Timer 1 vector, at the RT_TIMER_INT_PRIORITY level
+* @note		Use it once at file scope in the application, the IPL always match the priority set by rtInit()
+*		The default priority was 7 before, an ISR still declared with IPL7SOFT must be replaced by this macro
+*		Not used in tickless mode (the sysTick run in coreTimerISR())
+* @return	nothing
+*/
+#define rtDeclareISR()			void __ISR(RT_TIMER_VECTOR, CONCAT(CONCAT(IPL,RT_TIMER_INT_PRIORITY),SOFT)) realTimeISR(void) {rtISR(); intFastClearFlag(RT_TIMER_INT_ID);}
 // =========================== //
 
 
@@ -127,6 +205,15 @@ void rtISR(void);
 */
 U8 realTimeInit(U32 tickPeriod);
 
+/**
+* \fn		U32 rtGetSysTick(void)
+* @brief	Return the number of sysTick passed since the init
+* @note		In tickless mode the sysTick passed while it is stopped are added, without restarting it
+* @arg		nothing
+* @return	U32 tickNb			Number of sysTick
+*/
+U32 rtGetSysTick(void);
+
 /**
 * \fn		void rtTimeClear(tRealTime * timeToClear)
 * @brief	Reset to 0 every part of a tRealTime variable
@@ -151,12 +238,12 @@ void rtTimeEngine(void);
 /**
 * \fn		U8 softCntInit(U32 cntPeriod, U32 * targetPtr, U32 targetValue, U8 option)
 * @brief	Initialise a software counter
-* @note
+* @note		The counter underRun on the sysTick after reaching 0, so after cntPeriod + 1 sysTick
 * @arg		U32 cntPeriod		Number of sysTick of 1 count
 * @arg		U32 * targetPtr		Target to be modified at underRun
 * @arg		U32 targetValue		Value to bitwise OR the target after a underRun
 * @arg		U8 option			Options of the counter (Use the "Init Option" defines)
-* @return	U8 softCntID		ID of the initialised counter
+* @return	U8 softCntID		ID of the initialised counter (STD_EC_OVERFLOW if none is available)
 */
 U8 softCntInit(U32 cntPeriod, U32 * targetPtr, U32 targetValue, U8 option);
 
@@ -174,6 +261,7 @@ void softCntRelease(U8 softCntID);
 * @brief	UnderRun reaction function for software counter
 * @note		This function must be in the infinite loop of the main to ensure that the software counter will react correctly
 *			The target will only be modify with a "|" (ex: target = 0x10 , value = 0x01 , result = 0x11)
+*			Only the counters that have underRun are processed
 * @arg		nothing
 * @return	nothing
 */
@@ -218,6 +306,67 @@ void softCntReload(U8 softCntID);
 // =========================== //
 
 
+// ====== Software Timer ===== //
+/**
+* \fn		U8 softTimerInit(tSoftTimer * timerPtr, void (*callback)(void*), void * contextPtr, U8 option)
+* @brief	Initialise a callback software timer
+* @note		The timer is statically declared by the user, there is no limit on the number of timer
+*		With SOFT_TMR_CALL_TICK the callback is called in rtISR() (keep it short)
+*		With SOFT_TMR_CALL_MAIN the callback is called by softTimerEngine()
+*		Return STD_EC_INVALID if a NULL pointer is given
+*		WARNING: Will not check if the timer is running
+* @arg		tSoftTimer * timerPtr		Timer to initialise
+* @arg		void (*callback)(void*)		Function to call at each expiration
+* @arg		void * contextPtr		Context given to the callback
+* @arg		U8 option			Options of the timer (Use the "Timer option" defines)
+* @return	U8 errorCode			STD Error Code (return STD_EC_SUCCESS if successful)
+*/
+U8 softTimerInit(tSoftTimer * timerPtr, void (*callback)(void*), void * contextPtr, U8 option);
+
+/**
+* \fn		U8 softTimerStart(tSoftTimer * timerPtr, U32 delay, U32 period)
+* @brief	Start a software timer
+* @note		The first expiration is after delay sysTick, then every period sysTick for a periodic timer
+*		The next deadline is always the previous deadline + period, the callback latency does not accumulate
+*		A running timer is restarted, a call of the previous run still waiting for softTimerEngine() is dropped
+*		Return STD_EC_INVALID if a periodic timer is started with a null period
+* @arg		tSoftTimer * timerPtr		Timer to start
+* @arg		U32 delay			Delay before the first expiration (in sysTick)
+* @arg		U32 period			Period of the next expirations (in sysTick, ignored in one-shot)
+* @return	U8 errorCode			STD Error Code (return STD_EC_SUCCESS if successful)
+*/
+U8 softTimerStart(tSoftTimer * timerPtr, U32 delay, U32 period);
+
+/**
+* \fn		void softTimerStop(tSoftTimer * timerPtr)
+* @brief	Stop a software timer
+* @note		A call already waiting for softTimerEngine() is dropped
+* @arg		tSoftTimer * timerPtr		Timer to stop
+* @return	nothing
+*/
+void softTimerStop(tSoftTimer * timerPtr);
+
+/**
+* \fn		softTimerIsRunning(timerPtr)
+* @brief	Return 1 if the timer will expire again
+* @note
+* @arg		timerPtr			Timer to check
+* @return	U8 running			1 if running, 0 if not
+*/
+#define softTimerIsRunning(timerPtr)		((timerPtr)->control.run)
+
+/**
+* \fn		void softTimerEngine(void)
+* @brief	Call the callback of the expired SOFT_TMR_CALL_MAIN timers
+* @note		This function must be in the infinite loop of the main
+*		The callbacks are called in the order of expiration
+* @arg		nothing
+* @return	nothing
+*/
+void softTimerEngine(void);
+// =========================== //
+
+
 // ==== Up-Time Functions ==== //
 /**
 * \fn		void upTimeUpdate(void)
@@ -271,7 +420,7 @@ void rtccUpdate(void);
 #define RT_ENGINE_UPDATE_UPTIME	1
 
 //Soft Counter
-#define SOFT_CNT_MAX		16
+#define SOFT_CNT_MAX		255					//Invalid ID, same as the STD_EC_OVERFLOW returned by softCntInit() (was 16 with the bitmask counters)
 // ############################################## //
 
 
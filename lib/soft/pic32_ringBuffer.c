@@ -7,7 +7,8 @@
  			All push/pull operation are in a FIFO manner
  			Buffers will wrap around but never write over valid data
 
- @todo		Disable interrupt (except IPL7) to differ parrallel task on the same buffer
+ 			The locks and the shared control are updated in a critical section (critEnter()), a push and
+ 			a pull can run in parallel from any level up to INT_CRIT_IPL
 
  @date		March 23th 2012
  @author	Laurence DV
@@ -241,6 +242,7 @@ U8 rBufPushU8(tRBufCtl * bufCtlPtr, U8 * sourcePtr, U16 elementNb, U8 option)
 {
 	tRBufCtl workBufCtl = *bufCtlPtr;				//Load the control reg to work localy
 	U16 elementDone;
+	U32 critState;
 
 	//Check for correct size
 	if (workBufCtl.control.elementSize != 1)
@@ -250,10 +252,12 @@ U8 rBufPushU8(tRBufCtl * bufCtlPtr, U8 * sourcePtr, U16 elementNb, U8 option)
 	if (workBufCtl.status.freeElement > elementNb)
 	{
 		//Only process if the buffer is available
+		critState = critEnter();
 		if (bufCtlPtr->status.writeLock == RBUF_UNLOCKED)
 		{
 			//Lock the wrinting
 			bufCtlPtr->status.writeLock = RBUF_LOCKED;
+			critExit(critState);
 
 			// -- Push the elements -- //
 			for (elementDone = 0; elementDone < elementNb; elementDone++)
@@ -275,15 +279,16 @@ U8 rBufPushU8(tRBufCtl * bufCtlPtr, U8 * sourcePtr, U16 elementNb, U8 option)
 			// ----------------------- //
 
 			// -- Save the control reg -- //
-			workBufCtl.status.freeElement -= elementNb;	//Decrease the free space
-			*bufCtlPtr = workBufCtl;
+			critState = critEnter();
+			bufCtlPtr->control.in = workBufCtl.control.in;	//Only the writing side, the reading side may have moved
+			bufCtlPtr->status.freeElement -= elementNb;	//Decrease the free space
+			bufCtlPtr->status.writeLock = RBUF_UNLOCKED;	//Unlock the wrinting
+			critExit(critState);
 			// -------------------------- //
 
-			//Unlock the wrinting
-			bufCtlPtr->status.writeLock = RBUF_UNLOCKED;
-
 			return STD_EC_SUCCESS;
 		}
+		critExit(critState);
 		// Buffer locked
 		return STD_EC_BUSY;
 	}
@@ -308,16 +313,19 @@ U8 rBufPullU8(tRBufCtl * bufCtlPtr, U8 * destinationPtr, U16 elementNb, U8 optio
 {
 	tRBufCtl workBufCtl = *bufCtlPtr;				//Load the control reg to work localy
 	U16 elementDone;
+	U32 critState;
 
 	//Check for correct size
 	if (workBufCtl.control.elementSize != 1)
 		return STD_EC_TOOLARGE;
 
 	//Only process if the buffer is available
+	critState = critEnter();
 	if (bufCtlPtr->status.readLock == RBUF_UNLOCKED)
 	{
 		//Lock the reading
 		bufCtlPtr->status.readLock = RBUF_LOCKED;
+		critExit(critState);
 
 		// -- Pull the elements -- //
 		for (elementDone = 0; elementDone < elementNb; elementDone++)
@@ -339,15 +347,16 @@ U8 rBufPullU8(tRBufCtl * bufCtlPtr, U8 * destinationPtr, U16 elementNb, U8 optio
 		// ---------------------- //
 
 		// -- Save the control reg -- //
-		workBufCtl.status.freeElement += elementNb;		//Increase the free space
-		*bufCtlPtr = workBufCtl;
+		critState = critEnter();
+		bufCtlPtr->control.out = workBufCtl.control.out;	//Only the reading side, the writing side may have moved
+		bufCtlPtr->status.freeElement += elementNb;		//Increase the free space
+		bufCtlPtr->status.readLock = RBUF_UNLOCKED;		//Unlock the reading
+		critExit(critState);
 		// -------------------------- //
 
-		//Unlock the reading
-		bufCtlPtr->status.readLock = RBUF_UNLOCKED;
-		
 		return STD_EC_SUCCESS;
 	}
+	critExit(critState);
 	// Buffer locked
 	return STD_EC_BUSY;
 }
@@ -368,6 +377,7 @@ U8 rBufPullU8(tRBufCtl * bufCtlPtr, U8 * destinationPtr, U16 elementNb, U8 optio
 U8 rBufPushElement(tRBufCtl * bufCtlPtr, void * sourcePtr, U16 elementNb, U8 option)
 {
 	tRBufCtl workBufCtl = *bufCtlPtr;				//Load the control reg to work localy
+	U32 critState;
 	U32 loopDone;							//Reset the loop count
 	U32 loopNeeded;
 
@@ -379,10 +389,12 @@ U8 rBufPushElement(tRBufCtl * bufCtlPtr, void * sourcePtr, U16 elementNb, U8 opt
 	if (workBufCtl.status.freeElement >= elementNb)
 	{
 		//Only process if the buffer is available
+		critState = critEnter();
 		if (bufCtlPtr->status.writeLock == RBUF_UNLOCKED)
 		{
 			//Lock the wrinting
 			bufCtlPtr->status.writeLock = RBUF_LOCKED;
+			critExit(critState);
 
 			// -- Count the loop number -- //
 			loopNeeded = elementNb*(workBufCtl.control.elementSize>>2);
@@ -409,15 +421,16 @@ U8 rBufPushElement(tRBufCtl * bufCtlPtr, void * sourcePtr, U16 elementNb, U8 opt
 			// ----------------------- //
 
 			// -- Save the control reg -- //
-			workBufCtl.status.freeElement -= elementNb;	//Update the free Space
-			*bufCtlPtr = workBufCtl;
+			critState = critEnter();
+			bufCtlPtr->control.in = workBufCtl.control.in;	//Only the writing side, the reading side may have moved
+			bufCtlPtr->status.freeElement -= elementNb;	//Update the free Space
+			bufCtlPtr->status.writeLock = RBUF_UNLOCKED;	//Unlock the wrinting
+			critExit(critState);
 			// -------------------------- //
 
-			//Unlock the wrinting
-			bufCtlPtr->status.writeLock = RBUF_UNLOCKED;
-
 			return STD_EC_SUCCESS;
 		}
+		critExit(critState);
 		//Buffer locked
 		return STD_EC_BUSY;
 	}
@@ -441,6 +454,7 @@ U8 rBufPushElement(tRBufCtl * bufCtlPtr, void * sourcePtr, U16 elementNb, U8 opt
 U8 rBufPullElement(tRBufCtl * bufCtlPtr, void * destinationPtr, U16 elementNb, U8 option)
 {
 	tRBufCtl workBufCtl = *bufCtlPtr;				//Load the control reg to work localy
+	U32 critState;
 	U32 loopDone;							//Reset the loop count
 	U32 loopNeeded;							//Number of loop needed
 
@@ -449,10 +463,12 @@ U8 rBufPullElement(tRBufCtl * bufCtlPtr, void * destinationPtr, U16 elementNb, U
 		return STD_EC_TOOSMALL;
 
 	//Only process if the buffer is available
+	critState = critEnter();
 	if (bufCtlPtr->status.readLock == RBUF_UNLOCKED)
 	{
 		//Lock the reading
 		bufCtlPtr->status.readLock = RBUF_LOCKED;
+		critExit(critState);
 
 		// -- Count the loop number -- //
 		loopNeeded = elementNb * (workBufCtl.control.elementSize>>2);
@@ -479,15 +495,16 @@ U8 rBufPullElement(tRBufCtl * bufCtlPtr, void * destinationPtr, U16 elementNb, U
 		// ----------------------- //
 
 		// -- Save the control reg -- //
-		workBufCtl.status.freeElement += elementNb;		//Update the free Space
-		*bufCtlPtr = workBufCtl;
+		critState = critEnter();
+		bufCtlPtr->control.out = workBufCtl.control.out;	//Only the reading side, the writing side may have moved
+		bufCtlPtr->status.freeElement += elementNb;		//Update the free Space
+		bufCtlPtr->status.readLock = RBUF_UNLOCKED;		//Unlock the reading
+		critExit(critState);
 		// -------------------------- //
 
-		//Unlock the reading
-		bufCtlPtr->status.readLock = RBUF_UNLOCKED;
-
 		return STD_EC_SUCCESS;
 	}
+	critExit(critState);
 	//Buffer locked
 	return STD_EC_BUSY;
 }
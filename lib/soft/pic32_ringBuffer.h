@@ -6,8 +6,8 @@
  @note		All Function are Non-Blocking
  			All push/pull operation are in a FIFO manner
  			Buffers will wrap around but never write over valid data
-
- @todo		Disable interrupt (except IPL7) to differ parrallel task on the same buffer
+ 			The locks and the shared control are updated in a critical section (critEnter()), a push and
+ 			a pull can run in parallel from any level up to INT_CRIT_IPL
 
  @date		March 23th 2011
  @author	Laurence DV
@@ -0,0 +1,344 @@
+/*!
+ @file		pic32_timingWheel.c
+ @brief		Hierarchical timing wheel lib
+
+ @version	0.1
+ @note		A timer is a node statically declared by the user, there is no limit on the number of node
+ 		Each level of the wheel is an array of list of node, the first level has a resolution of 1 tick
+ 		and every next level is WHEEL_SLOT_NB times coarser. A node is cascaded to a lower level when its slot is reached.
+ 		wheelTick() cost is O(1) whatever the number of node (plus the expired ones), wheelAdd() and wheelCancel() are O(1)
+ 		A delay longer than the wheel range is parked in the last level and re-cascaded until its time comes
+
+ @date		October 19th 2026
+ @author	Laurence DV
+*/
+
+// ################## Includes ################## //
+#include "pic32_timingWheel.h"
+// ############################################## //
+
+
+// ############## Internal Functions ############ //
+/**
+* \fn		void _wheelLink(tWheelNode ** headPtr, tWheelNode * nodePtr)
+* @brief	Link a node on top of a list
+* @note		Must be called in a critical section
+* @arg		tWheelNode ** headPtr		Head of the list
+* @arg		tWheelNode * nodePtr		Node to link
+* @return	nothing
+*/
+void _wheelLink(tWheelNode ** headPtr, tWheelNode * nodePtr)
+{
+	nodePtr->next = *headPtr;
+	if (nodePtr->next != NULL)
+		nodePtr->next->pprevPtr = &nodePtr->next;
+	nodePtr->pprevPtr = headPtr;
+	*headPtr = nodePtr;
+}
+
+/**
+* \fn		void _wheelUnlink(tWheelNode * nodePtr)
+* @brief	Remove a node from its list
+* @note		Must be called in a critical section
+* @arg		tWheelNode * nodePtr		Node to unlink
+* @return	nothing
+*/
+void _wheelUnlink(tWheelNode * nodePtr)
+{
+	*(nodePtr->pprevPtr) = nodePtr->next;
+	if (nodePtr->next != NULL)
+		nodePtr->next->pprevPtr = nodePtr->pprevPtr;
+	nodePtr->next = NULL;
+	nodePtr->pprevPtr = NULL;
+}
+
+/**
+* \fn		void _wheelPlace(tWheelCtl * wheelCtlPtr, tWheelNode * nodePtr)
+* @brief	Link a node in the slot corresponding to its expiration
+* @note		Must be called in a critical section
+*		The level is chosen by the distance between the expiration and the next processed tick
+* @arg		tWheelCtl * wheelCtlPtr		Wheel to use
+* @arg		tWheelNode * nodePtr		Node to place
+* @return	nothing
+*/
+void _wheelPlace(tWheelCtl * wheelCtlPtr, tWheelNode * nodePtr)
+{
+	U32 expireTick = nodePtr->expireTick;
+	U32 delta = expireTick - wheelCtlPtr->tick;
+	U8 level = 0;
+
+	// -- Already expired, process on the next tick -- //
+	if ((S32)delta < 0)
+	{
+		expireTick = wheelCtlPtr->tick;
+		delta = 0;
+	}
+	// ----------------------------------------------- //
+
+	// -- Too far, park it at the end of the wheel -- //
+	#if WHEEL_RANGE_BITS < 31
+	if (delta >= (1UL << WHEEL_RANGE_BITS))
+		expireTick = wheelCtlPtr->tick + ((1UL << WHEEL_RANGE_BITS) - 1);
+	#endif
+	// ---------------------------------------------- //
+
+	// -- Find the level -- //
+	while ((level < (WHEEL_LEVEL_NB-1)) && (delta >= (1UL << (WHEEL_SLOT_BITS * (level+1)))))
+		level++;
+	// -------------------- //
+
+	_wheelLink(&wheelCtlPtr->slot[level][(expireTick >> (WHEEL_SLOT_BITS * level)) & WHEEL_SLOT_MASK], nodePtr);
+}
+
+/**
+* \fn		U8 _wheelCascade(tWheelCtl * wheelCtlPtr, U8 level)
+* @brief	Move every node of the current slot of a level in the lower levels
+* @note		Must be called in a critical section
+* @arg		tWheelCtl * wheelCtlPtr		Wheel to use
+* @arg		U8 level			Level to cascade (1 to WHEEL_LEVEL_NB-1)
+* @return	U8 slotIndex			Index of the cascaded slot (0 mean the next level must be cascaded)
+*/
+U8 _wheelCascade(tWheelCtl * wheelCtlPtr, U8 level)
+{
+	U8 slotIndex = (wheelCtlPtr->tick >> (WHEEL_SLOT_BITS * level)) & WHEEL_SLOT_MASK;
+	tWheelNode * nodePtr = wheelCtlPtr->slot[level][slotIndex];
+	tWheelNode * nextPtr;
+
+	wheelCtlPtr->slot[level][slotIndex] = NULL;
+
+	while (nodePtr != NULL)
+	{
+		nextPtr = nodePtr->next;
+		_wheelPlace(wheelCtlPtr, nodePtr);			//Always land in a lower level (or back here if parked)
+		nodePtr = nextPtr;
+	}
+
+	return slotIndex;
+}
+// ############################################## //
+
+
+// ############### Wheel Functions ############## //
+// ==== Control Functions ==== //
+/**
+* \fn		void wheelInit(tWheelCtl * wheelCtlPtr)
+* @brief	Initialise an empty timing wheel
+* @note		WARNING: Will not check if nodes are still pending
+* @arg		tWheelCtl * wheelCtlPtr		Wheel to initialise
+* @return	nothing
+*/
+void wheelInit(tWheelCtl * wheelCtlPtr)
+{
+	U16 wu0, wu1;
+	U32 critState = critEnter();
+
+	for (wu0 = 0; wu0 < WHEEL_LEVEL_NB; wu0++)
+		for (wu1 = 0; wu1 < WHEEL_SLOT_NB; wu1++)
+			wheelCtlPtr->slot[wu0][wu1] = NULL;
+
+	wheelCtlPtr->tick = 0;
+	wheelCtlPtr->pendingNb = 0;
+
+	critExit(critState);
+}
+
+/**
+* \fn		void wheelNodeInit(tWheelNode * nodePtr, void (*handler)(tWheelNode*, void*), void * contextPtr)
+* @brief	Initialise a timer node and set its expiration handler
+* @note		Must be done once before the first use of a node
+* @arg		tWheelNode * nodePtr		Node to initialise
+* @arg		void (*handler)(tWheelNode*, void*)	Function called at the expiration (in wheelTick() context)
+* @arg		void * contextPtr		Context given to the handler
+* @return	nothing
+*/
+void wheelNodeInit(tWheelNode * nodePtr, void (*handler)(tWheelNode*, void*), void * contextPtr)
+{
+	nodePtr->next = NULL;
+	nodePtr->pprevPtr = NULL;
+	nodePtr->expireTick = 0;
+	nodePtr->handler = handler;
+	nodePtr->contextPtr = contextPtr;
+}
+
+/**
+* \fn		U8 wheelAdd(tWheelCtl * wheelCtlPtr, tWheelNode * nodePtr, U32 delay)
+* @brief	Start a node to expire after a number of tick
+* @note		The node expire on the delay-th call of wheelTick() (a delay of 0 is handled as 1)
+*		A pending node is restarted with the new delay
+*		Return STD_EC_TOOLARGE if the delay is above WHEEL_DELAY_MAX
+* @arg		tWheelCtl * wheelCtlPtr		Wheel to use
+* @arg		tWheelNode * nodePtr		Node to start
+* @arg		U32 delay			Delay before the expiration (in tick)
+* @return	U8 errorCode			STD Error Code (return STD_EC_SUCCESS if successful)
+*/
+U8 wheelAdd(tWheelCtl * wheelCtlPtr, tWheelNode * nodePtr, U32 delay)
+{
+	U32 critState;
+
+	if (delay > WHEEL_DELAY_MAX)
+		return STD_EC_TOOLARGE;
+	if (delay == 0)
+		delay = 1;
+
+	critState = critEnter();
+	wheelAddAt(wheelCtlPtr, nodePtr, wheelCtlPtr->tick + delay - 1);
+	critExit(critState);
+
+	return STD_EC_SUCCESS;
+}
+
+/**
+* \fn		void wheelAddAt(tWheelCtl * wheelCtlPtr, tWheelNode * nodePtr, U32 expireTick)
+* @brief	Start a node to expire at an absolute tick
+* @note		A tick already passed expire on the next call of wheelTick()
+*		Used to reschedule from the handler without drift (nodePtr->expireTick + period)
+* @arg		tWheelCtl * wheelCtlPtr		Wheel to use
+* @arg		tWheelNode * nodePtr		Node to start
+* @arg		U32 expireTick			Tick of the expiration
+* @return	nothing
+*/
+void wheelAddAt(tWheelCtl * wheelCtlPtr, tWheelNode * nodePtr, U32 expireTick)
+{
+	U32 critState = critEnter();
+
+	// -- Restart a pending node -- //
+	if (nodePtr->pprevPtr != NULL)
+		_wheelUnlink(nodePtr);
+	else
+		wheelCtlPtr->pendingNb++;
+	// ---------------------------- //
+
+	nodePtr->expireTick = expireTick;
+	_wheelPlace(wheelCtlPtr, nodePtr);
+
+	critExit(critState);
+}
+
+/**
+* \fn		void wheelCancel(tWheelCtl * wheelCtlPtr, tWheelNode * nodePtr)
+* @brief	Remove a pending node from the wheel
+* @note		Nothing is done if the node is not pending
+* @arg		tWheelCtl * wheelCtlPtr		Wheel of the node
+* @arg		tWheelNode * nodePtr		Node to cancel
+* @return	nothing
+*/
+void wheelCancel(tWheelCtl * wheelCtlPtr, tWheelNode * nodePtr)
+{
+	U32 critState = critEnter();
+
+	if (nodePtr->pprevPtr != NULL)
+	{
+		_wheelUnlink(nodePtr);
+		wheelCtlPtr->pendingNb--;
+	}
+
+	critExit(critState);
+}
+
+/**
+* \fn		U32 wheelGetRemaining(tWheelCtl * wheelCtlPtr, tWheelNode * nodePtr)
+* @brief	Return the number of tick before the expiration of a node
+* @note		Return 0 if the node is not pending
+* @arg		tWheelCtl * wheelCtlPtr		Wheel of the node
+* @arg		tWheelNode * nodePtr		Node to check
+* @return	U32 remaining			Number of wheelTick() call before the expiration
+*/
+U32 wheelGetRemaining(tWheelCtl * wheelCtlPtr, tWheelNode * nodePtr)
+{
+	U32 remaining = 0;
+	U32 critState = critEnter();
+
+	if (nodePtr->pprevPtr != NULL)
+	{
+		remaining = nodePtr->expireTick - wheelCtlPtr->tick + 1;
+		if ((S32)remaining < 1)
+			remaining = 1;					//Late, expire on the next tick
+	}
+
+	critExit(critState);
+
+	return remaining;
+}
+// =========================== //
+
+
+// ==== Tick Functions ======= //
+/**
+* \fn		void wheelTick(tWheelCtl * wheelCtlPtr)
+* @brief	Advance the wheel by one tick and call the handler of every expired node
+* @note		Call it from the tick interrupt (at most at INT_CRIT_IPL)
+*		The node is removed from the wheel before its handler is called, the handler can restart it
+* @arg		tWheelCtl * wheelCtlPtr		Wheel to advance
+* @return	nothing
+*/
+void wheelTick(tWheelCtl * wheelCtlPtr)
+{
+	U8 level;
+	U8 slotIndex;
+	tWheelNode * workList;
+	tWheelNode * nodePtr;
+	U32 critState = critEnter();
+
+	// -- Cascade the upper levels when the first one wrap -- //
+	slotIndex = wheelCtlPtr->tick & WHEEL_SLOT_MASK;
+	if (slotIndex == 0)
+	{
+		for (level = 1; level < WHEEL_LEVEL_NB; level++)
+		{
+			if (_wheelCascade(wheelCtlPtr, level) != 0)
+				break;					//The next level did not wrap
+		}
+	}
+	// ------------------------------------------------------ //
+
+	// -- Take the expired list -- //
+	workList = wheelCtlPtr->slot[0][slotIndex];
+	wheelCtlPtr->slot[0][slotIndex] = NULL;
+	if (workList != NULL)
+		workList->pprevPtr = &workList;				//A handler can cancel a node of this list
+	wheelCtlPtr->tick++;
+	// --------------------------- //
+
+	// -- Call the handlers -- //
+	while (workList != NULL)
+	{
+		nodePtr = workList;
+		_wheelUnlink(nodePtr);
+		wheelCtlPtr->pendingNb--;
+
+		critExit(critState);
+		if (nodePtr->handler != NULL)
+			nodePtr->handler(nodePtr, nodePtr->contextPtr);
+		critState = critEnter();
+	}
+	// ----------------------- //
+
+	critExit(critState);
+}
+
+/**
+* \fn		U8 wheelSkip(tWheelCtl * wheelCtlPtr, U32 tickNb)
+* @brief	Advance an empty wheel by a number of tick without processing them
+* @note		Used to catch up the ticks passed while the tick source was stopped
+*		Return STD_EC_BUSY if a node is pending
+* @arg		tWheelCtl * wheelCtlPtr		Wheel to advance
+* @arg		U32 tickNb			Number of tick to skip
+* @return	U8 errorCode			STD Error Code (return STD_EC_SUCCESS if successful)
+*/
+U8 wheelSkip(tWheelCtl * wheelCtlPtr, U32 tickNb)
+{
+	U8 errorCode = STD_EC_BUSY;
+	U32 critState = critEnter();
+
+	if (wheelCtlPtr->pendingNb == 0)
+	{
+		wheelCtlPtr->tick += tickNb;
+		errorCode = STD_EC_SUCCESS;
+	}
+
+	critExit(critState);
+
+	return errorCode;
+}
+// =========================== //
+// ############################################## //
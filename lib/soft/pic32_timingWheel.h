@@ -0,0 +1,175 @@
+/*!
+ @file		pic32_timingWheel.h
+ @brief		Hierarchical timing wheel lib
+
+ @version	0.1
+ @note		A timer is a node statically declared by the user, there is no limit on the number of node
+ 		Each level of the wheel is an array of list of node, the first level has a resolution of 1 tick
+ 		and every next level is WHEEL_SLOT_NB times coarser. A node is cascaded to a lower level when its slot is reached.
+ 		wheelTick() cost is O(1) whatever the number of node (plus the expired ones), wheelAdd() and wheelCancel() are O(1)
+ 		A delay longer than the wheel range is parked in the last level and re-cascaded until its time comes
+
+ @date		October 19th 2026
+ @author	Laurence DV
+*/
+
+#ifndef _PIC32_TIMINGWHEEL_H
+#define _PIC32_TIMINGWHEEL_H 1
+// ################## Includes ################## //
+// Lib
+#include <peripheral/pic32_interrupt.h>
+
+// Definition
+#include <definition/stddef_megaxone.h>
+#include <definition/datatype_megaxone.h>
+// ############################################## //
+
+
+// ################## Defines ################### //
+// Wheel geometry (each wheel use (WHEEL_LEVEL_NB * WHEEL_SLOT_NB) pointers)
+#ifndef WHEEL_SLOT_BITS
+	#define WHEEL_SLOT_BITS				6		//Number of slot per level = 2^WHEEL_SLOT_BITS
+#endif
+#ifndef WHEEL_LEVEL_NB
+	#define WHEEL_LEVEL_NB				4		//Number of level in the wheel
+#endif
+
+#define WHEEL_SLOT_NB				(1 << WHEEL_SLOT_BITS)
+#define WHEEL_SLOT_MASK				(WHEEL_SLOT_NB - 1)
+#define WHEEL_RANGE_BITS			(WHEEL_SLOT_BITS * WHEEL_LEVEL_NB)
+
+#if (WHEEL_RANGE_BITS > 31) || (WHEEL_LEVEL_NB < 1)
+	#error "The timing wheel range must fit in 31 bits"
+#endif
+
+// Maximum delay of a node (in tick)
+#define WHEEL_DELAY_MAX				(0x7FFFFFFF)
+// ############################################## //
+
+
+// ################# Data Type ################## //
+// Timer Node //
+typedef struct sWheelNode
+{
+	struct sWheelNode * next;			//Next node in the slot
+	struct sWheelNode ** pprevPtr;			//Link pointing to this node (NULL when not pending)
+	U32 expireTick;					//Tick of the expiration
+	void (*handler)(struct sWheelNode*, void*);	//Function called at the expiration
+	void * contextPtr;				//Context given to the handler
+}tWheelNode;
+// ---------- //
+
+// Control Part //
+typedef struct
+{
+	U32 tick;					//Next tick to be processed
+	U32 pendingNb;					//Number of node in the wheel
+	tWheelNode * slot[WHEEL_LEVEL_NB][WHEEL_SLOT_NB];
+}tWheelCtl;
+// ------------ //
+// ############################################## //
+
+
+// ################# Prototypes ################# //
+// ==== Control Functions ==== //
+/**
+* \fn		void wheelInit(tWheelCtl * wheelCtlPtr)
+* @brief	Initialise an empty timing wheel
+* @note		WARNING: Will not check if nodes are still pending
+* @arg		tWheelCtl * wheelCtlPtr		Wheel to initialise
+* @return	nothing
+*/
+void wheelInit(tWheelCtl * wheelCtlPtr);
+
+/**
+* \fn		void wheelNodeInit(tWheelNode * nodePtr, void (*handler)(tWheelNode*, void*), void * contextPtr)
+* @brief	Initialise a timer node and set its expiration handler
+* @note		Must be done once before the first use of a node
+* @arg		tWheelNode * nodePtr		Node to initialise
+* @arg		void (*handler)(tWheelNode*, void*)	Function called at the expiration (in wheelTick() context)
+* @arg		void * contextPtr		Context given to the handler
+* @return	nothing
+*/
+void wheelNodeInit(tWheelNode * nodePtr, void (*handler)(tWheelNode*, void*), void * contextPtr);
+
+/**
+* \fn		U8 wheelAdd(tWheelCtl * wheelCtlPtr, tWheelNode * nodePtr, U32 delay)
+* @brief	Start a node to expire after a number of tick
+* @note		The node expire on the delay-th call of wheelTick() (a delay of 0 is handled as 1)
+*		A pending node is restarted with the new delay
+*		Return STD_EC_TOOLARGE if the delay is above WHEEL_DELAY_MAX
+* @arg		tWheelCtl * wheelCtlPtr		Wheel to use
+* @arg		tWheelNode * nodePtr		Node to start
+* @arg		U32 delay			Delay before the expiration (in tick)
+* @return	U8 errorCode			STD Error Code (return STD_EC_SUCCESS if successful)
+*/
+U8 wheelAdd(tWheelCtl * wheelCtlPtr, tWheelNode * nodePtr, U32 delay);
+
+/**
+* \fn		void wheelAddAt(tWheelCtl * wheelCtlPtr, tWheelNode * nodePtr, U32 expireTick)
+* @brief	Start a node to expire at an absolute tick
+* @note		A tick already passed expire on the next call of wheelTick()
+*		Used to reschedule from the handler without drift (nodePtr->expireTick + period)
+* @arg		tWheelCtl * wheelCtlPtr		Wheel to use
+* @arg		tWheelNode * nodePtr		Node to start
+* @arg		U32 expireTick			Tick of the expiration
+* @return	nothing
+*/
+void wheelAddAt(tWheelCtl * wheelCtlPtr, tWheelNode * nodePtr, U32 expireTick);
+
+/**
+* \fn		void wheelCancel(tWheelCtl * wheelCtlPtr, tWheelNode * nodePtr)
+* @brief	Remove a pending node from the wheel
+* @note		Nothing is done if the node is not pending
+* @arg		tWheelCtl * wheelCtlPtr		Wheel of the node
+* @arg		tWheelNode * nodePtr		Node to cancel
+* @return	nothing
+*/
+void wheelCancel(tWheelCtl * wheelCtlPtr, tWheelNode * nodePtr);
+
+/**
+* \fn		U32 wheelGetRemaining(tWheelCtl * wheelCtlPtr, tWheelNode * nodePtr)
+* @brief	Return the number of tick before the expiration of a node
+* @note		Return 0 if the node is not pending
+* @arg		tWheelCtl * wheelCtlPtr		Wheel of the node
+* @arg		tWheelNode * nodePtr		Node to check
+* @return	U32 remaining			Number of wheelTick() call before the expiration
+*/
+U32 wheelGetRemaining(tWheelCtl * wheelCtlPtr, tWheelNode * nodePtr);
+
+/**
+* \fn		wheelIsPending(nodePtr)
+* @brief	Return 1 if the node is waiting in a wheel
+* @note
+* @arg		nodePtr				Node to check
+* @return	U8 pending			1 if pending, 0 if not
+*/
+#define wheelIsPending(nodePtr)			((nodePtr)->pprevPtr != NULL)
+// =========================== //
+
+
+// ==== Tick Functions ======= //
+/**
+* \fn		void wheelTick(tWheelCtl * wheelCtlPtr)
+* @brief	Advance the wheel by one tick and call the handler of every expired node
+* @note		Call it from the tick interrupt (at most at INT_CRIT_IPL)
+*		The node is removed from the wheel before its handler is called, the handler can restart it
+* @arg		tWheelCtl * wheelCtlPtr		Wheel to advance
+* @return	nothing
+*/
+void wheelTick(tWheelCtl * wheelCtlPtr);
+
+/**
+* \fn		U8 wheelSkip(tWheelCtl * wheelCtlPtr, U32 tickNb)
+* @brief	Advance an empty wheel by a number of tick without processing them
+* @note		Used to catch up the ticks passed while the tick source was stopped
+*		Return STD_EC_BUSY if a node is pending
+* @arg		tWheelCtl * wheelCtlPtr		Wheel to advance
+* @arg		U32 tickNb			Number of tick to skip
+* @return	U8 errorCode			STD Error Code (return STD_EC_SUCCESS if successful)
+*/
+U8 wheelSkip(tWheelCtl * wheelCtlPtr, U32 tickNb);
+// =========================== //
+// ############################################## //
+
+#endif